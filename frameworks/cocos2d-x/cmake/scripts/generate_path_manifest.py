@@ -0,0 +1,63 @@
+#!/usr/bin/env python3
+# -*- coding: UTF-8 -*-
+"""
+NAME
+    generate_path_manifest -- list the resources for FileUtils::loadPathManifest
+
+SYNOPSIS
+    generate_path_manifest [-h] -s src_path -o manifest_file
+
+    -h show help
+    -s src path, the resource root folder shipped with the application
+    -o manifest file to write, one path relative to the resource root per line
+"""
+
+import os
+import sys
+import getopt
+
+def listFiles(src):
+    files = []
+    for root, dirs, names in os.walk(src):
+        dirs[:] = sorted(d for d in dirs if d[0] != ".") # ignore hidden folders
+        for name in sorted(names):
+            if "." == name[0]: # ignore hidden files
+                continue
+            fullPath = os.path.join(root, name)
+            files.append(os.path.relpath(fullPath, src).replace(os.sep, "/"))
+    return files
+
+if __name__ == "__main__":
+    # ===== parse args =====
+    try:
+        opts, args = getopt.getopt(sys.argv[1:], "hs:o:")
+    except getopt.GetoptError:
+        # print help information and exit:
+        print(__doc__)
+        sys.exit(-2)
+
+    srcDir = ""
+    manifestFile = ""
+    for o, a in opts:
+        if o == "-h":
+            # print help information and exit:
+            print(__doc__)
+            sys.exit(0)
+        if o == "-s":
+            srcDir = a
+        if o == "-o":
+            manifestFile = a
+
+    if len(srcDir) == 0:
+        print("Error: use -s xxx to set src path")
+        sys.exit(-2)
+    if len(manifestFile) == 0:
+        print("Error: use -o xxx to set the manifest file")
+        sys.exit(-2)
+
+    files = listFiles(srcDir)
+    with open(manifestFile, "w", encoding="utf-8", newline="\n") as fp:
+        fp.write("# generated by generate_path_manifest.py\n")
+        for path in files:
+            fp.write(path + "\n")
+    print("Listed %d files into %s" % (len(files), manifestFile))
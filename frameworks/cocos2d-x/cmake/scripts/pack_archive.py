@@ -0,0 +1,137 @@
+#!/usr/bin/env python3
+# -*- coding: UTF-8 -*-
+"""
+NAME
+    pack_archive -- pack a resource folder into an archive for FileUtils::addSearchArchive
+
+SYNOPSIS
+    pack_archive [-h] -s src_path -o archive_file [-z] [-a alignment]
+
+    -h show help
+    -s src path, the folder to pack, entries are named by their path relative to it
+    -o archive file to write
+    -z compress entries with zlib when it saves space, already compressed formats are stored as is
+    -a alignment of the entries in bytes, default 16
+"""
+
+import os
+import sys
+import getopt
+import struct
+import zlib
+
+ARCHIVE_MAGIC = b"CCPK"
+ARCHIVE_VERSION = 1
+HEADER_FORMAT = "<4sIIIQQ"
+INDEX_RECORD_FORMAT = "<IIIIQII"
+COMPRESSION_NONE = 0
+COMPRESSION_ZLIB = 1
+
+# formats which don't get smaller with zlib
+STORED_EXTENSIONS = (".png", ".jpg", ".jpeg", ".webp", ".pkm", ".pvr", ".ccz", ".gz", ".zip",
+                     ".ogg", ".mp3", ".m4a", ".mp4")
+
+def hashPath(path):
+    # FNV-1a, must match FileArchive::hashPath
+    h = 2166136261
+    for b in path:
+        h = ((h ^ b) * 16777619) & 0xffffffff
+    return h
+
+def listFiles(src):
+    files = []
+    for root, dirs, names in os.walk(src):
+        dirs[:] = sorted(d for d in dirs if d[0] != ".") # ignore hidden folders
+        for name in sorted(names):
+            if "." == name[0]: # ignore hidden files
+                continue
+            fullPath = os.path.join(root, name)
+            entryPath = os.path.relpath(fullPath, src).replace(os.sep, "/")
+            files.append((entryPath, fullPath))
+    return files
+
+def align(offset, alignment):
+    return (offset + alignment - 1) // alignment * alignment
+
+def packArchive(src, dest, compress, alignment):
+    entries = []
+    for entryPath, fullPath in listFiles(src):
+        with open(fullPath, "rb") as fp:
+            data = fp.read()
+        compression = COMPRESSION_NONE
+        stored = data
+        if compress and len(data) > 0 and not entryPath.lower().endswith(STORED_EXTENSIONS):
+            packed = zlib.compress(data, 9)
+            # only worth inflating if it saves a good part of the file
+            if len(packed) < len(data) * 0.9:
+                compression = COMPRESSION_ZLIB
+                stored = packed
+        pathBytes = entryPath.encode("utf-8")
+        entries.append([hashPath(pathBytes), pathBytes, compression, stored, len(data)])
+
+    # the index is searched by hash then path
+    entries.sort(key=lambda e: (e[0], e[1]))
+
+    headerSize = struct.calcsize(HEADER_FORMAT)
+    recordSize = struct.calcsize(INDEX_RECORD_FORMAT)
+    stringsOffset = headerSize + recordSize * len(entries)
+    strings = b"".join(e[1] for e in entries)
+
+    offset = align(stringsOffset + len(strings), alignment)
+    index = []
+    pathOffset = 0
+    for h, pathBytes, compression, stored, originalSize in entries:
+        index.append(struct.pack(INDEX_RECORD_FORMAT, h, pathOffset, len(pathBytes), compression,
+                                 offset, len(stored), originalSize))
+        pathOffset += len(pathBytes)
+        offset = align(offset + len(stored), alignment)
+
+    with open(dest, "wb") as fp:
+        fp.write(struct.pack(HEADER_FORMAT, ARCHIVE_MAGIC, ARCHIVE_VERSION, len(entries), alignment,
+                             stringsOffset, len(strings)))
+        fp.write(b"".join(index))
+        fp.write(strings)
+        for e in entries:
+            fp.write(b"\0" * (align(fp.tell(), alignment) - fp.tell()))
+            fp.write(e[3])
+
+    print("Packed %d files into %s" % (len(entries), dest))
+
+if __name__ == "__main__":
+    # ===== parse args =====
+    try:
+        opts, args = getopt.getopt(sys.argv[1:], "hs:o:za:")
+    except getopt.GetoptError:
+        # print help information and exit:
+        print(__doc__)
+        sys.exit(-2)
+
+    srcDir = ""
+    archiveFile = ""
+    compress = False
+    alignment = 16
+    for o, a in opts:
+        if o == "-h":
+            # print help information and exit:
+            print(__doc__)
+            sys.exit(0)
+        if o == "-s":
+            srcDir = a
+        if o == "-o":
+            archiveFile = a
+        if o == "-z":
+            compress = True
+        if o == "-a":
+            alignment = int(a)
+
+    if len(srcDir) == 0:
+        print("Error: use -s xxx to set src path")
+        sys.exit(-2)
+    if len(archiveFile) == 0:
+        print("Error: use -o xxx to set the archive file")
+        sys.exit(-2)
+    if alignment <= 0:
+        print("Error: the alignment must be positive")
+        sys.exit(-2)
+
+    packArchive(srcDir, archiveFile, compress, alignment)
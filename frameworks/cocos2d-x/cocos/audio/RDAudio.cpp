@@ -13,12 +13,23 @@
 // limitations under the License.
 
 #include <memory.h>
+#include <algorithm>
+#include <chrono>
 
 #include "platform/CCFileUtils.h"
 #include "cocos/audio/RDAudio.h"
 #include "cocos/audio/RDAudioOgg.h"
 #include "cocos2d.h"
 
+// default size of the buffer cache, in bytes of PCM
+#define BUFFER_CACHE_SIZE (16 * 1024 * 1024)
+
+// buffers queued on a stream, each holds STREAM_BUFFER_MS of sound
+#define STREAM_BUFFER_COUNT 4
+#define STREAM_BUFFER_MS 250
+// how often the stream thread refills the streams, well under STREAM_BUFFER_MS
+#define STREAM_UPDATE_MS 50
+
 // singleton stuff
 RDAudio *RDAudio::s_instant = nullptr;
 
@@ -27,12 +38,24 @@ RDAudio::RDAudio()
 , _context(nullptr)
 , _needQuit(false)
 , _asyncRefCount(0)
-, _thread(nullptr)
+, _bufferCacheSize(BUFFER_CACHE_SIZE)
+, _cachedBufferBytes(0)
+, _cacheClock(0)
+, _streamThread(nullptr)
+, _streamsSuspended(false)
 {
 }
 
 RDAudio::~RDAudio()
 {
+    for (auto stream : _streams) {
+        delete stream;
+    }
+    _streams.clear();
+    for (auto& item : _bufferCache) {
+        alDeleteBuffers(1, &item.second.bufferID);
+    }
+    _bufferCache.clear();
     if (_context) {
         alcMakeContextCurrent(NULL);
         alcDestroyContext(_context);
@@ -40,9 +63,17 @@ RDAudio::~RDAudio()
     if (_device) {
         alcCloseDevice(_device);
     }
-    if (_thread) {
-        _thread->join();
-        delete _thread;
+    for (auto thread : _threads) {
+        if (thread->joinable()) {
+            thread->join();
+        }
+        delete thread;
+    }
+    if (_streamThread) {
+        if (_streamThread->joinable()) {
+            _streamThread->join();
+        }
+        delete _streamThread;
     }
 }
 
@@ -67,6 +98,10 @@ void RDAudio::destroyInstance()
 
 void RDAudio::pause()
 {
+    // the context can't be used until resume
+    _streamMutex.lock();
+    _streamsSuspended = true;
+    _streamMutex.unlock();
 //#if CC_TARGET_PLATFORM != CC_PLATFORM_ANDROID
     alcMakeContextCurrent(NULL);
     alcSuspendContext(_context);
@@ -79,15 +114,27 @@ void RDAudio::resume()
     alcMakeContextCurrent(_context);
     alcProcessContext(_context);
 //#endif
+    _streamMutex.lock();
+    _streamsSuspended = false;
+    _streamMutex.unlock();
+    _streamCondition.notify_one();
 }
 
 void RDAudio::waitForQuit()
 {
     // notify sub thread to quick
     _needQuit = true;
-    _inCondition.notify_one();
-    if (_thread) {
-        _thread->join();
+    _inMutex.lock();
+    _inMutex.unlock();
+    _inCondition.notify_all();
+    for (auto thread : _threads) {
+        thread->join();
+    }
+    _streamMutex.lock();
+    _streamMutex.unlock();
+    _streamCondition.notify_one();
+    if (_streamThread) {
+        _streamThread->join();
     }
 }
 
@@ -118,8 +165,12 @@ void RDAudio::init(void)
             name = alcGetString(_device, ALC_DEVICE_SPECIFIER);
         }
         cocos2d::log("alcOpenDevice Opened \"%s\"", name);
-       // start audio decode thread
-        _thread = new std::thread(&RDAudio::threadLoop, this);
+        // start audio decode threads, leave a core to the main thread
+        unsigned int cores = std::thread::hardware_concurrency();
+        unsigned int count = cores > 2 ? std::min(cores - 1, 4u) : 1;
+        for (unsigned int i = 0; i < count; ++i) {
+            _threads.push_back(new std::thread(&RDAudio::threadLoop, this));
+        }
     }
 }
 
@@ -170,47 +221,70 @@ void RDAudio::threadLoop()
 
 void RDAudio::scheduleLoop(float)
 {
-    AsyncStruct *asyncStruct = nullptr;
-    
-    _outMutex.lock();
-    if (_outQueue.empty())
-    {
-        _outMutex.unlock();
-        return;
+    // files found in the cache, the callbacks may request more files
+    std::vector<std::pair<std::string, Waiter>> cacheHits;
+    cacheHits.swap(_cacheHits);
+    for (auto& hit : cacheHits) {
+        // referenced by the request, it can't have been deleted
+        ALuint bufferID = _bufferCache[hit.first].bufferID;
+        --_asyncRefCount;
+        hit.second.cb(hit.second.funcID, bufferID);
     }
     
-    asyncStruct = _outQueue.front();
-    _outQueue.pop();
+    // all the files decoded since the last frame
+    std::queue<AsyncStruct *> outQueue;
+    _outMutex.lock();
+    outQueue.swap(_outQueue);
     _outMutex.unlock();
     
-    // create OpenAL buffer
-    ALuint bufferID = 0;
-    if (asyncStruct->pcmData) {
-        // clear old error
-        alGetError();
-        alGenBuffers(1, &bufferID);
-        if (alGetError() != AL_NO_ERROR) {
-            cocos2d::log("Error: RDAudio_LoadFile can't gen OpenAL Buffer");
-            bufferID = 0;
-        } else {
-            ALenum format = (asyncStruct->channels == 1) ? AL_FORMAT_MONO16 : AL_FORMAT_STEREO16;
-            alBufferData(bufferID, format, asyncStruct->pcmData, asyncStruct->size, asyncStruct->rate);
+    while (!outQueue.empty()) {
+        AsyncStruct *asyncStruct = outQueue.front();
+        outQueue.pop();
+        _pending.erase(asyncStruct->filename);
+        
+        // create OpenAL buffer
+        ALuint bufferID = 0;
+        if (asyncStruct->pcmData) {
+            // clear old error
+            alGetError();
+            alGenBuffers(1, &bufferID);
             if (alGetError() != AL_NO_ERROR) {
-                cocos2d::log("Error: RDAudio_LoadFile alBufferData Fail");
-                alDeleteBuffers(1, &bufferID);
+                cocos2d::log("Error: RDAudio_LoadFile can't gen OpenAL Buffer");
                 bufferID = 0;
+            } else {
+                ALenum format = (asyncStruct->channels == 1) ? AL_FORMAT_MONO16 : AL_FORMAT_STEREO16;
+                alBufferData(bufferID, format, asyncStruct->pcmData, asyncStruct->size, asyncStruct->rate);
+                if (alGetError() != AL_NO_ERROR) {
+                    cocos2d::log("Error: RDAudio_LoadFile alBufferData Fail");
+                    alDeleteBuffers(1, &bufferID);
+                    bufferID = 0;
+                }
             }
+        } else {
+            cocos2d::log("Fail to decode file: %s, ONLY support ogg now!", asyncStruct->filename.c_str());
         }
-    } else {
-        cocos2d::log("Fail to decode file: %s, ONLY support ogg now!", asyncStruct->filename.c_str());
+        
+        if (bufferID) {
+            // one reference per request
+            CachedBuffer &cached = _bufferCache[asyncStruct->filename];
+            cached.bufferID = bufferID;
+            cached.size = asyncStruct->size;
+            cached.refs = (int)asyncStruct->waiters.size();
+            cached.lastUsed = ++_cacheClock;
+            _cachedBufferBytes += cached.size;
+        }
+        
+        // callback to lua
+        for (auto &waiter : asyncStruct->waiters) {
+            --_asyncRefCount;
+            waiter.cb(waiter.funcID, bufferID);
+        }
+        // free memory
+        delete asyncStruct;
     }
-    // callback to lua
-    asyncStruct->cb(asyncStruct->funcID, bufferID);
-    // free memory
-    delete asyncStruct;
+    trimBufferCache();
     
     // remove task in main thread
-    --_asyncRefCount;
     if (0 == _asyncRefCount)
     {
         cocos2d::Director::getInstance()->getScheduler()->unschedule(CC_SCHEDULE_SELECTOR(RDAudio::scheduleLoop), this);
@@ -225,8 +299,27 @@ void RDAudio::loadFileAsyn(const char *filename, int funcID, AudioCallback cb)
     }
     ++_asyncRefCount;
     
+    Waiter waiter = {funcID, cb};
+    // decoded already, called back on the next frame like a decoded file
+    auto cached = _bufferCache.find(filename);
+    if (cached != _bufferCache.end()) {
+        ++cached->second.refs;
+        cached->second.lastUsed = ++_cacheClock;
+        _cacheHits.push_back(std::make_pair(cached->first, waiter));
+        return;
+    }
+    
+    // being decoded, share the buffer
+    auto pending = _pending.find(filename);
+    if (pending != _pending.end()) {
+        pending->second->waiters.push_back(waiter);
+        return;
+    }
+    
     // add task in sub thread
-    AsyncStruct *asyncStruct = new (std::nothrow) AsyncStruct(filename, funcID, cb);
+    AsyncStruct *asyncStruct = new (std::nothrow) AsyncStruct(filename);
+    asyncStruct->waiters.push_back(waiter);
+    _pending.emplace(asyncStruct->filename, asyncStruct);
     std::unique_lock<std::mutex> lock(_inMutex);
     _inQueue.push(asyncStruct);
     lock.unlock();
@@ -234,3 +327,318 @@ void RDAudio::loadFileAsyn(const char *filename, int funcID, AudioCallback cb)
     // weak up sub thread
     _inCondition.notify_one();
 }
+
+void RDAudio::releaseBuffer(ALuint bufferID)
+{
+    for (auto &item : _bufferCache) {
+        if (item.second.bufferID == bufferID) {
+            if (--item.second.refs == 0) {
+                item.second.lastUsed = ++_cacheClock;
+                trimBufferCache();
+            }
+            return;
+        }
+    }
+    // not cached
+    alDeleteBuffers(1, &bufferID);
+}
+
+void RDAudio::setBufferCacheSize(size_t bytes)
+{
+    _bufferCacheSize = bytes;
+    trimBufferCache();
+}
+
+void RDAudio::trimBufferCache()
+{
+    if (_cachedBufferBytes <= _bufferCacheSize) {
+        return;
+    }
+    
+    // least recently used first
+    std::vector<std::pair<unsigned int, std::string>> unused;
+    for (auto &item : _bufferCache) {
+        if (item.second.refs == 0) {
+            unused.push_back(std::make_pair(item.second.lastUsed, item.first));
+        }
+    }
+    std::sort(unused.begin(), unused.end());
+    
+    for (auto &item : unused) {
+        if (_cachedBufferBytes <= _bufferCacheSize) {
+            break;
+        }
+        auto it = _bufferCache.find(item.second);
+        // clear old error
+        alGetError();
+        alDeleteBuffers(1, &it->second.bufferID);
+        if (alGetError() != AL_NO_ERROR) {
+            // still attached to a source, deleted by a later trim
+            continue;
+        }
+        _cachedBufferBytes -= it->second.size;
+        _bufferCache.erase(it);
+    }
+}
+
+/******************** streams ********************/
+RDAudioStream *RDAudio::newStream(const char *filename)
+{
+    ALuint sourceID = 0;
+    ALuint bufferIDs[STREAM_BUFFER_COUNT];
+    // clear old error
+    alGetError();
+    alGenSources(1, &sourceID);
+    if (alGetError() != AL_NO_ERROR) {
+        cocos2d::log("Error: RDAudio_NewStream can't gen OpenAL Source");
+        return nullptr;
+    }
+    alGenBuffers(STREAM_BUFFER_COUNT, bufferIDs);
+    if (alGetError() != AL_NO_ERROR) {
+        cocos2d::log("Error: RDAudio_NewStream can't gen OpenAL Buffer");
+        alDeleteSources(1, &sourceID);
+        return nullptr;
+    }
+    
+    RDAudioStream *stream = new (std::nothrow) RDAudioStream(filename, sourceID, bufferIDs);
+    std::unique_lock<std::mutex> lock(_streamMutex);
+    _streams.push_back(stream);
+    // start stream thread
+    if (!_streamThread) {
+        _streamThread = new std::thread(&RDAudio::streamLoop, this);
+    }
+    return stream;
+}
+
+void RDAudio::deleteStream(RDAudioStream *stream)
+{
+    // wait for the stream thread to leave the stream
+    std::unique_lock<std::mutex> lock(_streamMutex);
+    auto it = std::find(_streams.begin(), _streams.end(), stream);
+    if (it != _streams.end()) {
+        _streams.erase(it);
+    }
+    lock.unlock();
+    
+    delete stream;
+}
+
+void RDAudio::streamLoop()
+{
+    std::unique_lock<std::mutex> lock(_streamMutex);
+    while (!_needQuit) {
+        if (!_streamsSuspended) {
+            for (auto stream : _streams) {
+                stream->update();
+            }
+        }
+        _streamCondition.wait_for(lock, std::chrono::milliseconds(STREAM_UPDATE_MS));
+    }
+}
+
+RDAudioStream::RDAudioStream(const char *filename, ALuint sourceID, const ALuint *bufferIDs)
+: _filename(filename)
+, _source(sourceID)
+, _buffers(bufferIDs, bufferIDs + STREAM_BUFFER_COUNT)
+, _decoder(nullptr)
+, _format(AL_FORMAT_STEREO16)
+, _rate(0)
+, _isLoop(false)
+, _started(false)
+, _playing(false)
+, _paused(false)
+, _restart(false)
+, _ended(false)
+{
+}
+
+RDAudioStream::~RDAudioStream()
+{
+    alSourceStop(_source);
+    // deattach buffers from the source
+    alSourcei(_source, AL_BUFFER, 0);
+    alDeleteSources(1, &_source);
+    alDeleteBuffers((ALsizei)_buffers.size(), _buffers.data());
+    closeOggStream(_decoder);
+}
+
+void RDAudioStream::play(bool isLoop)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _isLoop = isLoop;
+    _started = true;
+    _playing = true;
+    _paused = false;
+    // the stream thread rewinds and fills the queue
+    _restart = true;
+    lock.unlock();
+    
+    RDAudio::getInstance()->_streamCondition.notify_one();
+}
+
+void RDAudioStream::pause()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_playing) {
+        _paused = true;
+        alSourcePause(_source);
+    }
+}
+
+void RDAudioStream::resume()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_playing && _paused) {
+        _paused = false;
+        ALint stat;
+        alGetSourcei(_source, AL_SOURCE_STATE, &stat);
+        if (stat == AL_PAUSED) { // only resume on pause state
+            alSourcePlay(_source);
+        }
+    }
+}
+
+void RDAudioStream::stop()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _playing = false;
+    _paused = false;
+    _restart = false;
+    alSourceStop(_source);
+    // deattach buffers from the source
+    alSourcei(_source, AL_BUFFER, 0);
+}
+
+void RDAudioStream::setVolume(float volume)
+{
+    alSourcef(_source, AL_GAIN, volume);
+}
+
+RDAudioStream::State RDAudioStream::getState()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_started) {
+        return INITIAL;
+    }
+    if (!_playing) {
+        return STOPPED;
+    }
+    return _paused ? PAUSED : PLAYING;
+}
+
+bool RDAudioStream::open()
+{
+    _oggData = cocos2d::FileUtils::getInstance()->getDataFromFile(_filename);
+    if (_oggData.getSize() > 0) {
+        int channels = 0;
+        _decoder = openOggStream(_oggData.getBytes(), (int)_oggData.getSize(), &channels, &_rate);
+        if (_decoder) {
+            _format = (channels == 1) ? AL_FORMAT_MONO16 : AL_FORMAT_STEREO16;
+            // whole frames of 16 bits samples
+            const int frameSize = (channels == 1) ? 2 : 4;
+            _pcm.resize(std::max(_rate * STREAM_BUFFER_MS / 1000, 1) * frameSize);
+            return true;
+        }
+    }
+    _oggData.clear();
+    cocos2d::log("Fail to stream file: %s, ONLY support ogg now!", _filename.c_str());
+    return false;
+}
+
+void RDAudioStream::rewind()
+{
+    if (rewindOggStream(_decoder) < 0) {
+        cocos2d::log("Error: RDAudioStream can't rewind %s", _filename.c_str());
+    }
+    _ended = false;
+}
+
+bool RDAudioStream::fillBuffer(ALuint bufferID)
+{
+    const int capacity = (int)_pcm.size();
+    int size = 0;
+    bool rewound = false;
+    while (size < capacity) {
+        int read = readOggStream(_decoder, _pcm.data() + size, capacity - size);
+        if (read > 0) {
+            size += read;
+        } else if (read == 0 && _isLoop && !rewound) {
+            // loop back to the start, once per buffer for empty tracks
+            rewound = rewindOggStream(_decoder) == 0;
+            if (!rewound) {
+                _ended = true;
+                break;
+            }
+        } else {
+            if (read < 0) {
+                cocos2d::log("Error: RDAudioStream fail to decode %s", _filename.c_str());
+            }
+            _ended = true;
+            break;
+        }
+    }
+    if (size == 0) {
+        return false;
+    }
+    alBufferData(bufferID, _format, _pcm.data(), size, _rate);
+    return true;
+}
+
+void RDAudioStream::update()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_playing) {
+        return;
+    }
+    
+    if (_restart) {
+        _restart = false;
+        alSourceStop(_source);
+        alSourcei(_source, AL_BUFFER, 0);
+        if (!_decoder && !open()) {
+            _playing = false;
+            return;
+        }
+        rewind();
+        ALsizei count = 0;
+        while (count < (ALsizei)_buffers.size() && !_ended && fillBuffer(_buffers[count])) {
+            ++count;
+        }
+        if (count == 0) {
+            _playing = false;
+            return;
+        }
+        alSourceQueueBuffers(_source, count, _buffers.data());
+        if (!_paused) {
+            alSourcePlay(_source);
+        }
+        return;
+    }
+    
+    // refill the buffers which have been played
+    ALint processed = 0;
+    alGetSourcei(_source, AL_BUFFERS_PROCESSED, &processed);
+    while (processed-- > 0) {
+        ALuint bufferID = 0;
+        alSourceUnqueueBuffers(_source, 1, &bufferID);
+        if (!_ended && fillBuffer(bufferID)) {
+            alSourceQueueBuffers(_source, 1, &bufferID);
+        }
+    }
+    
+    ALint queued = 0;
+    alGetSourcei(_source, AL_BUFFERS_QUEUED, &queued);
+    if (queued == 0) {
+        // played to the end
+        _playing = false;
+        return;
+    }
+    if (!_paused) {
+        ALint stat;
+        alGetSourcei(_source, AL_SOURCE_STATE, &stat);
+        // the queue ran dry before it was refilled, or the source never started
+        if (stat != AL_PLAYING) {
+            alSourcePlay(_source);
+        }
+    }
+}
@@ -16,6 +16,8 @@
 #define __RDAudio_H__
 
 #include <queue>
+#include <vector>
+#include <unordered_map>
 #include <thread>
 #include <string>
 #include <mutex>
@@ -23,10 +25,61 @@
 
 #include "platform/CCPlatformConfig.h"
 #include "base/CCRef.h"
+#include "base/CCData.h"
 
 #include "alext.h"
 
 typedef void (*AudioCallback)(int funcID, ALuint bufferID);
+typedef struct RDOggStream RDOggStream;
+
+// Plays an ogg file through a small ring of OpenAL buffers, which the stream thread
+// of RDAudio decodes and queues while the track plays. For long tracks like BGM.
+class CC_DLL RDAudioStream
+{
+public:
+    // same values as Rapid2D_CAudioPlayer.getStat()
+    enum State {
+        INITIAL = 1,
+        PLAYING = 2,
+        PAUSED = 3,
+        STOPPED = 4,
+    };
+    
+    void play(bool isLoop);
+    void pause();
+    void resume();
+    void stop();
+    void setVolume(float volume);
+    State getState();
+private:
+    friend class RDAudio;
+    
+    RDAudioStream(const char *filename, ALuint sourceID, const ALuint *bufferIDs);
+    ~RDAudioStream();
+    
+    // called by the stream thread
+    void update();
+    bool open();
+    void rewind();
+    bool fillBuffer(ALuint bufferID);
+    
+    std::string _filename;
+    ALuint _source;
+    std::vector<ALuint> _buffers;
+    cocos2d::Data _oggData;
+    RDOggStream *_decoder;
+    ALenum _format;
+    int _rate;
+    std::vector<unsigned char> _pcm;
+    
+    std::mutex _mutex;
+    bool _isLoop;
+    bool _started;
+    bool _playing;
+    bool _paused;
+    bool _restart;
+    bool _ended;
+};
 
 class CC_DLL RDAudio : public cocos2d::Ref
 {
@@ -39,14 +92,32 @@ public:
     
     void pause();
     void resume();
+    // decoded by a pool of threads, concurrent requests of a file share one decode
+    // the callback owns a reference to the buffer, give it back with releaseBuffer
     void loadFileAsyn(const char *filename, int funcID, AudioCallback cb);
+    void releaseBuffer(ALuint bufferID);
+    
+    // the buffers no longer referenced stay cached, the least recently used ones
+    // are deleted once all the buffers take more than the cache size
+    void setBufferCacheSize(size_t bytes);
+    size_t getBufferCacheSize() const { return _bufferCacheSize; }
+    size_t getCachedBufferBytes() const { return _cachedBufferBytes; }
+    
+    // streaming, the file is read and decoded by the stream thread
+    RDAudioStream *newStream(const char *filename);
+    void deleteStream(RDAudioStream *stream);
 private:
+    friend class RDAudioStream;
+    
+    struct Waiter {
+        int funcID;
+        AudioCallback cb;
+    };
+    
     struct AsyncStruct {
     public:
-        AsyncStruct(const char *fn, int fid, AudioCallback func)
+        AsyncStruct(const char *fn)
         : filename(fn)
-        , cb(func)
-        , funcID(fid)
         , pcmData(NULL)
         , channels(0)
         , rate(0)
@@ -58,18 +129,27 @@ private:
             if (pcmData) free(pcmData);
         };
         std::string filename;
-        AudioCallback cb;
-        int funcID;
+        std::vector<Waiter> waiters;
         unsigned char *pcmData;
         int channels;
         int rate;
         int size;
     };
     
+    struct CachedBuffer {
+        ALuint bufferID;
+        size_t size;
+        // buffers held by lua and callbacks pending
+        int refs;
+        unsigned int lastUsed;
+    };
+    
     void init();
     void threadLoop();
+    void streamLoop();
     void scheduleLoop(float);
     void waitForQuit();
+    void trimBufferCache();
  
     static RDAudio *s_instant;
     // OpenAL
@@ -78,12 +158,25 @@ private:
     // thread relative
     bool _needQuit;
     int _asyncRefCount;
-    std::thread *_thread = NULL;
+    std::vector<std::thread *> _threads;
     std::queue<AsyncStruct *> _inQueue;
     std::queue<AsyncStruct *> _outQueue;
     std::mutex _inMutex;
     std::mutex _outMutex;
     std::condition_variable _inCondition;
+    // main thread only
+    std::unordered_map<std::string, AsyncStruct *> _pending;
+    std::vector<std::pair<std::string, Waiter>> _cacheHits;
+    std::unordered_map<std::string, CachedBuffer> _bufferCache;
+    size_t _bufferCacheSize;
+    size_t _cachedBufferBytes;
+    unsigned int _cacheClock;
+    // streams
+    std::thread *_streamThread = NULL;
+    std::vector<RDAudioStream *> _streams;
+    std::mutex _streamMutex;
+    std::condition_variable _streamCondition;
+    bool _streamsSuspended;
 };
 
 #endif // __RDAudio_H__
@@ -132,3 +132,75 @@ int decodeOgg(unsigned char *oggData,
     ov_clear(&ov);
     return 0;
 }
+
+struct RDOggStream
+{
+    // read by the vorbis callbacks, must not move
+    ogg_buffer buffer;
+    OggVorbis_File ov;
+};
+
+RDOggStream *openOggStream(unsigned char *oggData,
+                           int oggSize,
+                           int *pcmChannels,
+                           int *pcmRate)
+{
+    RDOggStream *stream = (RDOggStream *)calloc(1, sizeof(RDOggStream));
+    if (!stream) {
+        return NULL;
+    }
+    stream->buffer.curPtr = stream->buffer.filePtr = oggData;
+    stream->buffer.fileSize = oggSize;
+    
+    ov_callbacks callbacks;
+    callbacks.read_func = readOgg;
+    callbacks.seek_func = seekOgg;
+    callbacks.close_func = closeOgg;
+    callbacks.tell_func = tellOgg;
+    
+    if (ov_open_callbacks((void *)&stream->buffer, &stream->ov, NULL, -1, callbacks) != 0) {
+        free(stream);
+        return NULL;
+    }
+    vorbis_info *vi = ov_info(&stream->ov, -1);
+    if (!vi) {
+        closeOggStream(stream);
+        return NULL;
+    }
+    *pcmChannels = vi->channels;
+    *pcmRate = (int)(vi->rate);
+    return stream;
+}
+
+int readOggStream(RDOggStream *stream, unsigned char *pcmData, int size)
+{
+    int read = 0;
+    int section = 0;
+    while (read < size) {
+        long status = ov_read(&stream->ov, (char *)(pcmData + read), size - read, 0, 2, 1, &section);
+        if (status > 0) {
+            read += status;
+        } else if (status == OV_HOLE) {
+            // corrupted page, skip it
+            continue;
+        } else if (status < 0) {
+            return -1;
+        } else {
+            break;
+        }
+    }
+    return read;
+}
+
+int rewindOggStream(RDOggStream *stream)
+{
+    return ov_pcm_seek(&stream->ov, 0) == 0 ? 0 : -1;
+}
+
+void closeOggStream(RDOggStream *stream)
+{
+    if (stream) {
+        ov_clear(&stream->ov);
+        free(stream);
+    }
+}
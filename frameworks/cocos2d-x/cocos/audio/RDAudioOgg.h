@@ -26,6 +26,18 @@ int decodeOgg(unsigned char *oggData,
               int *pcmRate,
               int *pcmSize);
 
+// Decodes an ogg file a part at a time, oggData must stay valid until the stream is closed.
+typedef struct RDOggStream RDOggStream;
+
+RDOggStream *openOggStream(unsigned char *oggData,
+                           int oggSize,
+                           int *pcmChannels,
+                           int *pcmRate);
+// returns the number of bytes decoded, 0 at the end of the file, -1 on error
+int readOggStream(RDOggStream *stream, unsigned char *pcmData, int size);
+int rewindOggStream(RDOggStream *stream);
+void closeOggStream(RDOggStream *stream);
+
 #ifdef __cplusplus
 }
 #endif
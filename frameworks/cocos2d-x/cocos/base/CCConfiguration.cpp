@@ -53,6 +53,7 @@ Configuration::Configuration()
 , _supportsOESMapBuffer(false)
 , _supportsOESDepth24(false)
 , _supportsOESPackedDepthStencil(false)
+, _supportsOESElementIndexUint(false)
 , _maxDirLightInShader(1)
 , _maxPointLightInShader(1)
 , _maxSpotLightInShader(1)
@@ -154,6 +155,9 @@ void Configuration::gatherGPUInfo()
     _valueDict["supports_OES_depth24"] = Value(_supportsOESDepth24);
     
     _glExtensions = _deviceInfo->getExtension();
+
+    _supportsOESElementIndexUint = checkForGLExtension("GL_OES_element_index_uint");
+    _valueDict["supports_OES_element_index_uint"] = Value(_supportsOESElementIndexUint);
 }
 
 Configuration* Configuration::getInstance()
@@ -260,6 +264,15 @@ bool Configuration::supportsMapBuffer() const
 #endif
 }
 
+bool Configuration::supportsElementIndexUint() const
+{
+#ifdef CC_USE_GLES
+    return _supportsOESElementIndexUint;
+#else
+    return true;
+#endif
+}
+
 bool Configuration::supportsOESDepth24() const
 {
     return _supportsOESDepth24;
@@ -164,6 +164,14 @@ public:
      */
     bool supportsMapBuffer() const;
 
+    /** Whether or not 32-bit indices can be drawn.
+     *
+     * They are always supported by OpenGL and Metal, OpenGL ES 2.0 needs the extension `GL_OES_element_index_uint`.
+     *
+     * @return Whether or not `IndexFormat::U_INT` is supported.
+     */
+    bool supportsElementIndexUint() const;
+
     
     /** Max support directional light in shader, for Sprite3D.
      *
@@ -255,6 +263,7 @@ protected:
     bool            _supportsOESMapBuffer;
     bool            _supportsOESDepth24;
     bool            _supportsOESPackedDepthStencil;
+    bool            _supportsOESElementIndexUint;
     
     std::string     _glExtensions;
     int             _maxDirLightInShader; //max support directional light in shader
@@ -51,7 +51,11 @@ _bytes(nullptr),
 _size(0)
 {
     CCLOGINFO("In the copy constructor of Data.");
-    if (other._bytes && other._size)
+    if (other.isView())
+    {
+        setView(other._bytes, other._size, other._viewOwner);
+    }
+    else if (other._bytes && other._size)
     {
         copy(other._bytes, other._size);
     }
@@ -68,7 +72,10 @@ Data& Data::operator= (const Data& other)
     if (this != &other)
     {
         CCLOGINFO("In the copy assignment of Data.");
-        copy(other._bytes, other._size);
+        if (other.isView())
+            setView(other._bytes, other._size, other._viewOwner);
+        else
+            copy(other._bytes, other._size);
     }
     return *this;
 }
@@ -89,6 +96,7 @@ void Data::move(Data& other)
     
     _bytes = other._bytes;
     _size = other._size;
+    _viewOwner = std::move(other._viewOwner);
 
     other._bytes = nullptr;
     other._size = 0;
@@ -116,11 +124,13 @@ ssize_t Data::copy(const unsigned char* bytes, const ssize_t size)
 
     if (size <= 0) return 0;
 
-    if (bytes != _bytes)
+    if (bytes != _bytes || isView())
     {
+        // bytes may belong to the view being cleared
+        auto newBytes = (unsigned char*)malloc(sizeof(unsigned char) * size);
+        memcpy(newBytes, bytes, size);
         clear();
-        _bytes = (unsigned char*)malloc(sizeof(unsigned char) * size);
-        memcpy(_bytes, bytes, size);
+        _bytes = newBytes;
     }
 
     _size = size;
@@ -133,17 +143,43 @@ void Data::fastSet(unsigned char* bytes, const ssize_t size)
     //CCASSERT(bytes, "bytes should not be nullptr");
     _bytes = bytes;
     _size = size;
+    _viewOwner.reset();
+}
+
+void Data::setView(const unsigned char* bytes, const ssize_t size, std::shared_ptr<const void> keepAlive)
+{
+    CCASSERT(size >= 0, "setView size should be non-negative");
+    CCASSERT(keepAlive, "keepAlive should not be nullptr");
+    clear();
+    _bytes = const_cast<unsigned char*>(bytes);
+    _size = size;
+    _viewOwner = std::move(keepAlive);
+}
+
+bool Data::isView() const
+{
+    return _viewOwner != nullptr;
 }
 
 void Data::clear()
 {
-    if(_bytes) free(_bytes);
+    if(_bytes && !_viewOwner) free(_bytes);
     _bytes = nullptr;
     _size = 0;
+    _viewOwner.reset();
 }
 
 unsigned char* Data::takeBuffer(ssize_t* size)
 {
+    if (isView())
+    {
+        // the bytes are not ours to give away
+        Data owned;
+        owned.copy(_bytes, _size);
+        clear();
+        return owned.takeBuffer(size);
+    }
+
     auto buffer = getBytes();
     if (size)
         *size = getSize();
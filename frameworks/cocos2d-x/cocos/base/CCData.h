@@ -30,6 +30,7 @@
 #include "platform/CCPlatformMacros.h"
 #include <stdint.h> // for ssize_t on android
 #include <string>   // for ssize_t on linux
+#include <memory>
 #include "platform/CCStdC.h" // for ssize_t on window
 
 /**
@@ -110,6 +111,22 @@ public:
      */
     void fastSet(unsigned char* bytes, const ssize_t size);
 
+    /** Makes the data a read-only view of bytes owned by another object, nothing is copied.
+     *  Copies of the data share the view, `takeBuffer` returns a copy of the bytes.
+     *  @param bytes The buffer pointer, it must not be modified through `getBytes`.
+     *  @param size The size of the buffer.
+     *  @param keepAlive The owner of the bytes, kept alive while the data or one of its copies uses them.
+     *  @see FileUtils::getDataViewFromFile
+     */
+    void setView(const unsigned char* bytes, const ssize_t size, std::shared_ptr<const void> keepAlive);
+
+    /**
+     * Check whether the data is a view of bytes owned by another object.
+     *
+     * @return True if the bytes are not owned by the data.
+     */
+    bool isView() const;
+
     /**
      * Clears data, free buffer and reset data size.
      */
@@ -149,6 +166,7 @@ private:
 private:
     unsigned char* _bytes;
     ssize_t _size;
+    std::shared_ptr<const void> _viewOwner;
 };
 
 
@@ -247,6 +247,9 @@ void Director::setGLDefaultValues()
 // Draw the Scene
 void Director::drawScene()
 {
+#if CC_ENABLE_SCRIPT_BINDING
+    auto frameStart = std::chrono::steady_clock::now();
+#endif
     _renderer->beginFrame();
 
     // calculate "global" dt
@@ -325,6 +328,16 @@ void Director::drawScene()
     
     _renderer->endFrame();
 
+#if CC_ENABLE_SCRIPT_BINDING
+    // let the script engine collect garbage in the time left until the next frame
+    auto sEngine = ScriptEngineManager::getInstance()->getScriptEngine();
+    if (sEngine)
+    {
+        auto frameTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - frameStart).count() / 1000000.0f;
+        sEngine->collectGarbageInIdleTime(_animationInterval - frameTime);
+    }
+#endif
+
     if (_displayStats)
     {
 #if !CC_STRIP_FPS
@@ -1032,6 +1045,8 @@ void Director::reset()
 
 void Director::purgeDirector()
 {
+    // The render thread uses the GL context of the view, give it back before releasing anything.
+    _renderer->setPipelinedRenderingEnabled(false);
     reset();
 
 //    CHECK_GL_ERROR_DEBUG();
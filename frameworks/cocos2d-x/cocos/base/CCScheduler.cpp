@@ -674,6 +674,8 @@ void Scheduler::unscheduleScriptEntry(unsigned int scheduleScriptEntryID)
         if (entry->getEntryId() == (int)scheduleScriptEntryID)
         {
             entry->markedForDeletion();
+            // release the handler now, a batched dispatch of this frame must skip it
+            ScriptEngineManager::getInstance()->getScriptEngine()->removeScriptHandler(entry->getHandler());
             break;
         }
     }
@@ -921,6 +923,11 @@ void Scheduler::update(float dt)
     // Iterate over all the script callbacks
     if (!_scriptHandlerEntries.empty())
     {
+        auto engine = ScriptEngineManager::getInstance()->getScriptEngine();
+        if (engine)
+        {
+            engine->beginScheduleBatch();
+        }
         for (auto i = _scriptHandlerEntries.size() - 1; i >= 0; i--)
         {
             SchedulerScriptHandlerEntry* eachEntry = _scriptHandlerEntries.at(i);
@@ -933,6 +940,10 @@ void Scheduler::update(float dt)
                 eachEntry->getTimer()->update(dt);
             }
         }
+        if (engine)
+        {
+            engine->endScheduleBatch();
+        }
     }
 #endif
     //
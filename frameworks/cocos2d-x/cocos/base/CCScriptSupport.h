@@ -619,6 +619,19 @@ public:
 
     /** Triggers the garbage collector */
     virtual void garbageCollect() {}
+
+    /** Called by the Scheduler before the script schedule callbacks of a frame.
+     The engine may queue the kScheduleEvent sent until endScheduleBatch and deliver them together.
+     */
+    virtual void beginScheduleBatch() {}
+
+    /** Called by the Scheduler after the script schedule callbacks of a frame, delivers the queued callbacks. */
+    virtual void endScheduleBatch() {}
+
+    /** Called by the Director at the end of each frame with the time left until the next one, in seconds.
+     The engine may run its garbage collector incrementally within that time.
+     */
+    virtual void collectGarbageInIdleTime(float /*idleTime*/) {}
 };
 
 class Node;
@@ -172,6 +172,7 @@ THE SOFTWARE.
 // platform
 #include "platform/CCCommon.h"
 #include "platform/CCDevice.h"
+#include "platform/CCFileArchive.h"
 #include "platform/CCFileUtils.h"
 #include "platform/CCImage.h"
 #include "platform/CCPlatformConfig.h"
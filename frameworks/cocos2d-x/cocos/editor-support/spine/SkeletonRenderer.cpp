@@ -644,11 +644,7 @@ namespace spine {
 
 		// Draw bounding rectangle
 		if (_debugBoundingRect) {
-#if COCOS2D_VERSION < 0x00040000
-			glLineWidth(2);
-#else
 			drawNode->setLineWidth(2.0f);
-#endif
 			const cocos2d::Rect brect = getBoundingBox();
 			const Vec2 points[4] =
 			{
@@ -663,11 +659,7 @@ namespace spine {
 		if (_debugSlots) {
 			// Slots.
 			// DrawPrimitives::setDrawColor4B(0, 0, 255, 255);
-#if COCOS2D_VERSION < 0x00040000
-			glLineWidth(2);
-#else
 			drawNode->setLineWidth(2.0f);
-#endif
 			V3F_C4B_T2F_Quad quad;
 			for (int i = 0, n = _skeleton->getSlots().size(); i < n; i++) {
 				Slot* slot = _skeleton->getDrawOrder()[i];
@@ -695,11 +687,7 @@ namespace spine {
 
 		if (_debugBones) {
 			// Bone lengths.
-#if COCOS2D_VERSION < 0x00040000
-			glLineWidth(2);
-#else
 			drawNode->setLineWidth(2.0f);
-#endif
 			for (int i = 0, n = _skeleton->getBones().size(); i < n; i++) {
 				Bone *bone = _skeleton->getBones()[i];
 				if (!bone->isActive()) continue;
@@ -719,11 +707,7 @@ namespace spine {
 
 		if (_debugMeshes) {
 			// Meshes.
-#if COCOS2D_VERSION < 0x00040000
-			glLineWidth(2);
-#else
 			drawNode->setLineWidth(2.0f);
-#endif
 			for (int i = 0, n = _skeleton->getSlots().size(); i < n; ++i) {
 				Slot* slot = _skeleton->getDrawOrder()[i];
 				if (!slot->getBone().isActive()) continue;
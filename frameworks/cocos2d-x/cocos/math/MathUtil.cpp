@@ -20,7 +20,9 @@ This file was modified to fit the cocos2d-x project
 */
 
 #include "math/MathUtil.h"
+#include "math/Mat4.h"
 #include "base/ccMacros.h"
+#include "base/ccTypes.h"
 
 #if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
 #include <cpu-features.h>
@@ -276,4 +278,37 @@ void MathUtil::crossVec3(const float* v1, const float* v2, float* dst)
 #endif
 }
 
+void MathUtil::transformVertices(V3F_C4B_T2F* dst, const V3F_C4B_T2F* src, size_t count, const Mat4& transform)
+{
+#if defined (USE_NEON64)
+    MathUtilNeon64::transformVertices(dst, src, count, transform);
+#elif defined (USE_SSE)
+    transformVertices(transform.col, dst, src, count);
+#else
+    MathUtilC::transformVertices(dst, src, count, transform);
+#endif
+}
+
+void MathUtil::transformIndices(unsigned short* dst, const unsigned short* src, size_t count, unsigned short offset)
+{
+#if defined (USE_NEON64)
+    MathUtilNeon64::transformIndices(dst, src, count, offset);
+#elif defined (USE_SSE) && defined (__SSE2__)
+    transformIndicesSSE2(dst, src, count, offset);
+#else
+    MathUtilC::transformIndices(dst, src, count, offset);
+#endif
+}
+
+void MathUtil::transformIndices(unsigned int* dst, const unsigned short* src, size_t count, unsigned int offset)
+{
+#if defined (USE_NEON64)
+    MathUtilNeon64::transformIndices(dst, src, count, offset);
+#elif defined (USE_SSE) && defined (__SSE2__)
+    transformIndicesSSE2(dst, src, count, offset);
+#else
+    MathUtilC::transformIndices(dst, src, count, offset);
+#endif
+}
+
 NS_CC_MATH_END
@@ -36,6 +36,9 @@
 
 NS_CC_MATH_BEGIN
 
+class Mat4;
+struct V3F_C4B_T2F;
+
 /**
  * Defines a math utility class.
  *
@@ -88,6 +91,37 @@ public:
      * @return interpolated float value
      */
     static float lerp(float from, float to, float alpha);
+
+    /**
+     * Copies count vertices from src to dst, transforming their positions by the given matrix.
+     * Colors and texture coordinates are copied as is. dst and src must not overlap.
+     *
+     * @param dst the destination vertices.
+     * @param src the source vertices.
+     * @param count the number of vertices.
+     * @param transform the matrix applied to every position.
+     */
+    static void transformVertices(V3F_C4B_T2F* dst, const V3F_C4B_T2F* src, size_t count, const Mat4& transform);
+
+    /**
+     * Copies count indices from src to dst, adding offset to every index.
+     *
+     * @param dst the destination indices.
+     * @param src the source indices.
+     * @param count the number of indices.
+     * @param offset the value added to every index.
+     */
+    static void transformIndices(unsigned short* dst, const unsigned short* src, size_t count, unsigned short offset);
+
+    /**
+     * Widens count indices from src into dst, adding offset to every index.
+     *
+     * @param dst the destination indices.
+     * @param src the source indices.
+     * @param count the number of indices.
+     * @param offset the value added to every index.
+     */
+    static void transformIndices(unsigned int* dst, const unsigned short* src, size_t count, unsigned int offset);
 private:
     //Indicates that if neon is enabled
     static bool isNeon32Enabled();
@@ -109,6 +143,8 @@ private:
     static void transposeMatrix(const __m128 m[4], __m128 dst[4]);
         
     static void transformVec4(const __m128 m[4], const __m128& v, __m128& dst);
+
+    static void transformVertices(const __m128 m[4], V3F_C4B_T2F* dst, const V3F_C4B_T2F* src, size_t count);
 #endif
     static void addMatrix(const float* m, float scalar, float* dst);
 
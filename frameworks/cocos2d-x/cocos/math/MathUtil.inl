@@ -42,6 +42,12 @@ public:
     inline static void transformVec4(const float* m, const float* v, float* dst);
     
     inline static void crossVec3(const float* v1, const float* v2, float* dst);
+
+    inline static void transformVertices(V3F_C4B_T2F* dst, const V3F_C4B_T2F* src, size_t count, const Mat4& transform);
+
+    inline static void transformIndices(unsigned short* dst, const unsigned short* src, size_t count, unsigned short offset);
+
+    inline static void transformIndices(unsigned int* dst, const unsigned short* src, size_t count, unsigned int offset);
 };
 
 inline void MathUtilC::addMatrix(const float* m, float scalar, float* dst)
@@ -215,4 +221,36 @@ inline void MathUtilC::crossVec3(const float* v1, const float* v2, float* dst)
     dst[2] = z;
 }
 
+inline void MathUtilC::transformVertices(V3F_C4B_T2F* dst, const V3F_C4B_T2F* src, size_t count, const Mat4& transform)
+{
+    const float* m = transform.m;
+    for (auto end = src + count; src < end; ++src, ++dst)
+    {
+        const float x = src->vertices.x;
+        const float y = src->vertices.y;
+        const float z = src->vertices.z;
+        dst->vertices.x = x * m[0] + y * m[4] + z * m[8] + m[12];
+        dst->vertices.y = x * m[1] + y * m[5] + z * m[9] + m[13];
+        dst->vertices.z = x * m[2] + y * m[6] + z * m[10] + m[14];
+        dst->colors = src->colors;
+        dst->texCoords = src->texCoords;
+    }
+}
+
+inline void MathUtilC::transformIndices(unsigned short* dst, const unsigned short* src, size_t count, unsigned short offset)
+{
+    for (auto end = src + count; src < end; ++src, ++dst)
+    {
+        *dst = *src + offset;
+    }
+}
+
+inline void MathUtilC::transformIndices(unsigned int* dst, const unsigned short* src, size_t count, unsigned int offset)
+{
+    for (auto end = src + count; src < end; ++src, ++dst)
+    {
+        *dst = *src + offset;
+    }
+}
+
 NS_CC_MATH_END
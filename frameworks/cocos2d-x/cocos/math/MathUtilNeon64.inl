@@ -18,6 +18,8 @@
  This file was modified to fit the cocos2d-x project
  */
 
+#include <arm_neon.h>
+
 NS_CC_MATH_BEGIN
 
 class MathUtilNeon64
@@ -42,6 +44,12 @@ public:
     inline static void transformVec4(const float* m, const float* v, float* dst);
     
     inline static void crossVec3(const float* v1, const float* v2, float* dst);
+
+    inline static void transformVertices(V3F_C4B_T2F* dst, const V3F_C4B_T2F* src, size_t count, const Mat4& transform);
+
+    inline static void transformIndices(unsigned short* dst, const unsigned short* src, size_t count, unsigned short offset);
+
+    inline static void transformIndices(unsigned int* dst, const unsigned short* src, size_t count, unsigned int offset);
 };
 
 inline void MathUtilNeon64::addMatrix(const float* m, float scalar, float* dst)
@@ -262,4 +270,56 @@ inline void MathUtilNeon64::crossVec3(const float* v1, const float* v2, float* d
     );
 }
 
+inline void MathUtilNeon64::transformVertices(V3F_C4B_T2F* dst, const V3F_C4B_T2F* src, size_t count, const Mat4& transform)
+{
+    const float32x4_t m0 = vld1q_f32(&transform.m[0]);
+    const float32x4_t m1 = vld1q_f32(&transform.m[4]);
+    const float32x4_t m2 = vld1q_f32(&transform.m[8]);
+    const float32x4_t m3 = vld1q_f32(&transform.m[12]);
+
+    for (auto end = src + count; src < end; ++src, ++dst)
+    {
+        // Reading 4 floats pulls the color bytes into the 4th lane, it is never used.
+        float32x4_t v = vld1q_f32(&src->vertices.x);
+        float32x4_t r = vmlaq_laneq_f32(m3, m0, v, 0);
+        r = vmlaq_laneq_f32(r, m1, v, 1);
+        r = vmlaq_laneq_f32(r, m2, v, 2);
+
+        vst1_f32(&dst->vertices.x, vget_low_f32(r));
+        vst1q_lane_f32(&dst->vertices.z, r, 2);
+        dst->colors = src->colors;
+        dst->texCoords = src->texCoords;
+    }
+}
+
+inline void MathUtilNeon64::transformIndices(unsigned short* dst, const unsigned short* src, size_t count, unsigned short offset)
+{
+    const uint16x8_t offsets = vdupq_n_u16(offset);
+    auto end = src + count;
+    for (auto end8 = src + (count & ~(size_t)7); src < end8; src += 8, dst += 8)
+    {
+        vst1q_u16(dst, vaddq_u16(vld1q_u16(src), offsets));
+    }
+    for (; src < end; ++src, ++dst)
+    {
+        *dst = *src + offset;
+    }
+}
+
+inline void MathUtilNeon64::transformIndices(unsigned int* dst, const unsigned short* src, size_t count, unsigned int offset)
+{
+    const uint32x4_t offsets = vdupq_n_u32(offset);
+    auto end = src + count;
+    for (auto end8 = src + (count & ~(size_t)7); src < end8; src += 8, dst += 8)
+    {
+        uint16x8_t v = vld1q_u16(src);
+        vst1q_u32(dst, vaddq_u32(vmovl_u16(vget_low_u16(v)), offsets));
+        vst1q_u32(dst + 4, vaddq_u32(vmovl_u16(vget_high_u16(v)), offsets));
+    }
+    for (; src < end; ++src, ++dst)
+    {
+        *dst = *src + offset;
+    }
+}
+
 NS_CC_MATH_END
@@ -1,3 +1,7 @@
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 NS_CC_MATH_BEGIN
 
 #ifdef __SSE__
@@ -151,6 +155,55 @@ void MathUtil::transformVec4(const __m128 m[4], const __m128& v, __m128& dst)
                      );
 }
 
+void MathUtil::transformVertices(const __m128 m[4], V3F_C4B_T2F* dst, const V3F_C4B_T2F* src, size_t count)
+{
+    for (auto end = src + count; src < end; ++src, ++dst)
+    {
+        __m128 v = _mm_add_ps(
+                              _mm_add_ps(_mm_mul_ps(m[0], _mm_set1_ps(src->vertices.x)), _mm_mul_ps(m[1], _mm_set1_ps(src->vertices.y))),
+                              _mm_add_ps(_mm_mul_ps(m[2], _mm_set1_ps(src->vertices.z)), m[3])
+                              );
+        // The 4th lane spills over dst->colors, so write colors and texCoords afterwards.
+        _mm_storeu_ps(&dst->vertices.x, v);
+        dst->colors = src->colors;
+        dst->texCoords = src->texCoords;
+    }
+}
+
+#ifdef __SSE2__
+static inline void transformIndicesSSE2(unsigned short* dst, const unsigned short* src, size_t count, unsigned short offset)
+{
+    const __m128i offsets = _mm_set1_epi16((short)offset);
+    auto end = src + count;
+    for (auto end8 = src + (count & ~(size_t)7); src < end8; src += 8, dst += 8)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)src);
+        _mm_storeu_si128((__m128i*)dst, _mm_add_epi16(v, offsets));
+    }
+    for (; src < end; ++src, ++dst)
+    {
+        *dst = *src + offset;
+    }
+}
+
+static inline void transformIndicesSSE2(unsigned int* dst, const unsigned short* src, size_t count, unsigned int offset)
+{
+    const __m128i offsets = _mm_set1_epi32((int)offset);
+    const __m128i zero = _mm_setzero_si128();
+    auto end = src + count;
+    for (auto end8 = src + (count & ~(size_t)7); src < end8; src += 8, dst += 8)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)src);
+        _mm_storeu_si128((__m128i*)dst, _mm_add_epi32(_mm_unpacklo_epi16(v, zero), offsets));
+        _mm_storeu_si128((__m128i*)(dst + 4), _mm_add_epi32(_mm_unpackhi_epi16(v, zero), offsets));
+    }
+    for (; src < end; ++src, ++dst)
+    {
+        *dst = *src + offset;
+    }
+}
+#endif
+
 #endif
 
 
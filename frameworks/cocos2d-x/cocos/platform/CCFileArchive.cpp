@@ -0,0 +1,347 @@
+/****************************************************************************
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+#include "platform/CCFileArchive.h"
+
+#include <string.h>
+#include <zlib.h>
+
+#include "platform/CCFileUtils.h"
+#include "base/ccMacros.h"
+
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32)
+#include "platform/win32/CCUtils-win32.h"
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
+#include <android/asset_manager.h>
+#include "platform/android/CCFileUtils-android.h"
+#endif
+
+NS_CC_BEGIN
+
+namespace
+{
+    const char ARCHIVE_MAGIC[4] = { 'C', 'C', 'P', 'K' };
+    const uint32_t ARCHIVE_VERSION = 1;
+    const size_t HEADER_SIZE = 32;
+    const size_t INDEX_RECORD_SIZE = 32;
+
+    // The archive may be mapped at any address, read integers byte per byte.
+    inline uint32_t readU32(const unsigned char* p)
+    {
+        return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    }
+
+    inline uint64_t readU64(const unsigned char* p)
+    {
+        return (uint64_t)readU32(p) | ((uint64_t)readU32(p + 4) << 32);
+    }
+}
+
+std::shared_ptr<FileArchive> FileArchive::open(const std::string& fullPath)
+{
+    std::shared_ptr<FileArchive> archive(new (std::nothrow) FileArchive(fullPath));
+    if (!archive || !archive->map())
+    {
+        CCLOG("FileArchive: can't open %s", fullPath.c_str());
+        return nullptr;
+    }
+    if (!archive->parse())
+    {
+        CCLOG("FileArchive: %s is not a valid archive", fullPath.c_str());
+        return nullptr;
+    }
+    return archive;
+}
+
+Data FileArchive::mapFile(const std::string& fullPath)
+{
+    Data data;
+    std::shared_ptr<FileArchive> file(new (std::nothrow) FileArchive(fullPath));
+    if (file && file->map())
+        data.setView(file->_bytes, (ssize_t)file->_size, file);
+    return data;
+}
+
+uint32_t FileArchive::hashPath(const char* path, size_t length)
+{
+    // FNV-1a, cmake/scripts/pack_archive.py must use the same hash
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; ++i)
+    {
+        hash ^= (unsigned char)path[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+FileArchive::FileArchive(const std::string& fullPath)
+: _path(fullPath)
+{
+}
+
+FileArchive::~FileArchive()
+{
+    unmap();
+}
+
+bool FileArchive::map()
+{
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
+    // Files inside the apk are read through the asset manager, the buffer is mapped if the archive is stored uncompressed.
+    static const std::string apkprefix("assets/");
+    if (!_path.empty() && _path[0] != '/')
+    {
+        std::string relativePath = _path.compare(0, apkprefix.size(), apkprefix) == 0 ? _path.substr(apkprefix.size()) : _path;
+        auto assetManager = FileUtilsAndroid::getAssetManager();
+        AAsset* asset = assetManager ? AAssetManager_open(assetManager, relativePath.c_str(), AASSET_MODE_BUFFER) : nullptr;
+        if (asset)
+        {
+            auto bytes = AAsset_getBuffer(asset);
+            if (bytes)
+            {
+                _bytes = static_cast<const unsigned char*>(bytes);
+                _size = (size_t)AAsset_getLength64(asset);
+                _asset = asset;
+                _storage = Storage::ASSET;
+                return true;
+            }
+            AAsset_close(asset);
+        }
+    }
+#endif
+
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32)
+    HANDLE file = ::CreateFileW(StringUtf8ToWideChar(_path).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file != INVALID_HANDLE_VALUE)
+    {
+        LARGE_INTEGER size;
+        HANDLE mapping = nullptr;
+        if (::GetFileSizeEx(file, &size) && size.QuadPart > 0)
+            mapping = ::CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        // the view keeps the mapping alive
+        auto bytes = mapping ? ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        if (mapping)
+            ::CloseHandle(mapping);
+        ::CloseHandle(file);
+        if (bytes)
+        {
+            _bytes = static_cast<const unsigned char*>(bytes);
+            _size = (size_t)size.QuadPart;
+            _storage = Storage::MAPPED;
+            return true;
+        }
+    }
+#else
+    int fd = ::open(_path.c_str(), O_RDONLY);
+    if (fd != -1)
+    {
+        struct stat statBuf;
+        void* bytes = MAP_FAILED;
+        if (fstat(fd, &statBuf) == 0 && statBuf.st_size > 0)
+            bytes = mmap(nullptr, (size_t)statBuf.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        // the mapping stays valid after closing the file
+        ::close(fd);
+        if (bytes != MAP_FAILED)
+        {
+            _bytes = static_cast<const unsigned char*>(bytes);
+            _size = (size_t)statBuf.st_size;
+            _storage = Storage::MAPPED;
+            return true;
+        }
+    }
+#endif
+
+    // Not a plain file, e.g. a compressed asset or a file of an obb: read it in memory.
+    Data data;
+    if (FileUtils::getInstance()->getContents(_path, &data) != FileUtils::Status::OK || data.isNull())
+        return false;
+    ssize_t size = 0;
+    _bytes = data.takeBuffer(&size);
+    _size = (size_t)size;
+    _storage = Storage::MEMORY;
+    return true;
+}
+
+void FileArchive::unmap()
+{
+    switch (_storage)
+    {
+        case Storage::MAPPED:
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32)
+            ::UnmapViewOfFile(_bytes);
+#else
+            munmap(const_cast<unsigned char*>(_bytes), _size);
+#endif
+            break;
+        case Storage::ASSET:
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
+            AAsset_close(static_cast<AAsset*>(_asset));
+#endif
+            break;
+        case Storage::MEMORY:
+            free(const_cast<unsigned char*>(_bytes));
+            break;
+        default:
+            break;
+    }
+    _storage = Storage::NONE;
+    _bytes = nullptr;
+    _size = 0;
+    _asset = nullptr;
+}
+
+bool FileArchive::parse()
+{
+    if (_size < HEADER_SIZE || memcmp(_bytes, ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC)) != 0)
+        return false;
+
+    if (readU32(_bytes + 4) != ARCHIVE_VERSION)
+    {
+        CCLOG("FileArchive: unsupported version %u of %s", readU32(_bytes + 4), _path.c_str());
+        return false;
+    }
+
+    const uint64_t entryCount = readU32(_bytes + 8);
+    const uint64_t stringsOffset = readU64(_bytes + 16);
+    const uint64_t stringsSize = readU64(_bytes + 24);
+    if (HEADER_SIZE + entryCount * INDEX_RECORD_SIZE > stringsOffset
+        || stringsOffset > _size || stringsSize > _size - stringsOffset)
+        return false;
+
+    _entryCount = (uint32_t)entryCount;
+    _index = _bytes + HEADER_SIZE;
+    _strings = reinterpret_cast<const char*>(_bytes + stringsOffset);
+    _stringsSize = (size_t)stringsSize;
+    return true;
+}
+
+bool FileArchive::findEntry(const std::string& path, Entry* entry) const
+{
+    const uint32_t hash = hashPath(path.c_str(), path.size());
+
+    // lower bound of the hash
+    uint32_t first = 0;
+    uint32_t count = _entryCount;
+    while (count > 0)
+    {
+        const uint32_t step = count / 2;
+        if (readU32(_index + (size_t)(first + step) * INDEX_RECORD_SIZE) < hash)
+        {
+            first += step + 1;
+            count -= step + 1;
+        }
+        else
+        {
+            count = step;
+        }
+    }
+
+    for (; first < _entryCount; ++first)
+    {
+        const unsigned char* record = _index + (size_t)first * INDEX_RECORD_SIZE;
+        if (readU32(record) != hash)
+            break;
+
+        const uint32_t pathOffset = readU32(record + 4);
+        const uint32_t pathLength = readU32(record + 8);
+        if (pathLength != path.size() || (uint64_t)pathOffset + pathLength > _stringsSize
+            || memcmp(_strings + pathOffset, path.data(), pathLength) != 0)
+            continue;
+
+        const uint64_t offset = readU64(record + 16);
+        const uint32_t size = readU32(record + 24);
+        if (offset > _size || size > _size - offset)
+        {
+            CCLOG("FileArchive: entry %s of %s is out of bounds", path.c_str(), _path.c_str());
+            return false;
+        }
+
+        if (entry)
+        {
+            entry->bytes = _bytes + offset;
+            entry->size = size;
+            entry->originalSize = readU32(record + 28);
+            entry->compression = static_cast<Compression>(readU32(record + 12));
+        }
+        return true;
+    }
+    return false;
+}
+
+std::string FileArchive::getEntryPath(uint32_t index) const
+{
+    CCASSERT(index < _entryCount, "Invalid entry index");
+    const unsigned char* record = _index + (size_t)index * INDEX_RECORD_SIZE;
+    const uint32_t pathOffset = readU32(record + 4);
+    const uint32_t pathLength = readU32(record + 8);
+    if ((uint64_t)pathOffset + pathLength > _stringsSize)
+        return "";
+    return std::string(_strings + pathOffset, pathLength);
+}
+
+bool FileArchive::extract(const Entry& entry, void* buffer) const
+{
+    switch (entry.compression)
+    {
+        case Compression::NONE:
+            if (entry.size != entry.originalSize)
+                return false;
+            memcpy(buffer, entry.bytes, entry.size);
+            return true;
+        case Compression::ZLIB:
+        {
+            uLongf destLength = entry.originalSize;
+            int ret = uncompress(static_cast<Bytef*>(buffer), &destLength, entry.bytes, entry.size);
+            return ret == Z_OK && destLength == entry.originalSize;
+        }
+        default:
+            CCLOG("FileArchive: unsupported compression %u in %s", static_cast<uint32_t>(entry.compression), _path.c_str());
+            return false;
+    }
+}
+
+Data FileArchive::getData(const Entry& entry) const
+{
+    Data data;
+    if (entry.compression == Compression::NONE && entry.size == entry.originalSize)
+    {
+        data.setView(entry.bytes, entry.size, shared_from_this());
+        return data;
+    }
+
+    auto buffer = (unsigned char*)malloc(entry.originalSize > 0 ? entry.originalSize : 1);
+    if (buffer && extract(entry, buffer))
+        data.fastSet(buffer, entry.originalSize);
+    else
+        free(buffer);
+    return data;
+}
+
+NS_CC_END
@@ -0,0 +1,159 @@
+/****************************************************************************
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+#ifndef __CC_FILEARCHIVE_H__
+#define __CC_FILEARCHIVE_H__
+
+#include <string>
+#include <memory>
+#include <stdint.h>
+
+#include "platform/CCPlatformMacros.h"
+#include "base/CCData.h"
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup platform
+ * @{
+ */
+
+/**
+ * A read-only archive packing many resource files into a single file.
+ * Archives are built by `cmake/scripts/pack_archive.py` and mounted with `FileUtils::addSearchArchive`.
+ *
+ * Layout of the archive, all integers are little endian:
+ *  - header: magic "CCPK", version, entry count, blob alignment, offset of the path strings (uint64).
+ *  - index: one record per entry, sorted by path hash (FNV-1a) then path.
+ *    Path hash, path offset and length in the path strings, compression, blob offset (uint64), stored size, original size.
+ *  - path strings, then the blobs aligned to the blob alignment.
+ *
+ * The archive is memory mapped, so looking up an entry doesn't touch the file system
+ * and uncompressed entries are read without copying them.
+ */
+class CC_DLL FileArchive : public std::enable_shared_from_this<FileArchive>
+{
+public:
+    enum class Compression : uint32_t
+    {
+        NONE = 0,
+        ZLIB = 1,
+    };
+
+    struct Entry
+    {
+        const unsigned char* bytes = nullptr; ///< Stored bytes, inside the mapped archive.
+        uint32_t size = 0;                    ///< Stored size.
+        uint32_t originalSize = 0;            ///< Size once decompressed.
+        Compression compression = Compression::NONE;
+    };
+
+    /**
+     * Opens an archive.
+     * @param fullPath The full path of the archive, as returned by `FileUtils::fullPathForFilename`.
+     * @return The archive, or nullptr if it can't be opened or is invalid.
+     */
+    static std::shared_ptr<FileArchive> open(const std::string& fullPath);
+
+    /**
+     * Maps a whole file read-only, e.g. to read another archive format in place.
+     * Falls back to reading the file in memory when it can't be mapped.
+     * @param fullPath The full path of the file.
+     * @return A view of the file which keeps it mapped, see `Data::setView`, null if it can't be read.
+     */
+    static Data mapFile(const std::string& fullPath);
+
+    /** Hash of a path in the index of the archive. */
+    static uint32_t hashPath(const char* path, size_t length);
+
+    ~FileArchive();
+
+    /**
+     * Looks up an entry.
+     * @param path The path of the entry relative to the root of the archive, using '/' as separator.
+     * @param entry Filled with the entry if it is found, may be nullptr.
+     * @return Whether the archive contains the entry.
+     */
+    bool findEntry(const std::string& path, Entry* entry) const;
+
+    /**
+     * Decompresses or copies an entry.
+     * @param entry An entry of this archive.
+     * @param buffer Receives `entry.originalSize` bytes.
+     * @return Whether the entry could be decompressed.
+     */
+    bool extract(const Entry& entry, void* buffer) const;
+
+    /**
+     * Gets the contents of an entry. Uncompressed entries are returned as a view of the mapped
+     * archive which keeps the archive alive, see `Data::setView`.
+     * @param entry An entry of this archive.
+     * @return The contents of the entry, null if it can't be decompressed.
+     */
+    Data getData(const Entry& entry) const;
+
+    /** Gets the full path of the archive. */
+    const std::string& getPath() const { return _path; }
+
+    /** Gets the number of entries of the archive. */
+    uint32_t getEntryCount() const { return _entryCount; }
+
+    /**
+     * Gets the path of an entry, entries are ordered by path hash.
+     * @param index The index of the entry, less than getEntryCount().
+     * @return The path of the entry relative to the root of the archive.
+     */
+    std::string getEntryPath(uint32_t index) const;
+
+private:
+    FileArchive(const std::string& fullPath);
+    bool map();
+    void unmap();
+    bool parse();
+
+    std::string _path;
+    const unsigned char* _bytes = nullptr;
+    size_t _size = 0;
+    uint32_t _entryCount = 0;
+    const unsigned char* _index = nullptr;
+    const char* _strings = nullptr;
+    size_t _stringsSize = 0;
+
+    // what to release in unmap()
+    enum class Storage
+    {
+        NONE,
+        MAPPED,
+        ASSET,
+        MEMORY,
+    };
+    Storage _storage = Storage::NONE;
+    void* _asset = nullptr;
+};
+
+// end of platform group
+/** @} */
+
+NS_CC_END
+
+#endif // __CC_FILEARCHIVE_H__
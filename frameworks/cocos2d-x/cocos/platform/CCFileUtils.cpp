@@ -394,6 +394,7 @@ bool FileUtils::writeValueMapToFile(const ValueMap& dict, const std::string& ful
     rootEle->LinkEndChild(innerDict);
 
     bool ret = tinyxml2::XML_SUCCESS == doc->SaveFile(getSuitableFOpen(fullPath).c_str());
+    clearNegativeCache();
 
     delete doc;
     return ret;
@@ -434,6 +435,7 @@ bool FileUtils::writeValueVectorToFile(const ValueVector& vecData, const std::st
     rootEle->LinkEndChild(innerDict);
 
     bool ret = tinyxml2::XML_SUCCESS == doc->SaveFile(getSuitableFOpen(fullPath).c_str());
+    clearNegativeCache();
 
     delete doc;
     return ret;
@@ -587,6 +589,7 @@ bool FileUtils::writeDataToFile(const Data& data, const std::string& fullPath) c
         fwrite(data.getBytes(), size, 1, fp);
 
         fclose(fp);
+        clearNegativeCache();
 
         return true;
     } while (0);
@@ -612,10 +615,91 @@ bool FileUtils::init()
 void FileUtils::purgeCachedEntries()
 {
     DECLARE_GUARD;
-    _fullPathCache.clear();
+    resetFullPathCache();
     _fullPathCacheDir.clear();
 }
 
+void FileUtils::resetFullPathCache() const
+{
+    DECLARE_GUARD;
+    _fullPathCache.clear();
+    _fullPathMissCache.clear();
+    _fullPathCacheSnapshotSize = 0;
+    std::atomic_store(&_fullPathCacheSnapshot, std::shared_ptr<const std::unordered_map<std::string, std::string>>());
+}
+
+void FileUtils::clearNegativeCache() const
+{
+    DECLARE_GUARD;
+    _fullPathMissCache.clear();
+}
+
+void FileUtils::setNegativeCacheEnabled(bool enabled)
+{
+    DECLARE_GUARD;
+    _negativeCacheEnabled = enabled;
+    _fullPathMissCache.clear();
+}
+
+bool FileUtils::loadPathManifest(const std::string& filename)
+{
+    std::string contents;
+    if (getContents(filename, &contents) != Status::OK)
+    {
+        CCLOG("cocos2d: can't read path manifest %s", filename.c_str());
+        return false;
+    }
+
+    std::unordered_set<std::string> manifest;
+    size_t lineStart = 0;
+    while (lineStart < contents.size())
+    {
+        size_t lineEnd = contents.find('\n', lineStart);
+        if (lineEnd == std::string::npos)
+            lineEnd = contents.size();
+        size_t pathEnd = lineEnd;
+        if (pathEnd > lineStart && contents[pathEnd - 1] == '\r')
+            --pathEnd;
+        if (pathEnd > lineStart && contents[lineStart] != '#')
+            manifest.emplace(contents, lineStart, pathEnd - lineStart);
+        lineStart = lineEnd + 1;
+    }
+
+    DECLARE_GUARD;
+    _pathManifest.swap(manifest);
+    _pathManifestLoaded = true;
+    resetFullPathCache();
+    return true;
+}
+
+void FileUtils::unloadPathManifest()
+{
+    DECLARE_GUARD;
+    _pathManifest.clear();
+    _pathManifestLoaded = false;
+    resetFullPathCache();
+}
+
+FileUtils::PathCacheStats FileUtils::getPathCacheStats() const
+{
+    PathCacheStats stats;
+    stats.lookups = _pathCacheStats.lookups.load(std::memory_order_relaxed);
+    stats.cacheHits = _pathCacheStats.cacheHits.load(std::memory_order_relaxed);
+    stats.negativeCacheHits = _pathCacheStats.negativeCacheHits.load(std::memory_order_relaxed);
+    stats.fileSystemProbes = _pathCacheStats.fileSystemProbes.load(std::memory_order_relaxed);
+    stats.probesAvoided = _pathCacheStats.probesAvoided.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void FileUtils::resetPathCacheStats()
+{
+    _pathCacheStats.lookups = 0;
+    _pathCacheStats.cacheHits = 0;
+    _pathCacheStats.negativeCacheHits = 0;
+    _pathCacheStats.fileSystemProbes = 0;
+    _pathCacheStats.probesAvoided = 0;
+}
+
 std::string FileUtils::getStringFromFile(const std::string& filename) const
 {
     std::string s;
@@ -656,6 +740,24 @@ void FileUtils::getDataFromFile(const std::string& filename, std::function<void(
     }, std::move(callback));
 }
 
+Data FileUtils::getDataViewFromFile(const std::string& filename) const
+{
+    // The decoder modifies the data in place.
+    if (dataDecoder)
+        return getDataFromFile(filename);
+
+    auto fullPath = FileUtils::getInstance()->fullPathForFilename(filename);
+    if (fullPath.empty())
+        return Data();
+
+    FileArchive::Entry entry;
+    auto archive = findArchiveEntry(fullPath, &entry);
+    if (archive)
+        return archive->getData(entry);
+
+    return getDataFromFile(fullPath);
+}
+
 FileUtils::Status FileUtils::getContents(const std::string& filename, ResizableBuffer* buffer) const
 {
     if (filename.empty())
@@ -667,6 +769,10 @@ FileUtils::Status FileUtils::getContents(const std::string& filename, ResizableB
     if (fullPath.empty())
         return Status::NotExists;
 
+    Status archiveStatus = fs->getContentsFromArchive(fullPath, buffer);
+    if (archiveStatus != Status::NotExists)
+        return archiveStatus;
+
     std::string suitableFullPath = fs->getSuitableFOpen(fullPath);
 
     struct stat statBuf;
@@ -801,9 +907,6 @@ std::string FileUtils::getPathForDirectory(const std::string &dir, const std::st
 
 std::string FileUtils::fullPathForFilename(const std::string &filename) const
 {
-    
-    DECLARE_GUARD;
-
     if (filename.empty())
     {
         return "";
@@ -814,36 +917,120 @@ std::string FileUtils::fullPathForFilename(const std::string &filename) const
         return filename;
     }
 
-    // Already Cached ?
+    _pathCacheStats.lookups.fetch_add(1, std::memory_order_relaxed);
+
+    // Already Cached ? Most lookups are served by the published copy of the cache without locking.
+    auto snapshot = std::atomic_load(&_fullPathCacheSnapshot);
+    if (snapshot)
+    {
+        auto snapshotIter = snapshot->find(filename);
+        if (snapshotIter != snapshot->end())
+        {
+            _pathCacheStats.cacheHits.fetch_add(1, std::memory_order_relaxed);
+            _pathCacheStats.probesAvoided.fetch_add(1, std::memory_order_relaxed);
+            return snapshotIter->second;
+        }
+    }
+
+    DECLARE_GUARD;
+
     auto cacheIter = _fullPathCache.find(filename);
     if(cacheIter != _fullPathCache.end())
     {
+        _pathCacheStats.cacheHits.fetch_add(1, std::memory_order_relaxed);
+        _pathCacheStats.probesAvoided.fetch_add(1, std::memory_order_relaxed);
         return cacheIter->second;
     }
 
+    if (_negativeCacheEnabled && _fullPathMissCache.find(filename) != _fullPathMissCache.end())
+    {
+        _pathCacheStats.negativeCacheHits.fetch_add(1, std::memory_order_relaxed);
+        _pathCacheStats.probesAvoided.fetch_add(_searchPathArray.size() * _searchResolutionsOrderArray.size(), std::memory_order_relaxed);
+        return "";
+    }
+
     // Get the new file name.
     const std::string newFilename( getNewFilename(filename) );
 
     std::string fullpath;
+    uint64_t fileSystemProbes = 0;
+    uint64_t probesAvoided = 0;
 
     for (const auto& searchIt : _searchPathArray)
     {
+        const FileArchive* archive = nullptr;
+        for (const auto& searchArchive : _searchArchives)
+        {
+            if (searchArchive.searchPath == searchIt)
+            {
+                archive = searchArchive.archive.get();
+                break;
+            }
+        }
+
+        // paths under the resource root are listed by the manifest
+        const bool inManifest = !archive && _pathManifestLoaded
+            && searchIt.compare(0, _defaultResRootPath.size(), _defaultResRootPath) == 0;
+
         for (const auto& resolutionIt : _searchResolutionsOrderArray)
         {
-            fullpath = this->getPathForFilename(newFilename, resolutionIt, searchIt);
+            if (archive || inManifest)
+            {
+                // same search rule as getPathForFilename, without touching the file system
+                size_t pos = newFilename.find_last_of('/');
+                std::string entryPath = pos != std::string::npos ? newFilename.substr(0, pos + 1) : std::string();
+                entryPath += resolutionIt;
+                if (!entryPath.empty() && entryPath.back() != '/')
+                    entryPath += '/';
+                entryPath += pos != std::string::npos ? newFilename.substr(pos + 1) : newFilename;
+
+                bool found = false;
+                if (archive)
+                    found = archive->findEntry(entryPath, nullptr);
+                else
+                    found = _pathManifest.find(searchIt.substr(_defaultResRootPath.size()) + entryPath) != _pathManifest.end();
+                fullpath = found ? searchIt + entryPath : "";
+                ++probesAvoided;
+            }
+            else
+            {
+                fullpath = this->getPathForFilename(newFilename, resolutionIt, searchIt);
+                ++fileSystemProbes;
+            }
 
             if (!fullpath.empty())
             {
-                // Using the filename passed in as key.
-                _fullPathCache.emplace(filename, fullpath);
-                return fullpath;
+                break;
             }
+        }
 
+        if (!fullpath.empty())
+        {
+            break;
         }
     }
 
-    // The file wasn't found, return empty string.
-    return "";
+    _pathCacheStats.fileSystemProbes.fetch_add(fileSystemProbes, std::memory_order_relaxed);
+    _pathCacheStats.probesAvoided.fetch_add(probesAvoided, std::memory_order_relaxed);
+
+    if (fullpath.empty())
+    {
+        // The file wasn't found, return empty string.
+        if (_negativeCacheEnabled)
+            _fullPathMissCache.insert(filename);
+        return "";
+    }
+
+    // Using the filename passed in as key.
+    _fullPathCache.emplace(filename, fullpath);
+    if (_fullPathCache.size() >= _fullPathCacheSnapshotSize + _fullPathCacheSnapshotSize / 4 + 16)
+    {
+        _fullPathCacheSnapshotSize = _fullPathCache.size();
+        std::shared_ptr<const std::unordered_map<std::string, std::string>> newSnapshot =
+            std::make_shared<std::unordered_map<std::string, std::string>>(_fullPathCache);
+        std::atomic_store(&_fullPathCacheSnapshot, newSnapshot);
+    }
+    return fullpath;
 }
 
 std::string FileUtils::fullPathForDirectory(const std::string &dir) const
@@ -911,7 +1098,7 @@ void FileUtils::setSearchResolutionsOrder(const std::vector<std::string>& search
 
     bool existDefault = false;
 
-    _fullPathCache.clear();
+    resetFullPathCache();
     _fullPathCacheDir.clear();
     _searchResolutionsOrderArray.clear();
     for(const auto& iter : searchResolutionsOrder)
@@ -950,6 +1137,7 @@ void FileUtils::addSearchResolutionsOrder(const std::string &order,const bool fr
     } else {
         _searchResolutionsOrderArray.push_back(resOrder);
     }
+    _fullPathMissCache.clear();
 }
 
 const std::vector<std::string> FileUtils::getSearchResolutionsOrder() const
@@ -987,7 +1175,7 @@ void FileUtils::setDefaultResourceRootPath(const std::string& path)
     DECLARE_GUARD;
     if (_defaultResRootPath != path)
     {
-        _fullPathCache.clear();
+        resetFullPathCache();
         _fullPathCacheDir.clear();
         _defaultResRootPath = path;
         if (!_defaultResRootPath.empty() && _defaultResRootPath[_defaultResRootPath.length()-1] != '/')
@@ -1006,7 +1194,7 @@ void FileUtils::setSearchPaths(const std::vector<std::string>& searchPaths)
     bool existDefaultRootPath = false;
     _originalSearchPaths = searchPaths;
 
-    _fullPathCache.clear();
+    resetFullPathCache();
     _fullPathCacheDir.clear();
     _searchPathArray.clear();
 
@@ -1058,12 +1246,101 @@ void FileUtils::addSearchPath(const std::string &searchpath,const bool front)
         _originalSearchPaths.push_back(searchpath);
         _searchPathArray.push_back(path);
     }
+    _fullPathMissCache.clear();
+}
+
+bool FileUtils::addSearchArchive(const std::string& archiveFile, const bool front)
+{
+    DECLARE_GUARD;
+    std::string fullPath = fullPathForFilename(archiveFile);
+    if (fullPath.empty())
+    {
+        CCLOG("cocos2d: archive %s not found", archiveFile.c_str());
+        return false;
+    }
+
+    auto archive = FileArchive::open(fullPath);
+    if (!archive)
+        return false;
+
+    // The archive is searched like a directory named as the archive file.
+    const std::string searchPath = fullPath + "/";
+    removeSearchArchive(fullPath);
+    SearchArchive searchArchive;
+    searchArchive.searchPath = searchPath;
+    searchArchive.archive = archive;
+    _searchArchives.push_back(searchArchive);
+
+    addSearchPath(searchPath, front);
+    resetFullPathCache();
+    return true;
+}
+
+void FileUtils::removeSearchArchive(const std::string& archiveFile)
+{
+    DECLARE_GUARD;
+    const std::string searchPath = (isAbsolutePath(archiveFile) ? archiveFile : fullPathForFilename(archiveFile)) + "/";
+    auto iter = std::find_if(_searchArchives.begin(), _searchArchives.end(), [&searchPath](const SearchArchive& searchArchive) {
+        return searchArchive.searchPath == searchPath;
+    });
+    if (iter == _searchArchives.end())
+        return;
+
+    _searchArchives.erase(iter);
+    _searchPathArray.erase(std::remove(_searchPathArray.begin(), _searchPathArray.end(), searchPath), _searchPathArray.end());
+    _originalSearchPaths.erase(std::remove(_originalSearchPaths.begin(), _originalSearchPaths.end(), searchPath), _originalSearchPaths.end());
+    resetFullPathCache();
+}
+
+std::vector<std::string> FileUtils::getSearchArchiveEntries() const
+{
+    DECLARE_GUARD;
+    std::vector<std::string> entries;
+    for (const auto& searchArchive : _searchArchives)
+    {
+        const auto& archive = searchArchive.archive;
+        for (uint32_t i = 0, count = archive->getEntryCount(); i < count; ++i)
+            entries.push_back(archive->getEntryPath(i));
+    }
+    return entries;
+}
+
+std::shared_ptr<FileArchive> FileUtils::findArchiveEntry(const std::string& fullPath, FileArchive::Entry* entry) const
+{
+    DECLARE_GUARD;
+    for (const auto& searchArchive : _searchArchives)
+    {
+        const auto& searchPath = searchArchive.searchPath;
+        if (fullPath.size() > searchPath.size() && fullPath.compare(0, searchPath.size(), searchPath) == 0
+            && searchArchive.archive->findEntry(fullPath.substr(searchPath.size()), entry))
+            return searchArchive.archive;
+    }
+    return nullptr;
+}
+
+FileUtils::Status FileUtils::getContentsFromArchive(const std::string& fullPath, ResizableBuffer* buffer) const
+{
+    FileArchive::Entry entry;
+    auto archive = findArchiveEntry(fullPath, &entry);
+    if (!archive)
+        return Status::NotExists;
+
+    buffer->resize(entry.originalSize);
+    if (entry.originalSize > 0 && !archive->extract(entry, buffer->buffer()))
+        return Status::ReadFailed;
+    return Status::OK;
+}
+
+long FileUtils::getFileSizeFromArchive(const std::string& fullPath) const
+{
+    FileArchive::Entry entry;
+    return findArchiveEntry(fullPath, &entry) ? (long)entry.originalSize : -1;
 }
 
 void FileUtils::setFilenameLookupDictionary(const ValueMap& filenameLookupDict)
 {
     DECLARE_GUARD;
-    _fullPathCache.clear();
+    resetFullPathCache();
     _fullPathCacheDir.clear();
     _filenameLookupDict = filenameLookupDict;
 }
@@ -1107,7 +1384,7 @@ bool FileUtils::isFileExist(const std::string& filename) const
 {
     if (isAbsolutePath(filename))
     {
-        return isFileExistInternal(filename);
+        return findArchiveEntry(filename, nullptr) || isFileExistInternal(filename);
     }
     else
     {
@@ -1425,6 +1702,7 @@ bool FileUtils::renameFile(const std::string &oldfullpath, const std::string &ne
         CCLOGERROR("Fail to rename file %s to %s !Error code is %d", oldfullpath.c_str(), newfullpath.c_str(), errorCode);
         return false;
     }
+    clearNegativeCache();
     return true;
 }
 
@@ -1454,6 +1732,10 @@ long FileUtils::getFileSize(const std::string &filepath) const
             return 0;
     }
 
+    long archiveSize = getFileSizeFromArchive(fullpath);
+    if (archiveSize != -1)
+        return archiveSize;
+
     struct stat info;
     // Get data associated with "crt_stat.c":
     int result = stat(fullpath.c_str(), &info);
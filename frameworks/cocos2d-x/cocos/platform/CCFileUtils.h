@@ -29,10 +29,16 @@ THE SOFTWARE.
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
+#include <atomic>
 #include <type_traits>
 #include <mutex>
+#include <memory>
+#include <algorithm>
+#include <cstring>
 
 #include "platform/CCPlatformMacros.h"
+#include "platform/CCFileArchive.h"
 #include "base/ccTypes.h"
 #include "base/CCValue.h"
 #include "base/CCData.h"
@@ -107,7 +113,17 @@ public:
     explicit ResizableBufferAdapter(BufferType* buffer) : _buffer(buffer) {}
     virtual void resize(size_t size) override {
         size_t oldSize = static_cast<size_t>(_buffer->getSize());
-        if (oldSize != size) {
+        if (_buffer->isView()) {
+            // a view can't be reallocated, copy what fits into a buffer of our own
+            auto buffer = (unsigned char*)malloc(size);
+            if (buffer) {
+                if (oldSize > 0)
+                    memcpy(buffer, _buffer->getBytes(), std::min(oldSize, size));
+                _buffer->clear();
+                _buffer->fastSet(buffer, size);
+            }
+        }
+        else if (oldSize != size) {
             auto old = _buffer->getBytes();
             void* buffer = realloc(old, size);
             if (buffer)
@@ -160,6 +176,53 @@ public:
      */
     virtual void purgeCachedEntries();
 
+    /**
+     *  Enables or disables caching of the filenames which can't be found in the search paths.
+     *  Looking up a missing file again then doesn't probe every search path and resolution directory.
+     *  The cache is cleared when search paths or resolutions change and when FileUtils writes or renames a file,
+     *  call purgeCachedEntries() after creating files by other means, e.g. a downloader.
+     *  @param enabled Disabled by default.
+     */
+    void setNegativeCacheEnabled(bool enabled);
+
+    /** Gets whether the filenames which can't be found in the search paths are cached. */
+    bool isNegativeCacheEnabled() const { return _negativeCacheEnabled; }
+
+    /**
+     *  Loads a manifest listing the files under the default resource root path,
+     *  generated at build time by `cmake/scripts/generate_path_manifest.py`.
+     *  Search paths under the default resource root are then resolved against the manifest
+     *  instead of the file system, other search paths (e.g. the writable path) are still probed.
+     *
+     *  The manifest is a text file holding one path relative to the default resource root per line,
+     *  with '/' as separator. Empty lines and lines starting with '#' are ignored.
+     *  @param filename The manifest file.
+     *  @return Whether the manifest could be read.
+     */
+    bool loadPathManifest(const std::string& filename);
+
+    /** Forgets the manifest loaded by loadPathManifest, the file system is probed again. */
+    void unloadPathManifest();
+
+    /**
+     *  Counters of fullPathForFilename, they are never reset implicitly.
+     *  Sample them twice to get rates, e.g. probes avoided per second.
+     */
+    struct PathCacheStats
+    {
+        uint64_t lookups = 0;           ///< Relative filenames resolved.
+        uint64_t cacheHits = 0;         ///< Lookups served by the full path cache.
+        uint64_t negativeCacheHits = 0; ///< Lookups of missing files served by the negative cache.
+        uint64_t fileSystemProbes = 0;  ///< Candidate paths checked on the file system.
+        uint64_t probesAvoided = 0;     ///< Candidate paths not checked on the file system thanks to the caches, the manifest and the archives.
+    };
+
+    /** Gets the counters of fullPathForFilename. */
+    PathCacheStats getPathCacheStats() const;
+
+    /** Resets the counters of fullPathForFilename. */
+    void resetPathCacheStats();
+
     /**
      *  Gets string from a file.
      */
@@ -190,6 +253,15 @@ public:
      */
     void getDataFromFile(const std::string& filename, std::function<void(Data)> callback) const;
 
+    /**
+     *  Creates binary data from a file, without copying it if possible.
+     *  Uncompressed entries of the archives added by `addSearchArchive` are returned as views
+     *  of the mapped archive, see `Data::setView`. Other files are read like `getDataFromFile`.
+     *  @note The bytes of a view are read-only, so files are always copied if a file data decoder is set.
+     *  @return A data object.
+     */
+    Data getDataViewFromFile(const std::string& filename) const;
+
     enum class Status
     {
         OK = 0,
@@ -448,6 +520,30 @@ public:
       */
     void addSearchPath(const std::string & path, const bool front=false);
 
+    /**
+     * Adds a packed archive built by `cmake/scripts/pack_archive.py` as a search path.
+     * The archive is memory mapped and searched like a directory named as the archive file,
+     * so the full path of an entry is "<full path of the archive>/<path of the entry>".
+     * Entries are read by getContents, getDataFromFile, getStringFromFile and getDataViewFromFile,
+     * code opening full paths with the file system can't read them.
+     *
+     * @param archiveFile The archive, relative to the search paths or absolute.
+     * @param front Whether the archive is searched before the other search paths.
+     * @return Whether the archive could be opened.
+     */
+    bool addSearchArchive(const std::string& archiveFile, const bool front=false);
+
+    /**
+     * Removes an archive added by `addSearchArchive` and its search path.
+     */
+    void removeSearchArchive(const std::string& archiveFile);
+
+    /**
+     * Gets the paths of the entries of the archives added by `addSearchArchive`,
+     * relative to the search path of their archive.
+     */
+    std::vector<std::string> getSearchArchiveEntries() const;
+
     /**
      *  Gets the array of search paths.
      *
@@ -835,6 +931,11 @@ public:
      */
     void setFileDataDecoder(FiledataDecoder decoder);
 
+    /**
+     *  Get the decoder callback set by setFileDataDecoder, nullptr if there is none.
+     */
+    FiledataDecoder getFileDataDecoder() const { return dataDecoder; }
+
 protected:
     /**
      *  The default constructor.
@@ -897,6 +998,25 @@ protected:
      */
     virtual std::string fullPathForDirectory(const std::string &dirname) const;
 
+    /**
+     * Finds the archive entry of a full path.
+     * @param fullPath The full path of the entry, as returned by fullPathForFilename.
+     * @param entry Filled with the entry if it is found, may be nullptr.
+     * @return The archive containing the entry, nullptr if no added archive contains it.
+     */
+    std::shared_ptr<FileArchive> findArchiveEntry(const std::string& fullPath, FileArchive::Entry* entry) const;
+
+    /**
+     * Reads an archive entry, platforms overriding getContents should try it first.
+     * @return Status::NotExists if no added archive contains the full path.
+     */
+    Status getContentsFromArchive(const std::string& fullPath, ResizableBuffer* buffer) const;
+
+    /**
+     * Gets the size of an archive entry, -1 if no added archive contains the full path.
+     */
+    long getFileSizeFromArchive(const std::string& fullPath) const;
+
     /**
     * mutex used to protect fields. 
     */
@@ -950,6 +1070,55 @@ protected:
      */
     mutable std::unordered_map<std::string, std::string> _fullPathCacheDir;
 
+    /**
+     * The archives added by addSearchArchive, with their search paths.
+     */
+    struct SearchArchive
+    {
+        std::string searchPath;
+        std::shared_ptr<FileArchive> archive;
+    };
+    std::vector<SearchArchive> _searchArchives;
+
+    /**
+     * Clears the full path cache of files, the negative cache and the published copy of the cache.
+     */
+    void resetFullPathCache() const;
+
+    /**
+     * Forgets the missing filenames, called when a file is created.
+     */
+    void clearNegativeCache() const;
+
+    /**
+     * Copy of _fullPathCache read by fullPathForFilename without locking _mutex.
+     * Republished each time the cache grows by a quarter, so copies cost O(1) per cached path.
+     */
+    mutable std::shared_ptr<const std::unordered_map<std::string, std::string>> _fullPathCacheSnapshot;
+    mutable size_t _fullPathCacheSnapshotSize = 0;
+
+    /**
+     * Filenames which were not found in the search paths.
+     */
+    mutable std::unordered_set<std::string> _fullPathMissCache;
+    bool _negativeCacheEnabled = false;
+
+    /**
+     * Files under the default resource root, loaded by loadPathManifest.
+     */
+    std::unordered_set<std::string> _pathManifest;
+    bool _pathManifestLoaded = false;
+
+    struct AtomicPathCacheStats
+    {
+        std::atomic<uint64_t> lookups{0};
+        std::atomic<uint64_t> cacheHits{0};
+        std::atomic<uint64_t> negativeCacheHits{0};
+        std::atomic<uint64_t> fileSystemProbes{0};
+        std::atomic<uint64_t> probesAvoided{0};
+    };
+    mutable AtomicPathCacheStats _pathCacheStats;
+
     /**
      * Writable path.
      */
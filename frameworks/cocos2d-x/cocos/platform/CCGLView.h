@@ -127,6 +127,13 @@ public:
     /** Exchanges the front and back buffers, subclass must implement this method. */
     virtual void swapBuffers() = 0;
 
+    /** Make the OpenGL context current on the calling thread or release it, used to hand the context over to the render thread.
+     *
+     * @param current Make the context current with true, release it with false.
+     * @return False if the view can't hand over its context, which is the default.
+     */
+    virtual bool makeContextCurrent(bool /*current*/) { return false; }
+
     /** Open or close IME keyboard , subclass must implement this method. 
      *
      * @param open Open or close IME keyboard.
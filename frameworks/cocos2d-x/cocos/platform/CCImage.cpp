@@ -508,7 +508,7 @@ bool Image::initWithImageFile(const std::string& path)
     bool ret = false;
     _filePath = FileUtils::getInstance()->fullPathForFilename(path);
 
-    Data data = FileUtils::getInstance()->getDataFromFile(_filePath);
+    Data data = FileUtils::getInstance()->getDataViewFromFile(_filePath);
 
     if (!data.isNull())
     {
@@ -523,7 +523,7 @@ bool Image::initWithImageFileThreadSafe(const std::string& fullpath)
     bool ret = false;
     _filePath = fullpath;
 
-    Data data = FileUtils::getInstance()->getDataFromFile(fullpath);
+    Data data = FileUtils::getInstance()->getDataViewFromFile(fullpath);
 
     if (!data.isNull())
     {
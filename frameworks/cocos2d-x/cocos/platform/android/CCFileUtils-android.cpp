@@ -347,6 +347,12 @@ FileUtils::Status FileUtilsAndroid::getContents(const std::string& filename, Res
         return FileUtils::Status::NotExists;
 
     string fullPath = fullPathForFilename(filename);
+    if (fullPath.empty())
+        return FileUtils::Status::NotExists;
+
+    FileUtils::Status archiveStatus = getContentsFromArchive(fullPath, buffer);
+    if (archiveStatus != FileUtils::Status::NotExists)
+        return archiveStatus;
 
     if (fullPath[0] == '/')
         return FileUtils::getContents(fullPath, buffer);
@@ -44,6 +44,9 @@ THE SOFTWARE.
 #endif /* CC_ICON_SET_SUPPORT */
 
 #include "renderer/CCRenderer.h"
+#ifndef CC_USE_METAL
+#include "renderer/backend/opengl/RenderThreadGL.h"
+#endif
 
 NS_CC_BEGIN
 
@@ -431,8 +434,27 @@ void GLViewImpl::end()
 
 void GLViewImpl::swapBuffers()
 {
-    if(_mainWindow)
-        glfwSwapBuffers(_mainWindow);
+    if(!_mainWindow)
+        return;
+
+#ifndef CC_USE_METAL
+    // Presented by the render thread after the frame's commands when rendering is pipelined.
+    GLFWwindow* window = _mainWindow;
+    backend::RenderThreadGL::run(nullptr, [window]() {
+        glfwSwapBuffers(window);
+    });
+#else
+    glfwSwapBuffers(_mainWindow);
+#endif
+}
+
+bool GLViewImpl::makeContextCurrent(bool current)
+{
+    if(!_mainWindow)
+        return false;
+
+    glfwMakeContextCurrent(current ? _mainWindow : nullptr);
+    return true;
 }
 
 bool GLViewImpl::windowShouldClose()
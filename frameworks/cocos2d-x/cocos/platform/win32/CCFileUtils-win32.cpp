@@ -190,6 +190,10 @@ FileUtils::Status FileUtilsWin32::getContents(const std::string& filename, Resiz
     // read the file from hardware
     std::string fullPath = FileUtils::getInstance()->fullPathForFilename(filename);
 
+    FileUtils::Status archiveStatus = getContentsFromArchive(fullPath, buffer);
+    if (archiveStatus != FileUtils::Status::NotExists)
+        return archiveStatus;
+
     HANDLE fileHandle = ::CreateFile(StringUtf8ToWideChar(fullPath).c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, NULL, nullptr);
     if (fileHandle == INVALID_HANDLE_VALUE)
         return FileUtils::Status::OpenFailed;
@@ -286,6 +290,10 @@ void FileUtilsWin32::listFilesRecursively(const std::string& dirPath, std::vecto
 
 long FileUtilsWin32::getFileSize(const std::string &filepath) const
 {
+    long archiveSize = getFileSizeFromArchive(filepath);
+    if (archiveSize != -1)
+        return archiveSize;
+
     struct _stat tmp;
     if (_stat(filepath.c_str(), &tmp) == 0)
     {
@@ -405,6 +413,7 @@ bool FileUtilsWin32::renameFile(const std::string &oldfullpath, const std::strin
 
     if (MoveFile(_wOld.c_str(), _wNew.c_str()))
     {
+        clearNegativeCache();
         return true;
     }
     else
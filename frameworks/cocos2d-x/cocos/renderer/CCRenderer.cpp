@@ -25,6 +25,12 @@
 #include "renderer/CCRenderer.h"
 
 #include <algorithm>
+#include <cfloat>
+#include <cstring>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
 
 #include "renderer/CCTrianglesCommand.h"
 #include "renderer/CCCustomCommand.h"
@@ -42,10 +48,15 @@
 #include "base/CCEventListenerCustom.h"
 #include "base/CCEventType.h"
 #include "2d/CCCamera.h"
+#include "platform/CCGLView.h"
 #include "2d/CCScene.h"
+#include "math/MathUtil.h"
 #include "xxhash.h"
 
 #include "renderer/backend/Backend.h"
+#ifndef CC_USE_METAL
+#include "renderer/backend/opengl/RenderThreadGL.h"
+#endif
 
 NS_CC_BEGIN
 
@@ -111,8 +122,162 @@ void RenderQueue::sort()
 {
     // Don't sort _queue0, it already comes sorted
     std::stable_sort(std::begin(_commands[QUEUE_GROUP::TRANSPARENT_3D]), std::end(_commands[QUEUE_GROUP::TRANSPARENT_3D]), compare3DCommand);
-    std::stable_sort(std::begin(_commands[QUEUE_GROUP::GLOBALZ_NEG]), std::end(_commands[QUEUE_GROUP::GLOBALZ_NEG]), compareRenderCommand);
-    std::stable_sort(std::begin(_commands[QUEUE_GROUP::GLOBALZ_POS]), std::end(_commands[QUEUE_GROUP::GLOBALZ_POS]), compareRenderCommand);
+    sortByGlobalOrder(_commands[QUEUE_GROUP::GLOBALZ_NEG]);
+    sortByGlobalOrder(_commands[QUEUE_GROUP::GLOBALZ_POS]);
+}
+
+// Map the bits of a float to an unsigned integer with the same order.
+static uint32_t globalOrderSortKey(float z)
+{
+    uint32_t bits;
+    memcpy(&bits, &z, sizeof(bits));
+    return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+}
+
+void RenderQueue::sortByGlobalOrder(std::vector<RenderCommand*>& commands)
+{
+    // Nodes are mostly visited in order, so commands often come sorted.
+    if (std::is_sorted(commands.begin(), commands.end(), compareRenderCommand))
+        return;
+
+    // Insertion sort of std::stable_sort is faster for few commands.
+    const size_t count = commands.size();
+    if (count < 64)
+    {
+        std::stable_sort(commands.begin(), commands.end(), compareRenderCommand);
+        return;
+    }
+
+    // LSD radix sort on the float bits, stable.
+    _sortKeys.resize(count);
+    _sortedKeys.resize(count);
+    _sortedCommands.resize(count);
+    uint32_t allOr = 0;
+    uint32_t allAnd = 0xffffffffu;
+    for (size_t i = 0; i < count; ++i)
+    {
+        uint32_t key = globalOrderSortKey(commands[i]->getGlobalOrder());
+        _sortKeys[i] = key;
+        allOr |= key;
+        allAnd &= key;
+    }
+
+    // Commands share a handful of Z values, typically integers, so most bytes are the same in every key and their passes are skipped.
+    const uint32_t varyingBits = allOr ^ allAnd;
+    for (int shift = 0; shift < 32; shift += 8)
+    {
+        if (((varyingBits >> shift) & 0xff) == 0)
+            continue;
+
+        size_t offsets[256] = {0};
+        for (size_t i = 0; i < count; ++i)
+            ++offsets[(_sortKeys[i] >> shift) & 0xff];
+
+        size_t offset = 0;
+        for (auto& bucket : offsets)
+        {
+            size_t bucketSize = bucket;
+            bucket = offset;
+            offset += bucketSize;
+        }
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            size_t index = offsets[(_sortKeys[i] >> shift) & 0xff]++;
+            _sortedKeys[index] = _sortKeys[i];
+            _sortedCommands[index] = commands[i];
+        }
+        _sortKeys.swap(_sortedKeys);
+        commands.swap(_sortedCommands);
+    }
+}
+
+void RenderQueue::reorderTrianglesByMaterial(int lookback)
+{
+    reorderTrianglesByMaterial(_commands[QUEUE_GROUP::GLOBALZ_NEG], lookback);
+    reorderTrianglesByMaterial(_commands[QUEUE_GROUP::GLOBALZ_ZERO], lookback);
+    reorderTrianglesByMaterial(_commands[QUEUE_GROUP::GLOBALZ_POS], lookback);
+}
+
+static bool computeTrianglesBounds(const TrianglesCommand* cmd, float& minX, float& minY, float& maxX, float& maxY)
+{
+    const auto vertexCount = cmd->getVertexCount();
+    if (vertexCount == 0)
+        return false;
+
+    const float* m = cmd->getModelView().m;
+    const auto verts = cmd->getVertices();
+    minX = minY = FLT_MAX;
+    maxX = maxY = -FLT_MAX;
+    for (size_t i = 0; i < vertexCount; ++i)
+    {
+        const auto& v = verts[i].vertices;
+        // Only flat 2D commands are reordered, bounds in world space don't match screen space otherwise.
+        const float z = v.x * m[2] + v.y * m[6] + v.z * m[10] + m[14];
+        if (z != 0.f)
+            return false;
+
+        const float x = v.x * m[0] + v.y * m[4] + v.z * m[8] + m[12];
+        const float y = v.x * m[1] + v.y * m[5] + v.z * m[9] + m[13];
+        minX = std::min(minX, x);
+        maxX = std::max(maxX, x);
+        minY = std::min(minY, y);
+        maxY = std::max(maxY, y);
+    }
+    return true;
+}
+
+void RenderQueue::reorderTrianglesByMaterial(std::vector<RenderCommand*>& commands, int lookback)
+{
+    _reorderedCommands.clear();
+    _reorderedBounds.clear();
+    _reorderedCommands.reserve(commands.size());
+
+    // Start index of the commands that can be passed by the current one: commands before it have
+    // a different global Z order or are barriers like custom, callback or group commands.
+    size_t runStart = 0;
+    for (auto command : commands)
+    {
+        TrianglesBounds bounds;
+        bool reorderable = command->getType() == RenderCommand::Type::TRIANGLES_COMMAND && !command->is3D() &&
+            computeTrianglesBounds(static_cast<TrianglesCommand*>(command), bounds.minX, bounds.minY, bounds.maxX, bounds.maxY);
+
+        size_t position = _reorderedCommands.size();
+        if (!reorderable)
+        {
+            runStart = position + 1;
+        }
+        else
+        {
+            if (runStart < position && _reorderedCommands[position - 1]->getGlobalOrder() != command->getGlobalOrder())
+                runStart = position;
+
+            auto cmd = static_cast<TrianglesCommand*>(command);
+            if (!cmd->isSkipBatching())
+            {
+                const size_t searchEnd = position - std::min(position - runStart, (size_t)lookback);
+                for (size_t i = position; i > searchEnd; --i)
+                {
+                    auto other = static_cast<TrianglesCommand*>(_reorderedCommands[i - 1]);
+                    if (!other->isSkipBatching() && other->getMaterialID() == cmd->getMaterialID())
+                    {
+                        position = i;
+                        break;
+                    }
+
+                    const auto& otherBounds = _reorderedBounds[i - 1];
+                    if (bounds.minX < otherBounds.maxX && otherBounds.minX < bounds.maxX &&
+                        bounds.minY < otherBounds.maxY && otherBounds.minY < bounds.maxY)
+                        break;
+                }
+            }
+        }
+
+        _reorderedCommands.insert(_reorderedCommands.begin() + position, command);
+        _reorderedBounds.insert(_reorderedBounds.begin() + position, bounds);
+    }
+
+    commands.swap(_reorderedCommands);
 }
 
 RenderCommand* RenderQueue::operator[](ssize_t index) const
@@ -153,6 +318,80 @@ void RenderQueue::realloc(size_t reserveSize)
 //
 static const int DEFAULT_RENDER_QUEUE = 0;
 
+// Workers of the parallel triangle fill, job 0 is always run by the render thread.
+class Renderer::TriangleFillWorkers
+{
+public:
+    explicit TriangleFillWorkers(unsigned int workerCount)
+    {
+        for (unsigned int i = 0; i < workerCount; ++i)
+            _threads.emplace_back(&TriangleFillWorkers::threadLoop, this);
+    }
+
+    ~TriangleFillWorkers()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+        }
+        _jobCondition.notify_all();
+        for (auto& thread : _threads)
+            thread.join();
+    }
+
+    size_t getWorkerCount() const { return _threads.size(); }
+
+    // Runs job(0) ... job(jobCount - 1) and returns when all of them are finished.
+    void run(size_t jobCount, const std::function<void(size_t)>& job)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _job = &job;
+            _jobCount = jobCount;
+            _nextJob = 1;
+            _pendingJobs = jobCount - 1;
+        }
+        _jobCondition.notify_all();
+
+        job(0);
+
+        std::unique_lock<std::mutex> lock(_mutex);
+        _doneCondition.wait(lock, [this]{ return _pendingJobs == 0; });
+        _job = nullptr;
+    }
+
+private:
+    void threadLoop()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        for (;;)
+        {
+            _jobCondition.wait(lock, [this]{ return _stop || _nextJob < _jobCount; });
+            if (_stop)
+                return;
+
+            size_t index = _nextJob++;
+            auto job = _job;
+            lock.unlock();
+            (*job)(index);
+            lock.lock();
+
+            if (--_pendingJobs == 0)
+                _doneCondition.notify_one();
+        }
+    }
+
+    std::vector<std::thread> _threads;
+    std::mutex _mutex;
+    std::condition_variable _jobCondition;
+    std::condition_variable _doneCondition;
+    const std::function<void(size_t)>* _job = nullptr;
+    size_t _jobCount = 0;
+    size_t _nextJob = 0;
+    size_t _pendingJobs = 0;
+    bool _stop = false;
+};
+
 //
 // constructors, destructor, init
 //
@@ -168,14 +407,20 @@ Renderer::Renderer()
 
     // for the batched TriangleCommand
     _triBatchesToDraw = (TriBatchToDraw*) malloc(sizeof(_triBatchesToDraw[0]) * _triBatchesToDrawCapacity);
+    setTriangleBatchCapacity(VBO_SIZE, INDEX_VBO_SIZE);
 }
 
 Renderer::~Renderer()
 {
+    setPipelinedRenderingEnabled(false);
+    releaseMultiTextureBatching();
     _renderGroups.clear();
     _groupCommandManager->release();
     
     free(_triBatchesToDraw);
+    free(_verts);
+    free(_indices);
+    CC_SAFE_DELETE(_triangleFillWorkers);
     
     CC_SAFE_RELEASE(_commandBuffer);
     CC_SAFE_RELEASE(_renderPipeline);
@@ -184,7 +429,7 @@ Renderer::~Renderer()
 void Renderer::init()
 {
     // Should invoke _triangleCommandBufferManager.init() first.
-    _triangleCommandBufferManager.init();
+    _triangleCommandBufferManager.init(_triangleVertexCapacity * sizeof(_verts[0]), _triangleIndexCapacity * _triangleIndexSize);
     _vertexBuffer = _triangleCommandBufferManager.getVertexBuffer();
     _indexBuffer = _triangleCommandBufferManager.getIndexBuffer();
 
@@ -194,6 +439,59 @@ void Renderer::init()
     _commandBuffer->setRenderPipeline(_renderPipeline);
 }
 
+void Renderer::setTrianglesReorderEnabled(bool enabled, int lookback)
+{
+    _trianglesReorderEnabled = enabled;
+    _trianglesReorderLookback = lookback;
+}
+
+void Renderer::setTriangleBatchCapacity(unsigned int vertexCapacity, unsigned int indexCapacity)
+{
+    CCASSERT(!_isRendering, "Cannot change batch capacity while rendering");
+    CCASSERT(_queuedTriangleCommands.empty(), "Cannot change batch capacity with queued triangles");
+    CCASSERT(vertexCapacity > 0 && indexCapacity > 0, "Invalid batch capacity");
+
+    if (vertexCapacity > 65536 && !Configuration::getInstance()->supportsElementIndexUint())
+    {
+        CCLOG("Renderer: 32-bit indices are not supported, the batch capacity is limited to 65536 vertices");
+        vertexCapacity = 65536;
+    }
+    auto indexFormat = vertexCapacity > 65536 ? backend::IndexFormat::U_INT : backend::IndexFormat::U_SHORT;
+    auto indexSize = backend::IndexFormat::U_INT == indexFormat ? sizeof(unsigned int) : sizeof(unsigned short);
+
+    auto verts = (V3F_C4B_T2F*) malloc(sizeof(_verts[0]) * vertexCapacity);
+    auto indices = malloc(indexSize * indexCapacity);
+    if (!verts || !indices)
+    {
+        CCLOG("Renderer: failed to allocate a triangle batch of %u vertices and %u indices", vertexCapacity, indexCapacity);
+        free(verts);
+        free(indices);
+        return;
+    }
+
+    free(_verts);
+    free(_indices);
+    _verts = verts;
+    _indices = indices;
+    _triangleVertexCapacity = vertexCapacity;
+    _triangleIndexCapacity = indexCapacity;
+    _triangleIndexFormat = indexFormat;
+    _triangleIndexSize = indexSize;
+
+    // Recreate the buffers if they were created already.
+    if (_vertexBuffer)
+    {
+        _triangleCommandBufferManager.init(_triangleVertexCapacity * sizeof(_verts[0]), _triangleIndexCapacity * _triangleIndexSize);
+        _vertexBuffer = _triangleCommandBufferManager.getVertexBuffer();
+        _indexBuffer = _triangleCommandBufferManager.getIndexBuffer();
+        _queuedTotalIndexCount = _queuedTotalVertexCount = 0;
+        _queuedIndexCount = _queuedVertexCount = 0;
+    }
+
+    if (_multiTextureBatchingEnabled && !allocateMultiTextureVertices())
+        releaseMultiTextureBatching();
+}
+
 void Renderer::addCommand(RenderCommand* command)
 {
     int renderQueueID =_commandGroupStack.top();
@@ -256,27 +554,23 @@ void Renderer::processRenderCommand(RenderCommand* command)
             auto cmd = static_cast<TrianglesCommand*>(command);
             
             // flush own queue when buffer is full
-            if(_queuedTotalVertexCount + cmd->getVertexCount() > VBO_SIZE || _queuedTotalIndexCount + cmd->getIndexCount() > INDEX_VBO_SIZE)
+            if(_queuedTotalVertexCount + cmd->getVertexCount() > _triangleVertexCapacity || _queuedTotalIndexCount + cmd->getIndexCount() > _triangleIndexCapacity)
             {
-                CCASSERT(cmd->getVertexCount()>= 0 && cmd->getVertexCount() < VBO_SIZE, "VBO for vertex is not big enough, please break the data down or use customized render command");
-                CCASSERT(cmd->getIndexCount()>= 0 && cmd->getIndexCount() < INDEX_VBO_SIZE, "VBO for index is not big enough, please break the data down or use customized render command");
+                CCASSERT(cmd->getVertexCount()>= 0 && cmd->getVertexCount() <= _triangleVertexCapacity, "VBO for vertex is not big enough, please break the data down, use customized render command or increase Renderer::setTriangleBatchCapacity");
+                CCASSERT(cmd->getIndexCount()>= 0 && cmd->getIndexCount() <= _triangleIndexCapacity, "VBO for index is not big enough, please break the data down, use customized render command or increase Renderer::setTriangleBatchCapacity");
                 drawBatchedTriangles();
 
                 _queuedTotalIndexCount = _queuedTotalVertexCount = 0;
-#ifdef CC_USE_METAL
                 _queuedIndexCount = _queuedVertexCount = 0;
                 _triangleCommandBufferManager.prepareNextBuffer();
                 _vertexBuffer = _triangleCommandBufferManager.getVertexBuffer();
                 _indexBuffer = _triangleCommandBufferManager.getIndexBuffer();
-#endif
             }
             
             // queue it
             _queuedTriangleCommands.push_back(cmd);
-#ifdef CC_USE_METAL
             _queuedIndexCount += cmd->getIndexCount();
             _queuedVertexCount += cmd->getVertexCount();
-#endif
             _queuedTotalVertexCount += cmd->getVertexCount();
             _queuedTotalIndexCount += cmd->getIndexCount();
 
@@ -367,6 +661,8 @@ void Renderer::render()
         for (auto &renderqueue : _renderGroups)
         {
             renderqueue.sort();
+            if (_trianglesReorderEnabled)
+                renderqueue.reorderTrianglesByMaterial(_trianglesReorderLookback);
         }
         visitRenderQueue(_renderGroups[0]);
     }
@@ -382,12 +678,13 @@ void Renderer::beginFrame()
 void Renderer::endFrame()
 {
     _commandBuffer->endFrame();
+#ifndef CC_USE_METAL
+    backend::RenderThreadGL::commitFrame();
+#endif
 
-#ifdef CC_USE_METAL
-    _triangleCommandBufferManager.putbackAllBuffers();
+    _triangleCommandBufferManager.putbackAllBuffers(_commandBuffer->getFrameIndex());
     _vertexBuffer = _triangleCommandBufferManager.getVertexBuffer();
     _indexBuffer = _triangleCommandBufferManager.getIndexBuffer();
-#endif
     _queuedTotalIndexCount = 0;
     _queuedTotalVertexCount = 0;
 }
@@ -525,28 +822,320 @@ void Renderer::setViewPort(int x, int y, unsigned int w, unsigned int h)
     _viewport.h = h;
 }
 
+void Renderer::setParallelFillThreshold(unsigned int vertexThreshold, unsigned int workerCount)
+{
+    if (workerCount == 0)
+    {
+        unsigned int hardwareThreads = std::thread::hardware_concurrency();
+        workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+    }
+    if (vertexThreshold == 0)
+        workerCount = 0;
+
+    if (!_triangleFillWorkers || _triangleFillWorkers->getWorkerCount() != workerCount)
+    {
+        CC_SAFE_DELETE(_triangleFillWorkers);
+        if (workerCount > 0)
+            _triangleFillWorkers = new (std::nothrow) TriangleFillWorkers(workerCount);
+    }
+
+    _parallelFillThreshold = _triangleFillWorkers ? vertexThreshold : 0;
+}
+
+bool Renderer::setPipelinedRenderingEnabled(bool enabled)
+{
+    CCASSERT(!_isRendering, "Cannot change pipelined rendering while rendering");
+#ifndef CC_USE_METAL
+    if (enabled == backend::RenderThreadGL::isRunning())
+        return enabled;
+
+    if (!enabled)
+    {
+        backend::RenderThreadGL::stop();
+        return false;
+    }
+
+    auto glView = Director::getInstance()->getOpenGLView();
+    if (!glView || !glView->makeContextCurrent(true))
+    {
+        CCLOG("Renderer: pipelined rendering is not supported by the view");
+        return false;
+    }
+
+    backend::RenderThreadGL::start([glView](bool current) {
+        glView->makeContextCurrent(current);
+    });
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool Renderer::isPipelinedRenderingEnabled() const
+{
+#ifndef CC_USE_METAL
+    return backend::RenderThreadGL::isRunning();
+#else
+    return false;
+#endif
+}
+
+bool Renderer::setMultiTextureBatchingEnabled(bool enabled)
+{
+    CCASSERT(!_isRendering, "Cannot change multi-texture batching while rendering");
+#ifndef CC_USE_METAL
+    if (enabled == _multiTextureBatchingEnabled)
+        return enabled;
+
+    if (!enabled)
+    {
+        releaseMultiTextureBatching();
+        return false;
+    }
+
+    auto program = backend::Program::getBuiltinProgram(backend::ProgramType::POSITION_TEXTURE_COLOR_MULTI);
+    if (!program)
+    {
+        CCLOG("Renderer: multi-texture batching is not supported");
+        return false;
+    }
+    _multiTextureProgramState = new (std::nothrow) backend::ProgramState(program);
+    if (!_multiTextureProgramState)
+        return false;
+
+    // same layout as Sprite::setVertexLayout() followed by the texture slot
+    auto vertexLayout = _multiTextureProgramState->getVertexLayout();
+    vertexLayout->setAttribute(backend::ATTRIBUTE_NAME_POSITION,
+                               _multiTextureProgramState->getAttributeLocation(backend::Attribute::POSITION),
+                               backend::VertexFormat::FLOAT3,
+                               offsetof(MultiTextureVertex, vertex) + offsetof(V3F_C4B_T2F, vertices),
+                               false);
+    vertexLayout->setAttribute(backend::ATTRIBUTE_NAME_TEXCOORD,
+                               _multiTextureProgramState->getAttributeLocation(backend::Attribute::TEXCOORD),
+                               backend::VertexFormat::FLOAT2,
+                               offsetof(MultiTextureVertex, vertex) + offsetof(V3F_C4B_T2F, texCoords),
+                               false);
+    vertexLayout->setAttribute(backend::ATTRIBUTE_NAME_COLOR,
+                               _multiTextureProgramState->getAttributeLocation(backend::Attribute::COLOR),
+                               backend::VertexFormat::UBYTE4,
+                               offsetof(MultiTextureVertex, vertex) + offsetof(V3F_C4B_T2F, colors),
+                               true);
+    vertexLayout->setAttribute("a_textureSlot",
+                               _multiTextureProgramState->getAttributeLocation("a_textureSlot"),
+                               backend::VertexFormat::FLOAT,
+                               offsetof(MultiTextureVertex, textureSlot),
+                               false);
+    vertexLayout->setLayout(sizeof(MultiTextureVertex));
+
+    _multiTextureMVPLocation = _multiTextureProgramState->getUniformLocation(backend::Uniform::MVP_MATRIX);
+    _multiTextureSamplersLocation = _multiTextureProgramState->getUniformLocation("u_textures");
+
+    _multiTextureSlots.resize(MULTI_TEXTURE_SLOTS);
+    for (int i = 0; i < MULTI_TEXTURE_SLOTS; ++i)
+        _multiTextureSlots[i] = i;
+
+    if (!allocateMultiTextureVertices())
+    {
+        releaseMultiTextureBatching();
+        return false;
+    }
+
+    _multiTextureBatchingEnabled = true;
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool Renderer::allocateMultiTextureVertices()
+{
+    const std::size_t size = _triangleVertexCapacity * sizeof(MultiTextureVertex);
+    auto verts = (MultiTextureVertex*) malloc(size);
+    if (!verts)
+        return false;
+
+    free(_multiTextureVerts);
+    _multiTextureVerts = verts;
+    // the buffers are written at the same offsets as the triangle vertex buffers, so the index buffers can be shared
+    _triangleCommandBufferManager.setMultiTextureVertexBufferSize(size);
+    return true;
+}
+
+void Renderer::releaseMultiTextureBatching()
+{
+    free(_multiTextureVerts);
+    _multiTextureVerts = nullptr;
+    _triangleCommandBufferManager.setMultiTextureVertexBufferSize(0);
+    CC_SAFE_RELEASE_NULL(_multiTextureProgramState);
+    _multiTextureBatchingEnabled = false;
+}
+
+int Renderer::startMultiTextureBatch(TriBatchToDraw& batch, const TrianglesCommand* cmd)
+{
+    batch.multiTextureMaterialID = 0;
+    batch.firstTexture = (unsigned int)_triBatchTextures.size();
+    batch.textureCount = 0;
+    if (!_multiTextureBatchingEnabled || !cmd || cmd->getMultiTextureMaterialID() == 0 || !cmd->getTexture())
+        return -1;
+
+    batch.multiTextureMaterialID = cmd->getMultiTextureMaterialID();
+    batch.textureCount = 1;
+    _triBatchTextures.push_back(cmd->getTexture());
+    return 0;
+}
+
+int Renderer::joinMultiTextureBatch(TriBatchToDraw& batch, const TrianglesCommand* cmd)
+{
+    if (batch.multiTextureMaterialID == 0 || batch.multiTextureMaterialID != cmd->getMultiTextureMaterialID() || !cmd->getTexture())
+        return -1;
+
+    for (unsigned int i = 0; i < batch.textureCount; ++i)
+    {
+        if (_triBatchTextures[batch.firstTexture + i] == cmd->getTexture())
+            return (int)i;
+    }
+
+    if (batch.textureCount >= MULTI_TEXTURE_SLOTS)
+        return -1;
+    _triBatchTextures.push_back(cmd->getTexture());
+    return (int)batch.textureCount++;
+}
+
+void Renderer::fillMultiTextureVertices(unsigned int vertexBufferOffset)
+{
+    auto vertexBuffer = _triangleCommandBufferManager.getMultiTextureVertexBuffer();
+    if (!vertexBuffer)
+        return;
+
+    // Only batches using several textures are drawn with the multi-texture vertices.
+    unsigned int firstVertex = _triangleVertexCapacity;
+    unsigned int lastVertex = 0;
+    unsigned int filledVertex = vertexBufferOffset;
+    for (size_t i = 0, count = _queuedTriangleCommands.size(); i < count; ++i)
+    {
+        const auto vertexCount = (unsigned int)_queuedTriangleCommands[i]->getVertexCount();
+        const auto& textureSlot = _queuedTextureSlots[i];
+        if (textureSlot.slot >= 0 && _triBatchesToDraw[textureSlot.batch].textureCount > 1)
+        {
+            const float slot = (float)textureSlot.slot;
+            const auto src = &_verts[filledVertex - vertexBufferOffset];
+            auto dst = &_multiTextureVerts[filledVertex];
+            for (unsigned int v = 0; v < vertexCount; ++v)
+            {
+                dst[v].vertex = src[v];
+                dst[v].textureSlot = slot;
+            }
+            firstVertex = std::min(firstVertex, filledVertex);
+            lastVertex = filledVertex + vertexCount;
+        }
+        filledVertex += vertexCount;
+    }
+
+    if (firstVertex < lastVertex)
+    {
+        vertexBuffer->updateSubData(&_multiTextureVerts[firstVertex],
+                                    firstVertex * sizeof(MultiTextureVertex),
+                                    (lastVertex - firstVertex) * sizeof(MultiTextureVertex));
+    }
+}
+
+void Renderer::drawMultiTextureBatch(const TriBatchToDraw& batch)
+{
+    auto vertexBuffer = _triangleCommandBufferManager.getMultiTextureVertexBuffer();
+    if (!vertexBuffer)
+        return;
+
+    // Every command of the batch uses the projection of the default sprite program, take it from the last one.
+    auto& pipelineDescriptor = batch.cmd->getPipelineDescriptor();
+    auto programState = pipelineDescriptor.programState;
+    auto mvpLocation = programState->getUniformLocation(backend::Uniform::MVP_MATRIX);
+    char* uniformBuffer = nullptr;
+    std::size_t uniformBufferSize = 0;
+    programState->getVertexUniformBuffer(&uniformBuffer, uniformBufferSize);
+    if (uniformBuffer && mvpLocation.location[1] >= 0 && (std::size_t)mvpLocation.location[1] + sizeof(Mat4::m) <= uniformBufferSize)
+        _multiTextureProgramState->setUniform(_multiTextureMVPLocation, uniformBuffer + mvpLocation.location[1], sizeof(Mat4::m));
+
+    _multiTextureBatchSlots.assign(_multiTextureSlots.begin(), _multiTextureSlots.begin() + batch.textureCount);
+    _multiTextureBatchTextures.assign(_triBatchTextures.begin() + batch.firstTexture,
+                                      _triBatchTextures.begin() + batch.firstTexture + batch.textureCount);
+    _multiTextureProgramState->setTextureArray(_multiTextureSamplersLocation, _multiTextureBatchSlots, _multiTextureBatchTextures);
+
+    PipelineDescriptor multiTextureDescriptor = pipelineDescriptor;
+    multiTextureDescriptor.programState = _multiTextureProgramState;
+    beginRenderPass(multiTextureDescriptor);
+    _commandBuffer->setVertexBuffer(vertexBuffer);
+    _commandBuffer->setIndexBuffer(_indexBuffer);
+    _commandBuffer->setProgramState(_multiTextureProgramState);
+    _commandBuffer->drawElements(backend::PrimitiveType::TRIANGLE,
+                                 _triangleIndexFormat,
+                                 batch.indicesToDraw,
+                                 batch.offset * _triangleIndexSize);
+    _commandBuffer->endRenderPass();
+}
+
 void Renderer::fillVerticesAndIndices(const TrianglesCommand* cmd, unsigned int vertexBufferOffset)
 {
-    size_t vertexCount = cmd->getVertexCount();
-    memcpy(&_verts[_filledVertex], cmd->getVertices(), sizeof(V3F_C4B_T2F) * vertexCount);
+    fillVerticesAndIndices(cmd, vertexBufferOffset, _filledVertex, _filledIndex);
     
+    _filledVertex += cmd->getVertexCount();
+    _filledIndex += cmd->getIndexCount();
+}
+
+void Renderer::fillVerticesAndIndices(const TrianglesCommand* cmd, unsigned int vertexBufferOffset, unsigned int filledVertex, unsigned int filledIndex)
+{
     // fill vertex, and convert them to world coordinates
-    const Mat4& modelView = cmd->getModelView();
-    for (size_t i=0; i < vertexCount; ++i)
-    {
-        modelView.transformPoint(&(_verts[i + _filledVertex].vertices));
-    }
+    MathUtil::transformVertices(&_verts[filledVertex], cmd->getVertices(), cmd->getVertexCount(), cmd->getModelView());
     
     // fill index
-    const unsigned short* indices = cmd->getIndices();
-    size_t indexCount = cmd->getIndexCount();
-    for (size_t i = 0; i < indexCount; ++i)
+    if (backend::IndexFormat::U_INT == _triangleIndexFormat)
+        MathUtil::transformIndices(static_cast<unsigned int*>(_indices) + filledIndex, cmd->getIndices(), cmd->getIndexCount(), vertexBufferOffset + filledVertex);
+    else
+        MathUtil::transformIndices(static_cast<unsigned short*>(_indices) + filledIndex, cmd->getIndices(), cmd->getIndexCount(), vertexBufferOffset + filledVertex);
+}
+
+void Renderer::fillVerticesAndIndicesParallel(unsigned int vertexBufferOffset)
+{
+    // Split the queued commands into ranges holding about the same number of vertices,
+    // the output offsets of each range are the sums of the counts before it.
+    const size_t jobCount = _triangleFillWorkers->getWorkerCount() + 1;
+    const size_t commandCount = _queuedTriangleCommands.size();
+    _triFillJobs.resize(jobCount);
+
+    size_t jobsTotal = 0;
+    size_t commandIndex = 0;
+    unsigned int filledVertex = 0;
+    unsigned int filledIndex = 0;
+    while (commandIndex < commandCount)
     {
-        _indices[_filledIndex + i] = vertexBufferOffset + _filledVertex + indices[i];
+        auto& job = _triFillJobs[jobsTotal++];
+        job.firstCommand = commandIndex;
+        job.filledVertex = filledVertex;
+        job.filledIndex = filledIndex;
+
+        // the last job takes whatever is left
+        const bool lastJob = jobsTotal == jobCount;
+        const unsigned int vertexLimit = (unsigned int)((uint64_t)_filledVertex * jobsTotal / jobCount);
+        do
+        {
+            const auto cmd = _queuedTriangleCommands[commandIndex++];
+            filledVertex += cmd->getVertexCount();
+            filledIndex += cmd->getIndexCount();
+        } while (commandIndex < commandCount && (lastJob || filledVertex < vertexLimit));
+        job.lastCommand = commandIndex;
     }
-    
-    _filledVertex += vertexCount;
-    _filledIndex += indexCount;
+
+    _triangleFillWorkers->run(jobsTotal, [this, vertexBufferOffset](size_t jobIndex) {
+        const auto& job = _triFillJobs[jobIndex];
+        unsigned int filledVertex = job.filledVertex;
+        unsigned int filledIndex = job.filledIndex;
+        for (size_t i = job.firstCommand; i < job.lastCommand; ++i)
+        {
+            const auto cmd = _queuedTriangleCommands[i];
+            fillVerticesAndIndices(cmd, vertexBufferOffset, filledVertex, filledIndex);
+            filledVertex += cmd->getVertexCount();
+            filledIndex += cmd->getIndexCount();
+        }
+    });
 }
 
 void Renderer::drawBatchedTriangles()
@@ -555,13 +1144,9 @@ void Renderer::drawBatchedTriangles()
         return;
     
     /************** 1: Setup up vertices/indices *************/
-#ifdef CC_USE_METAL
+    // Every flush appends to the current buffers instead of overwriting the data of previous flushes.
     unsigned int vertexBufferFillOffset = _queuedTotalVertexCount - _queuedVertexCount;
     unsigned int indexBufferFillOffset = _queuedTotalIndexCount - _queuedIndexCount;
-#else
-    unsigned int vertexBufferFillOffset = 0;
-    unsigned int indexBufferFillOffset = 0;
-#endif
 
     _triBatchesToDraw[0].offset = indexBufferFillOffset;
     _triBatchesToDraw[0].indicesToDraw = 0;
@@ -569,17 +1154,25 @@ void Renderer::drawBatchedTriangles()
     
     int batchesTotal = 0;
     int prevMaterialID = -1;
+    int prevTextureSlot = -1;
     bool firstCommand = true;
 
     _filledVertex = 0;
     _filledIndex = 0;
 
-    for(const auto& cmd : _queuedTriangleCommands)
+    _triBatchTextures.clear();
+    if (_multiTextureBatchingEnabled)
+        _queuedTextureSlots.resize(_queuedTriangleCommands.size());
+
+    for (size_t commandIndex = 0, commandCount = _queuedTriangleCommands.size(); commandIndex < commandCount; ++commandIndex)
     {
+        const auto& cmd = _queuedTriangleCommands[commandIndex];
         auto currentMaterialID = cmd->getMaterialID();
         const bool batchable = !cmd->isSkipBatching();
+        int textureSlot = -1;
         
-        fillVerticesAndIndices(cmd, vertexBufferFillOffset);
+        _filledVertex += cmd->getVertexCount();
+        _filledIndex += cmd->getIndexCount();
         
         // in the same batch ?
         if (batchable && (prevMaterialID == currentMaterialID || firstCommand))
@@ -587,6 +1180,14 @@ void Renderer::drawBatchedTriangles()
             CC_ASSERT((firstCommand || _triBatchesToDraw[batchesTotal].cmd->getMaterialID() == cmd->getMaterialID()) && "argh... error in logic");
             _triBatchesToDraw[batchesTotal].indicesToDraw += cmd->getIndexCount();
             _triBatchesToDraw[batchesTotal].cmd = cmd;
+            textureSlot = firstCommand ? startMultiTextureBatch(_triBatchesToDraw[batchesTotal], cmd) : prevTextureSlot;
+        }
+        // can it join the batch with another texture ?
+        else if (batchable && _multiTextureBatchingEnabled &&
+                 (textureSlot = joinMultiTextureBatch(_triBatchesToDraw[batchesTotal], cmd)) >= 0)
+        {
+            _triBatchesToDraw[batchesTotal].indicesToDraw += cmd->getIndexCount();
+            _triBatchesToDraw[batchesTotal].cmd = cmd;
         }
         else
         {
@@ -600,11 +1201,18 @@ void Renderer::drawBatchedTriangles()
             
             _triBatchesToDraw[batchesTotal].cmd = cmd;
             _triBatchesToDraw[batchesTotal].indicesToDraw = (int) cmd->getIndexCount();
+            textureSlot = startMultiTextureBatch(_triBatchesToDraw[batchesTotal], batchable ? cmd : nullptr);
             
             // is this a single batch ? Prevent creating a batch group then
             if (!batchable)
                 currentMaterialID = -1;
         }
+
+        if (_multiTextureBatchingEnabled)
+        {
+            _queuedTextureSlots[commandIndex].batch = batchesTotal;
+            _queuedTextureSlots[commandIndex].slot = textureSlot;
+        }
         
         // capacity full ?
         if (batchesTotal + 1 >= _triBatchesToDrawCapacity)
@@ -614,29 +1222,49 @@ void Renderer::drawBatchedTriangles()
         }
         
         prevMaterialID = currentMaterialID;
+        prevTextureSlot = textureSlot;
         firstCommand = false;
     }
     batchesTotal++;
-#ifdef CC_USE_METAL
+
+    // The output range of every command is known now, fill them serially or in parallel.
+    if (_parallelFillThreshold > 0 && _filledVertex >= _parallelFillThreshold)
+    {
+        fillVerticesAndIndicesParallel(vertexBufferFillOffset);
+    }
+    else
+    {
+        _filledVertex = 0;
+        _filledIndex = 0;
+        for (const auto& cmd : _queuedTriangleCommands)
+            fillVerticesAndIndices(cmd, vertexBufferFillOffset);
+    }
+
     _vertexBuffer->updateSubData(_verts, vertexBufferFillOffset * sizeof(_verts[0]), _filledVertex * sizeof(_verts[0]));
-    _indexBuffer->updateSubData(_indices, indexBufferFillOffset * sizeof(_indices[0]), _filledIndex * sizeof(_indices[0]));
-#else
-    _vertexBuffer->updateData(_verts, _filledVertex * sizeof(_verts[0]));
-    _indexBuffer->updateData(_indices,  _filledIndex * sizeof(_indices[0]));
-#endif
+    _indexBuffer->updateSubData(_indices, indexBufferFillOffset * _triangleIndexSize, _filledIndex * _triangleIndexSize);
+    if (!_triBatchTextures.empty())
+        fillMultiTextureVertices(vertexBufferFillOffset);
 
     /************** 2: Draw *************/
     for (int i = 0; i < batchesTotal; ++i)
     {
+        if (_triBatchesToDraw[i].textureCount > 1)
+        {
+            drawMultiTextureBatch(_triBatchesToDraw[i]);
+            _drawnBatches++;
+            _drawnVertices += _triBatchesToDraw[i].indicesToDraw;
+            continue;
+        }
+
         beginRenderPass(_triBatchesToDraw[i].cmd);
         _commandBuffer->setVertexBuffer(_vertexBuffer);
         _commandBuffer->setIndexBuffer(_indexBuffer);
         auto& pipelineDescriptor = _triBatchesToDraw[i].cmd->getPipelineDescriptor();
         _commandBuffer->setProgramState(pipelineDescriptor.programState);
         _commandBuffer->drawElements(backend::PrimitiveType::TRIANGLE,
-                                     backend::IndexFormat::U_SHORT,
+                                     _triangleIndexFormat,
                                      _triBatchesToDraw[i].indicesToDraw,
-                                     _triBatchesToDraw[i].offset * sizeof(_indices[0]));
+                                     _triBatchesToDraw[i].offset * _triangleIndexSize);
         _commandBuffer->endRenderPass();
 
         _drawnBatches++;
@@ -646,10 +1274,8 @@ void Renderer::drawBatchedTriangles()
     /************** 3: Cleanup *************/
     _queuedTriangleCommands.clear();
 
-#ifdef CC_USE_METAL
     _queuedIndexCount = 0;
     _queuedVertexCount = 0;
-#endif
 }
 
 void Renderer::drawCustomCommand(RenderCommand *command)
@@ -764,13 +1390,18 @@ void Renderer::setRenderPipeline(const PipelineDescriptor& pipelineDescriptor, c
 }
 
 void Renderer::beginRenderPass(RenderCommand* cmd)
+{
+    beginRenderPass(cmd->getPipelineDescriptor());
+}
+
+void Renderer::beginRenderPass(const PipelineDescriptor& pipelineDescriptor)
 {
      _commandBuffer->beginRenderPass(_renderPassDescriptor);
      _commandBuffer->setViewport(_viewport.x, _viewport.y, _viewport.w, _viewport.h);
      _commandBuffer->setCullMode(_cullMode);
      _commandBuffer->setWinding(_winding);
      _commandBuffer->setScissorRect(_scissorState.isEnabled, _scissorState.rect.x, _scissorState.rect.y, _scissorState.rect.width, _scissorState.rect.height);
-     setRenderPipeline(cmd->getPipelineDescriptor(), _renderPassDescriptor);
+     setRenderPipeline(pipelineDescriptor, _renderPassDescriptor);
 
     _commandBuffer->setStencilReferenceValue(_stencilRef);
 }
@@ -935,26 +1566,82 @@ void Renderer::setScissorRect(float x, float y, float width, float height)
 // TriangleCommandBufferManager
 Renderer::TriangleCommandBufferManager::~TriangleCommandBufferManager()
 {
-    for (auto& vertexBuffer : _vertexBufferPool)
-        vertexBuffer->release();
-
-    for (auto& indexBuffer : _indexBufferPool)
-        indexBuffer->release();
+    releaseAllBuffers();
+    releaseMultiTextureBuffers();
 }
 
-void Renderer::TriangleCommandBufferManager::init()
+void Renderer::TriangleCommandBufferManager::init(std::size_t vertexBufferSize, std::size_t indexBufferSize)
 {
+    releaseAllBuffers();
+    _vertexBufferSize = vertexBufferSize;
+    _indexBufferSize = indexBufferSize;
     createBuffer();
 }
 
-void Renderer::TriangleCommandBufferManager::putbackAllBuffers()
+void Renderer::TriangleCommandBufferManager::releaseAllBuffers()
+{
+    for (auto& vertexBufferPool : _vertexBufferPools)
+    {
+        for (auto& vertexBuffer : vertexBufferPool)
+            vertexBuffer->release();
+        vertexBufferPool.clear();
+    }
+
+    for (auto& indexBufferPool : _indexBufferPools)
+    {
+        for (auto& indexBuffer : indexBufferPool)
+            indexBuffer->release();
+        indexBufferPool.clear();
+    }
+
+    _currentBufferIndex = 0;
+    // the multi-texture vertex buffers follow the vertex buffers, they are recreated on demand
+    releaseMultiTextureBuffers();
+}
+
+void Renderer::TriangleCommandBufferManager::releaseMultiTextureBuffers()
+{
+    for (auto& vertexBufferPool : _multiTextureVertexBufferPools)
+    {
+        for (auto& vertexBuffer : vertexBufferPool)
+            CC_SAFE_RELEASE(vertexBuffer);
+        vertexBufferPool.clear();
+    }
+}
+
+void Renderer::TriangleCommandBufferManager::setMultiTextureVertexBufferSize(std::size_t vertexBufferSize)
+{
+    releaseMultiTextureBuffers();
+    _multiTextureVertexBufferSize = vertexBufferSize;
+}
+
+backend::Buffer* Renderer::TriangleCommandBufferManager::getMultiTextureVertexBuffer()
 {
+    if (_multiTextureVertexBufferSize == 0)
+        return nullptr;
+
+    auto& vertexBufferPool = _multiTextureVertexBufferPools[_currentFrameIndex];
+    if ((int)vertexBufferPool.size() <= _currentBufferIndex)
+        vertexBufferPool.resize(_currentBufferIndex + 1, nullptr);
+
+    auto& vertexBuffer = vertexBufferPool[_currentBufferIndex];
+    if (!vertexBuffer)
+        vertexBuffer = newStreamBuffer(_multiTextureVertexBufferSize, backend::BufferType::VERTEX);
+    return vertexBuffer;
+}
+
+void Renderer::TriangleCommandBufferManager::putbackAllBuffers(unsigned int frameIndex)
+{
+    _currentFrameIndex = frameIndex % FRAME_BUFFER_SETS;
     _currentBufferIndex = 0;
+
+    if (_vertexBufferPools[_currentFrameIndex].empty())
+        createBuffer();
 }
 
 void Renderer::TriangleCommandBufferManager::prepareNextBuffer()
 {
-    if (_currentBufferIndex < (int)_vertexBufferPool.size() - 1)
+    if (_currentBufferIndex < (int)_vertexBufferPools[_currentFrameIndex].size() - 1)
     {
         ++_currentBufferIndex;
         return;
@@ -966,12 +1653,12 @@ void Renderer::TriangleCommandBufferManager::prepareNextBuffer()
 
 backend::Buffer* Renderer::TriangleCommandBufferManager::getVertexBuffer() const
 {
-    return _vertexBufferPool[_currentBufferIndex];
+    return _vertexBufferPools[_currentFrameIndex][_currentBufferIndex];
 }
 
 backend::Buffer* Renderer::TriangleCommandBufferManager::getIndexBuffer() const
 {
-    return _indexBufferPool[_currentBufferIndex];
+    return _indexBufferPools[_currentFrameIndex][_currentBufferIndex];
 }
 
 void Renderer::TriangleCommandBufferManager::createBuffer()
@@ -980,43 +1667,60 @@ void Renderer::TriangleCommandBufferManager::createBuffer()
 
 #ifdef CC_USE_METAL
     // Metal doesn't need to update buffer to make sure it has the correct size.
-    auto vertexBuffer = device->newBuffer(Renderer::VBO_SIZE * sizeof(_verts[0]), backend::BufferType::VERTEX, backend::BufferUsage::DYNAMIC);
+    auto vertexBuffer = device->newBuffer(_vertexBufferSize, backend::BufferType::VERTEX, backend::BufferUsage::DYNAMIC);
     if (!vertexBuffer)
         return;
 
-    auto indexBuffer = device->newBuffer(Renderer::INDEX_VBO_SIZE * sizeof(_indices[0]), backend::BufferType::INDEX, backend::BufferUsage::DYNAMIC);
+    auto indexBuffer = device->newBuffer(_indexBufferSize, backend::BufferType::INDEX, backend::BufferUsage::DYNAMIC);
     if (!indexBuffer)
     {
         vertexBuffer->release();
         return;
     }
 #else
-    auto tmpData = malloc(Renderer::VBO_SIZE * sizeof(V3F_C4B_T2F));
+    auto tmpData = malloc(std::max(_vertexBufferSize, _indexBufferSize));
     if (!tmpData)
         return;
 
-    auto vertexBuffer = device->newBuffer(Renderer::VBO_SIZE * sizeof(V3F_C4B_T2F), backend::BufferType::VERTEX, backend::BufferUsage::DYNAMIC);
+    auto vertexBuffer = device->newBuffer(_vertexBufferSize, backend::BufferType::VERTEX, backend::BufferUsage::STREAM);
     if (!vertexBuffer)
     {
         free(tmpData);
         return;
     }
-    vertexBuffer->updateData(tmpData, Renderer::VBO_SIZE * sizeof(V3F_C4B_T2F));
+    vertexBuffer->updateData(tmpData, _vertexBufferSize);
 
-    auto indexBuffer = device->newBuffer(Renderer::INDEX_VBO_SIZE * sizeof(unsigned short), backend::BufferType::INDEX, backend::BufferUsage::DYNAMIC);
+    auto indexBuffer = device->newBuffer(_indexBufferSize, backend::BufferType::INDEX, backend::BufferUsage::STREAM);
     if (! indexBuffer)
     {
         free(tmpData);
         vertexBuffer->release();
         return;
     }
-    indexBuffer->updateData(tmpData, Renderer::INDEX_VBO_SIZE * sizeof(unsigned short));
+    indexBuffer->updateData(tmpData, _indexBufferSize);
 
     free(tmpData);
 #endif
 
-    _vertexBufferPool.push_back(vertexBuffer);
-    _indexBufferPool.push_back(indexBuffer);
+    _vertexBufferPools[_currentFrameIndex].push_back(vertexBuffer);
+    _indexBufferPools[_currentFrameIndex].push_back(indexBuffer);
+}
+
+backend::Buffer* Renderer::TriangleCommandBufferManager::newStreamBuffer(std::size_t size, backend::BufferType type) const
+{
+#ifdef CC_USE_METAL
+    return backend::Device::getInstance()->newBuffer(size, type, backend::BufferUsage::DYNAMIC);
+#else
+    auto tmpData = malloc(size);
+    if (!tmpData)
+        return nullptr;
+
+    auto buffer = backend::Device::getInstance()->newBuffer(size, type, backend::BufferUsage::STREAM);
+    if (buffer)
+        buffer->updateData(tmpData, size);
+    free(tmpData);
+    return buffer;
+#endif
 }
 
 void Renderer::pushStateBlock()
@@ -49,6 +49,8 @@ namespace backend
     class CommandBuffer;
     class RenderPipeline;
     class RenderPass;
+    class ProgramState;
+    class TextureBackend;
     struct RenderPipelineDescriptor;
 }
 
@@ -95,6 +97,13 @@ public:
     ssize_t size() const;
     /**Sort the render commands.*/
     void sort();
+    /**
+    Group sorted 2D triangles commands by material to reduce draw calls.
+    A command is only moved in front of commands with the same global Z order whose bounds don't overlap its own,
+    so the result is drawn the same.
+    @param lookback The max number of commands searched backwards for a command with the same material.
+    */
+    void reorderTrianglesByMaterial(int lookback);
     /**Treat sorted commands as an array, access them one by one.*/
     RenderCommand* operator[](ssize_t index) const;
     /**Clear all rendered commands.*/
@@ -107,8 +116,27 @@ public:
     ssize_t getSubQueueSize(QUEUE_GROUP group) const { return _commands[group].size(); }
     
 protected:
+    /**Bounds of a triangles command in world space, used to reorder commands.*/
+    struct TrianglesBounds
+    {
+        float minX = 0.f;
+        float minY = 0.f;
+        float maxX = 0.f;
+        float maxY = 0.f;
+    };
+    void reorderTrianglesByMaterial(std::vector<RenderCommand*>& commands, int lookback);
+    /**Stable sort of commands by global Z order, skipped when they are already in order.*/
+    void sortByGlobalOrder(std::vector<RenderCommand*>& commands);
+
     /**The commands in the render queue.*/
     std::vector<RenderCommand*> _commands[QUEUE_COUNT];
+    /**Scratch storage of reorderTrianglesByMaterial.*/
+    std::vector<RenderCommand*> _reorderedCommands;
+    std::vector<TrianglesBounds> _reorderedBounds;
+    /**Scratch storage of sortByGlobalOrder.*/
+    std::vector<RenderCommand*> _sortedCommands;
+    std::vector<uint32_t> _sortKeys;
+    std::vector<uint32_t> _sortedKeys;
     
     /**Cull state.*/
     bool _isCullEnabled;
@@ -129,14 +157,16 @@ class CC_DLL Renderer
 {
 public:
     
-    /**The max number of vertices in a vertex buffer object.*/
+    /**The default max number of vertices in a vertex buffer object.*/
     static const int VBO_SIZE = 65536;
-    /**The max number of indices in a index buffer.*/
+    /**The default max number of indices in a index buffer.*/
     static const int INDEX_VBO_SIZE = VBO_SIZE * 6 / 4;
     /**The rendercommands which can be batched will be saved into a list, this is the reserved size of this list.*/
     static const int BATCH_TRIAGCOMMAND_RESERVED_SIZE = 64;
     /**Reserved for material id, which means that the command could not be batched.*/
     static const int MATERIAL_ID_DO_NOT_BATCH = 0;
+    /**The max number of textures of a multi-texture batch, the size of the sampler array of the multi-texture shader.*/
+    static const int MULTI_TEXTURE_SLOTS = 8;
     /**Constructor.*/
     Renderer();
     /**Destructor.*/
@@ -177,6 +207,78 @@ public:
     /* clear draw stats */
     void clearDrawStats() { _drawnBatches = _drawnVertices = 0; }
 
+    /**
+     * Enable/disable grouping of triangles commands with the same material, see `RenderQueue::reorderTrianglesByMaterial`.
+     * Interleaved 2D elements using different textures, i.e. labels over images, can then be drawn in fewer draw calls.
+     * @param enabled true to enable reordering, false by default.
+     * @param lookback The max number of commands searched backwards for a command with the same material.
+     */
+    void setTrianglesReorderEnabled(bool enabled, int lookback = 64);
+
+    /** Get whether triangles commands are grouped by material. */
+    bool isTrianglesReorderEnabled() const { return _trianglesReorderEnabled; }
+
+    /**
+     * Set the capacity of the buffers batched triangles are written into, `VBO_SIZE` and `INDEX_VBO_SIZE` by default.
+     * Batches are flushed when they are full, so a bigger capacity lets large meshes be drawn in fewer draw calls.
+     * 32-bit indices are used when the vertex capacity is bigger than 65536, otherwise 16-bit indices are used,
+     * on OpenGL ES 2.0 without the GL_OES_element_index_uint extension the vertex capacity is limited to 65536.
+     * Should not be invoked while rendering.
+     * @param vertexCapacity The max number of vertices in a batch.
+     * @param indexCapacity The max number of indices in a batch.
+     */
+    void setTriangleBatchCapacity(unsigned int vertexCapacity, unsigned int indexCapacity);
+
+    /** Get the max number of vertices in a batch of triangles. */
+    unsigned int getTriangleBatchVertexCapacity() const { return _triangleVertexCapacity; }
+
+    /** Get the max number of indices in a batch of triangles. */
+    unsigned int getTriangleBatchIndexCapacity() const { return _triangleIndexCapacity; }
+
+    /** Get the index format used by batched triangles, see `setTriangleBatchCapacity`. */
+    backend::IndexFormat getTriangleBatchIndexFormat() const { return _triangleIndexFormat; }
+
+    /**
+     * Fill the vertices and indices of batched triangles on several threads.
+     * The fill phase of a batch is split across worker threads when the batch holds at least
+     * `vertexThreshold` vertices, otherwise it runs on the render thread.
+     * @param vertexThreshold The minimal vertex count of a batch to be filled in parallel, 0 disables parallel filling.
+     * @param workerCount The number of worker threads, 0 means one less than the number of hardware threads.
+     */
+    void setParallelFillThreshold(unsigned int vertexThreshold, unsigned int workerCount = 0);
+
+    /**
+     * Get the minimal vertex count of a batch to be filled in parallel.
+     * @return The vertex threshold, 0 means parallel filling is disabled.
+     */
+    unsigned int getParallelFillThreshold() const { return _parallelFillThreshold; }
+
+    /**
+     * Enable/disable pipelined rendering, OpenGL only.
+     * When enabled, GL commands are executed on a render thread, so the GL work of a frame overlaps the update
+     * and visit of the next frame. Requires a view able to hand over its GL context, see `GLView::makeContextCurrent`.
+     * Should not be invoked while rendering.
+     * @param enabled true to enable pipelined rendering, false by default.
+     * @return Whether pipelined rendering is enabled after the call.
+     */
+    bool setPipelinedRenderingEnabled(bool enabled);
+
+    /** Get whether GL commands are executed on a render thread. */
+    bool isPipelinedRenderingEnabled() const;
+
+    /**
+     * Enable/disable batching of triangles commands using different textures, OpenGL only.
+     * Consecutive commands using the default sprite program and the same blend function are drawn in one draw call
+     * with up to `MULTI_TEXTURE_SLOTS` textures bound at once, a per-vertex texture slot selects the texture.
+     * Should not be invoked while rendering.
+     * @param enabled true to enable multi-texture batching, false by default.
+     * @return Whether multi-texture batching is enabled after the call.
+     */
+    bool setMultiTextureBatchingEnabled(bool enabled);
+
+    /** Get whether triangles commands using different textures are batched. */
+    bool isMultiTextureBatchingEnabled() const { return _multiTextureBatchingEnabled; }
+
     /**
      Set render targets. If not set, will use default render targets. It will effect all commands.
      @flags Flags to indicate which attachment to be replaced.
@@ -412,6 +514,7 @@ protected:
     /**
      * Create and reuse vertex and index buffer for triangleCommand.
      * When queued vertex or index count exceed the limited value, a new vertex or index buffer will be created.
+     * Flushes of the same frame append into the current buffers.
      */
     class TriangleCommandBufferManager
     {
@@ -420,15 +523,19 @@ protected:
 
         /**
          * Create a new vertex buffer and a index buffer and push it to cache.
+         * Buffers created by a previous call are released.
          * @note Should invoke firstly.
+         * @param vertexBufferSize The size in bytes of the vertex buffers.
+         * @param indexBufferSize The size in bytes of the index buffers.
          */
-        void init();
+        void init(std::size_t vertexBufferSize, std::size_t indexBufferSize);
 
         /**
-         * Reset avalable buffer index to zero.
-         * That means when get vertex buffer or index buffer, the earliest created buffer object in the cache will be returned.
+         * Switch to the buffers of the next frame and reset avalable buffer index to zero.
+         * That means when get vertex buffer or index buffer, the earliest created buffer object of that frame will be returned.
+         * @param frameIndex The frame index of the command buffer, see backend::CommandBuffer::getFrameIndex().
          */
-        void putbackAllBuffers();
+        void putbackAllBuffers(unsigned int frameIndex);
 
         /**
          * Buffer will be created If next buffer unavailable in the cache, otherwise set the buffer index in order to get the next available buffer.
@@ -438,14 +545,49 @@ protected:
         backend::Buffer* getVertexBuffer() const; ///< Get the vertex buffer.
         backend::Buffer* getIndexBuffer() const; ///< Get the index buffer.
 
+        /**
+         * Set the size of the multi-texture vertex buffers, 0 releases them.
+         * They are kept beside the vertex buffers of the same frame and buffer index, so they share the index buffer.
+         * @param vertexBufferSize The size in bytes of the multi-texture vertex buffers.
+         */
+        void setMultiTextureVertexBufferSize(std::size_t vertexBufferSize);
+
+        /**
+         * Get the multi-texture vertex buffer matching the current vertex buffer, it is created on first use.
+         * @return nullptr if no size is set or the buffer can not be created.
+         */
+        backend::Buffer* getMultiTextureVertexBuffer();
+
     private:
         void createBuffer();
-
+        backend::Buffer* newStreamBuffer(std::size_t size, backend::BufferType type) const;
+        void releaseAllBuffers();
+        void releaseMultiTextureBuffers();
+
+#ifdef CC_USE_METAL
+        // BufferMTL already keeps a copy of dynamic buffers for each frame in flight.
+        static const int FRAME_BUFFER_SETS = 1;
+#else
+        // Streaming buffers are written without synchronization, so frames in flight need their own buffers.
+        static const int FRAME_BUFFER_SETS = MAX_INFLIGHT_BUFFER;
+#endif
+
+        std::size_t _vertexBufferSize = 0;
+        std::size_t _indexBufferSize = 0;
+        int _currentFrameIndex = 0;
         int _currentBufferIndex = 0;
-        std::vector<backend::Buffer*> _vertexBufferPool;
-        std::vector<backend::Buffer*> _indexBufferPool;
+        std::vector<backend::Buffer*> _vertexBufferPools[FRAME_BUFFER_SETS];
+        std::vector<backend::Buffer*> _indexBufferPools[FRAME_BUFFER_SETS];
+        std::size_t _multiTextureVertexBufferSize = 0;
+        std::vector<backend::Buffer*> _multiTextureVertexBufferPools[FRAME_BUFFER_SETS];
     };
 
+    /**
+     * A small pool of threads filling vertices and indices of batched triangles.
+     * Defined in CCRenderer.cpp.
+     */
+    class TriangleFillWorkers;
+
     inline GroupCommandManager * getGroupCommandManager() const { return _groupCommandManager; }
     void drawBatchedTriangles();
     void drawCustomCommand(RenderCommand* command);
@@ -470,7 +612,10 @@ protected:
     void doVisitRenderQueue(const std::vector<RenderCommand*>&);
 
     void fillVerticesAndIndices(const TrianglesCommand* cmd, unsigned int vertexBufferOffset);
+    void fillVerticesAndIndices(const TrianglesCommand* cmd, unsigned int vertexBufferOffset, unsigned int filledVertex, unsigned int filledIndex);
+    void fillVerticesAndIndicesParallel(unsigned int vertexBufferOffset);
     void beginRenderPass(RenderCommand*); /// Begin a render pass.
+    void beginRenderPass(const PipelineDescriptor&); /// Begin a render pass with the given pipeline.
     
     /**
      * Building a programmable pipeline involves an expensive evaluation of GPU state.
@@ -497,8 +642,12 @@ protected:
     std::vector<TrianglesCommand*> _queuedTriangleCommands;
 
     //for TrianglesCommand
-    V3F_C4B_T2F _verts[VBO_SIZE];
-    unsigned short _indices[INDEX_VBO_SIZE];
+    V3F_C4B_T2F* _verts = nullptr;
+    void* _indices = nullptr; // unsigned short or unsigned int, see _triangleIndexFormat
+    unsigned int _triangleVertexCapacity = 0;
+    unsigned int _triangleIndexCapacity = 0;
+    backend::IndexFormat _triangleIndexFormat = backend::IndexFormat::U_SHORT;
+    std::size_t _triangleIndexSize = sizeof(unsigned short);
     backend::Buffer* _vertexBuffer = nullptr;
     backend::Buffer* _indexBuffer = nullptr;
     TriangleCommandBufferManager _triangleCommandBufferManager;
@@ -513,6 +662,10 @@ protected:
         TrianglesCommand* cmd = nullptr;  // needed for the Material
         unsigned int indicesToDraw = 0;
         unsigned int offset = 0;
+        // textures of a multi-texture batch, in _triBatchTextures
+        uint32_t multiTextureMaterialID = 0;
+        unsigned int firstTexture = 0;
+        unsigned int textureCount = 0;
     };
     // capacity of the array of TriBatches
     int _triBatchesToDrawCapacity = 500;
@@ -526,6 +679,50 @@ protected:
     unsigned int _filledIndex = 0;
     unsigned int _filledVertex = 0;
 
+    // parallel fill of batched triangles
+    struct TriFillJob
+    {
+        size_t firstCommand = 0;
+        size_t lastCommand = 0;
+        unsigned int filledVertex = 0;
+        unsigned int filledIndex = 0;
+    };
+    std::vector<TriFillJob> _triFillJobs;
+    TriangleFillWorkers* _triangleFillWorkers = nullptr;
+    unsigned int _parallelFillThreshold = 0;
+
+    bool _trianglesReorderEnabled = false;
+    int _trianglesReorderLookback = 64;
+
+    // multi-texture batching
+    struct MultiTextureVertex
+    {
+        V3F_C4B_T2F vertex;
+        float textureSlot;
+    };
+    struct QueuedTextureSlot
+    {
+        int batch = 0;
+        int slot = -1; // -1 if the command is not in a multi-texture batch
+    };
+    int startMultiTextureBatch(TriBatchToDraw& batch, const TrianglesCommand* cmd);
+    int joinMultiTextureBatch(TriBatchToDraw& batch, const TrianglesCommand* cmd);
+    void fillMultiTextureVertices(unsigned int vertexBufferOffset);
+    void drawMultiTextureBatch(const TriBatchToDraw& batch);
+    bool allocateMultiTextureVertices();
+    void releaseMultiTextureBatching();
+
+    bool _multiTextureBatchingEnabled = false;
+    MultiTextureVertex* _multiTextureVerts = nullptr;
+    backend::ProgramState* _multiTextureProgramState = nullptr;
+    backend::UniformLocation _multiTextureMVPLocation;
+    backend::UniformLocation _multiTextureSamplersLocation;
+    std::vector<QueuedTextureSlot> _queuedTextureSlots;
+    std::vector<backend::TextureBackend*> _triBatchTextures;
+    std::vector<uint32_t> _multiTextureSlots;
+    std::vector<uint32_t> _multiTextureBatchSlots;
+    std::vector<backend::TextureBackend*> _multiTextureBatchTextures;
+
     // stats
     unsigned int _drawnBatches = 0;
     unsigned int _drawnVertices = 0;
@@ -467,6 +467,65 @@ bool Texture2D::initWithImage(Image *image, backend::PixelFormat format)
     }
 }
 
+bool Texture2D::allocateForImage(Image *image, backend::PixelFormat format)
+{
+#ifdef CC_USE_METAL
+    // a Metal texture can't be allocated without pixels
+    return false;
+#else
+    if (image == nullptr || image->getNumberOfMipmaps() > 1 || image->isCompressed())
+        return false;
+
+    int imageWidth = image->getWidth();
+    int imageHeight = image->getHeight();
+    int maxTextureSize = Configuration::getInstance()->getMaxTextureSize();
+    if (imageWidth > maxTextureSize || imageHeight > maxTextureSize)
+        return false;
+
+    backend::PixelFormat imagePixelFormat = image->getPixelFormat();
+    backend::PixelFormat renderFormat = ((PixelFormat::NONE == format) || (PixelFormat::AUTO == format)) ? imagePixelFormat : format;
+    auto formatItr = _pixelFormatInfoTables.find(imagePixelFormat);
+    if (formatItr == _pixelFormatInfoTables.end() || formatItr->second.bpp < 8)
+        return false;
+
+    if (renderFormat != imagePixelFormat)
+    {
+        // convert a pixel to know whether the rows can be converted, initWithMipmaps keeps the format of the image otherwise
+        unsigned char* outData = nullptr;
+        size_t outDataLen = 0;
+        auto convertedFormat = backend::PixelFormatUtils::convertDataToFormat(image->getData(), formatItr->second.bpp / 8, imagePixelFormat, renderFormat, &outData, &outDataLen);
+        if (outData && outData != image->getData())
+            free(outData);
+        if (convertedFormat != renderFormat)
+            renderFormat = imagePixelFormat;
+    }
+
+    MipmapInfo mipmap;
+    mipmap.address = nullptr;
+    mipmap.len = 0;
+    if (!initWithMipmaps(&mipmap, 1, renderFormat, renderFormat, imageWidth, imageHeight, image->hasPremultipliedAlpha()))
+        return false;
+
+    _filePath = image->getFilePath();
+    return true;
+#endif
+}
+
+bool Texture2D::updateWithImageRows(Image *image, int firstRow, int rowCount)
+{
+    backend::PixelFormat imagePixelFormat = image->getPixelFormat();
+    size_t rowBytes = (size_t)image->getWidth() * _pixelFormatInfoTables.at(imagePixelFormat).bpp / 8;
+    const unsigned char* rows = image->getData() + rowBytes * firstRow;
+
+    unsigned char* outData = nullptr;
+    size_t outDataLen = 0;
+    backend::PixelFormatUtils::convertDataToFormat(rows, rowBytes * rowCount, imagePixelFormat, _pixelFormat, &outData, &outDataLen);
+    bool ret = updateWithData(outData, 0, firstRow, image->getWidth(), rowCount);
+    if (outData && outData != rows)
+        free(outData);
+    return ret;
+}
+
 // implementation Texture2D (Text)
 bool Texture2D::initWithString(const char *text, const std::string& fontName, float fontSize, const Size& dimensions/* = Size(0, 0)*/, TextHAlignment hAlignment/* =  TextHAlignment::CENTER */, TextVAlignment vAlignment/* =  TextVAlignment::TOP */, bool enableWrap /* = false */, int overflow /* = 0 */)
 {
@@ -212,6 +212,25 @@ public:
     **/
     bool initWithImage(Image * image, backend::PixelFormat format);
 
+    /**
+    Allocates a texture for an image without uploading its pixels, they are uploaded by bands of rows with updateWithImageRows.
+    Used to spread the upload of a big image over several frames.
+
+    @param image An UIImage object, it must stay alive until its last row is uploaded.
+    @param format Texture pixel formats, as for initWithImage.
+    @return false if the image can't be uploaded by rows, e.g. it is compressed or has mipmaps, use initWithImage instead.
+    **/
+    bool allocateForImage(Image * image, backend::PixelFormat format);
+
+    /**
+    Uploads rows of the image passed to allocateForImage, converting them to the pixel format of the texture.
+
+    @param image The image passed to allocateForImage.
+    @param firstRow The first row to upload.
+    @param rowCount The number of rows to upload.
+    **/
+    bool updateWithImageRows(Image * image, int firstRow, int rowCount);
+
     /** Initializes a texture from a string with dimensions, alignment, font name and font size. 
      
      @param text A null terminated string.
@@ -418,6 +437,9 @@ protected:
     CustomCommand _customCommand;
     
     bool _isRenderTarget = false;
+
+    // frame the texture was last used in, kept by TextureCache to evict the least recently used textures
+    unsigned int _lastUsedFrame = 0;
 };
 
 
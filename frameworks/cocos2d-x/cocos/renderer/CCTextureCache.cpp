@@ -32,6 +32,9 @@ THE SOFTWARE.
 #include <stack>
 #include <cctype>
 #include <list>
+#include <atomic>
+#include <algorithm>
+#include <chrono>
 
 #include "renderer/CCTexture2D.h"
 #include "base/ccMacros.h"
@@ -63,8 +66,24 @@ std::string TextureCache::getETC1AlphaFileSuffix()
     return s_etc1AlphaFileSuffix;
 }
 
+namespace
+{
+    unsigned int defaultLoadingThreadCount()
+    {
+        // leave a core to the main thread
+        unsigned int cores = std::thread::hardware_concurrency();
+        return cores > 2 ? std::min(cores - 1, 4u) : 1;
+    }
+
+    // band of rows uploaded per step when only the time is budgeted
+    const size_t DEFAULT_UPLOAD_BAND_BYTES = 1024 * 1024;
+}
+
 TextureCache::TextureCache()
-: _loadingThread(nullptr)
+: _loadingThreadCount(defaultLoadingThreadCount())
+, _uploadBytesPerFrame(0)
+, _uploadMillisecondsPerFrame(0)
+, _textureMemoryBudget(0)
 , _needQuit(false)
 , _asyncRefCount(0)
 {
@@ -77,7 +96,8 @@ TextureCache::~TextureCache()
     for (auto& texture : _textures)
         texture.second->release();
 
-    CC_SAFE_DELETE(_loadingThread);
+    for (auto thread : _loadingThreads)
+        delete thread;
 }
 
 std::string TextureCache::getDescription() const
@@ -90,10 +110,11 @@ struct TextureCache::AsyncStruct
 public:
     AsyncStruct
     ( const std::string& fn,const std::function<void(Texture2D*)>& f,
-      const std::string& key )
+      const std::string& key, AsyncPriority p )
       : filename(fn), callback(f),callbackKey( key ),
         pixelFormat(Texture2D::getDefaultAlphaPixelFormat()),
-        loadSuccess(false)
+        priority(p), loadSuccess(false), cancelled(false), loaded(false),
+        uploadingTexture(nullptr), uploadedRows(0)
     {}
 
     std::string filename;
@@ -102,18 +123,23 @@ public:
     Image image;
     Image imageAlpha;
     backend::PixelFormat pixelFormat;
+    AsyncPriority priority;
     bool loadSuccess;
+    bool cancelled;             // unbound before being decoded
+    std::atomic<bool> loaded;   // set by the loading thread once image is filled
+    Texture2D* uploadingTexture; // uploaded by bands of rows over several frames
+    int uploadedRows;
 };
 
 /**
  The addImageAsync logic follow the steps:
- - find the image has been add or not, if not add an AsyncStruct to _requestQueue  (GL thread)
- - get AsyncStruct from _requestQueue, load res and fill image data to AsyncStruct.image, then add AsyncStruct to _responseQueue (Load thread)
- - on schedule callback, get AsyncStruct from _responseQueue, convert image to texture, then delete AsyncStruct (GL thread)
+ - find the image has been add or not, if not add an AsyncStruct to _requestQueue or _prefetchRequestQueue (GL thread)
+ - get AsyncStruct from _requestQueue then _prefetchRequestQueue, load res and fill image data to AsyncStruct.image, then mark it loaded (Load threads)
+ - on schedule callback, take the loaded AsyncStructs from _asyncStructQueue in request order for each priority, convert image to texture, then delete AsyncStruct (GL thread)
 
  the Critical Area include these members:
- - _requestQueue: locked by _requestMutex
- - _responseQueue: locked by _responseMutex
+ - _requestQueue, _prefetchRequestQueue: locked by _requestMutex
+ - AsyncStruct::loaded: atomic, the image is only touched by the GL thread once it is set
 
  the object's life time:
  - AsyncStruct: construct and destruct in GL thread
@@ -142,13 +168,13 @@ void TextureCache::addImageAsync(const std::string &path, const std::function<vo
 
 /**
  The addImageAsync logic follow the steps:
- - find the image has been add or not, if not add an AsyncStruct to _requestQueue  (GL thread)
- - get AsyncStruct from _requestQueue, load res and fill image data to AsyncStruct.image, then add AsyncStruct to _responseQueue (Load thread)
- - on schedule callback, get AsyncStruct from _responseQueue, convert image to texture, then delete AsyncStruct (GL thread)
+ - find the image has been add or not, if not add an AsyncStruct to _requestQueue or _prefetchRequestQueue (GL thread)
+ - get AsyncStruct from _requestQueue then _prefetchRequestQueue, load res and fill image data to AsyncStruct.image, then mark it loaded (Load threads)
+ - on schedule callback, take the loaded AsyncStructs from _asyncStructQueue in request order for each priority, convert image to texture, then delete AsyncStruct (GL thread)
  
  the Critical Area include these members:
- - _requestQueue: locked by _requestMutex
- - _responseQueue: locked by _responseMutex
+ - _requestQueue, _prefetchRequestQueue: locked by _requestMutex
+ - AsyncStruct::loaded: atomic, the image is only touched by the GL thread once it is set
  
  the object's life time:
  - AsyncStruct: construct and destruct in GL thread
@@ -173,6 +199,11 @@ void TextureCache::addImageAsync(const std::string &path, const std::function<vo
  unbindImageAsync(path) would be ambiguous.
  */
 void TextureCache::addImageAsync(const std::string &path, const std::function<void(Texture2D*)>& callback, const std::string& callbackKey)
+{
+    addImageAsync(path, callback, callbackKey, AsyncPriority::HIGH);
+}
+
+void TextureCache::addImageAsync(const std::string &path, const std::function<void(Texture2D*)>& callback, const std::string& callbackKey, AsyncPriority priority)
 {
     Texture2D *texture = nullptr;
 
@@ -184,6 +215,7 @@ void TextureCache::addImageAsync(const std::string &path, const std::function<vo
 
     if (texture != nullptr)
     {
+        touchTexture(texture);
         if (callback) callback(texture);
         return;
     }
@@ -195,11 +227,11 @@ void TextureCache::addImageAsync(const std::string &path, const std::function<vo
     }
 
     // lazy init
-    if (_loadingThread == nullptr)
+    if (_loadingThreads.empty())
     {
-        // create a new thread to load images
+        // create the threads to load images
         _needQuit = false;
-        _loadingThread = new (std::nothrow) std::thread(&TextureCache::loadImage, this);
+        startLoadingThreads();
     }
 
     if (0 == _asyncRefCount)
@@ -211,23 +243,70 @@ void TextureCache::addImageAsync(const std::string &path, const std::function<vo
 
     // generate async struct
     AsyncStruct *data =
-      new (std::nothrow) AsyncStruct(fullpath, callback, callbackKey);
+      new (std::nothrow) AsyncStruct(fullpath, callback, callbackKey, priority);
     
     // add async struct into queue
     _asyncStructQueue.push_back(data);
     std::unique_lock<std::mutex> ul(_requestMutex);
-    _requestQueue.push_back(data);
+    if (priority == AsyncPriority::HIGH)
+        _requestQueue.push_back(data);
+    else
+        _prefetchRequestQueue.push_back(data);
     _sleepCondition.notify_one();
 }
 
-void TextureCache::unbindImageAsync(const std::string& callbackKey)
+void TextureCache::setAsyncLoadingThreadCount(unsigned int count)
+{
+    _loadingThreadCount = std::max(count, 1u);
+    // grow a running pool at once
+    if (!_loadingThreads.empty() && !_needQuit)
+        startLoadingThreads();
+}
+
+void TextureCache::setAsyncUploadBudget(unsigned int bytesPerFrame, float millisecondsPerFrame)
+{
+    _uploadBytesPerFrame = bytesPerFrame;
+    _uploadMillisecondsPerFrame = std::max(millisecondsPerFrame, 0.0f);
+}
+
+void TextureCache::startLoadingThreads()
 {
-    if (_asyncStructQueue.empty())
+    while (_loadingThreads.size() < _loadingThreadCount)
     {
-        return;
+        auto thread = new (std::nothrow) std::thread(&TextureCache::loadImage, this);
+        if (thread == nullptr)
+            break;
+        _loadingThreads.push_back(thread);
     }
+}
 
+void TextureCache::cancelImageAsync(AsyncStruct* asyncStruct)
+{
+    asyncStruct->callback = nullptr;
+
+    // not picked by a loading thread yet, it won't be decoded
+    std::unique_lock<std::mutex> ul(_requestMutex);
+    auto& queue = asyncStruct->priority == AsyncPriority::HIGH ? _requestQueue : _prefetchRequestQueue;
+    auto it = std::find(queue.begin(), queue.end(), asyncStruct);
+    if (it != queue.end())
+    {
+        queue.erase(it);
+        asyncStruct->cancelled = true;
+        asyncStruct->loaded.store(true, std::memory_order_release);
+    }
+}
+
+void TextureCache::unbindImageAsync(const std::string& callbackKey)
+{
     for (auto& asyncStruct : _asyncStructQueue)
+    {
+        if (asyncStruct->callbackKey == callbackKey)
+        {
+            cancelImageAsync(asyncStruct);
+        }
+    }
+    // decoded images waiting for the upload budget, the front one may be uploaded by bands
+    for (auto& asyncStruct : _loadedAsyncStructs)
     {
         if (asyncStruct->callbackKey == callbackKey)
         {
@@ -238,12 +317,11 @@ void TextureCache::unbindImageAsync(const std::string& callbackKey)
 
 void TextureCache::unbindAllImageAsync()
 {
-    if (_asyncStructQueue.empty())
+    for (auto& asyncStruct : _asyncStructQueue)
     {
-        return;
-
+        cancelImageAsync(asyncStruct);
     }
-    for (auto& asyncStruct : _asyncStructQueue)
+    for (auto& asyncStruct : _loadedAsyncStructs)
     {
         asyncStruct->callback = nullptr;
     }
@@ -255,15 +333,20 @@ void TextureCache::loadImage()
     while (!_needQuit)
     {
         std::unique_lock<std::mutex> ul(_requestMutex);
-        // pop an AsyncStruct from request queue
-        if (_requestQueue.empty())
+        // pop an AsyncStruct from request queue, the prefetched images wait for the others
+        if (!_requestQueue.empty())
         {
-            asyncStruct = nullptr;
+            asyncStruct = _requestQueue.front();
+            _requestQueue.pop_front();
+        }
+        else if (!_prefetchRequestQueue.empty())
+        {
+            asyncStruct = _prefetchRequestQueue.front();
+            _prefetchRequestQueue.pop_front();
         }
         else
         {
-            asyncStruct = _requestQueue.front();
-            _requestQueue.pop_front();
+            asyncStruct = nullptr;
         }
 
         if (nullptr == asyncStruct) {
@@ -285,82 +368,114 @@ void TextureCache::loadImage()
             if (FileUtils::getInstance()->isFileExist(alphaFile))
                 asyncStruct->imageAlpha.initWithImageFileThreadSafe(alphaFile);
         }
-        // push the asyncStruct to response queue
-        _responseMutex.lock();
-        _responseQueue.push_back(asyncStruct);
-        _responseMutex.unlock();
+        // hand the asyncStruct back to the GL thread
+        asyncStruct->loaded.store(true, std::memory_order_release);
     }
 }
 
 void TextureCache::addImageAsyncCallBack(float /*dt*/)
 {
-    Texture2D *texture = nullptr;
-    AsyncStruct *asyncStruct = nullptr;
-    while (true)
+    // the images are decoded out of order by the loading threads, keep the order of the requests of each priority
+    bool waiting[2] = { false, false };
+    for (auto iter = _asyncStructQueue.begin(); iter != _asyncStructQueue.end() && !(waiting[0] && waiting[1]);)
     {
-        // pop an AsyncStruct from response queue
-        _responseMutex.lock();
-        if (_responseQueue.empty())
+        AsyncStruct *asyncStruct = *iter;
+        bool& priorityWaiting = waiting[static_cast<int>(asyncStruct->priority)];
+        if (!priorityWaiting && asyncStruct->loaded.load(std::memory_order_acquire))
         {
-            asyncStruct = nullptr;
+            _loadedAsyncStructs.push_back(asyncStruct);
+            iter = _asyncStructQueue.erase(iter);
         }
         else
         {
-            asyncStruct = _responseQueue.front();
-            _responseQueue.pop_front();
-
-            // the asyncStruct's sequence order in _asyncStructQueue must equal to the order in _responseQueue
-            CC_ASSERT(asyncStruct == _asyncStructQueue.front());
-            _asyncStructQueue.pop_front();
-        }
-        _responseMutex.unlock();
-
-        if (nullptr == asyncStruct) {
-            break;
+            priorityWaiting = true;
+            ++iter;
         }
+    }
 
-        // check the image has been convert to texture or not
-        auto it = _textures.find(asyncStruct->filename);
-        if (it != _textures.end())
+    // create the textures within the budget of the frame
+    const bool budgeted = _uploadBytesPerFrame > 0 || _uploadMillisecondsPerFrame > 0;
+    const auto frameStart = std::chrono::steady_clock::now();
+    size_t uploadedBytes = 0;
+    bool uploaded = false;
+    while (!_loadedAsyncStructs.empty())
+    {
+        if (budgeted && uploaded)
         {
-            texture = it->second;
+            if (_uploadBytesPerFrame > 0 && uploadedBytes >= _uploadBytesPerFrame)
+                break;
+            if (_uploadMillisecondsPerFrame > 0
+                && std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - frameStart).count() >= _uploadMillisecondsPerFrame)
+                break;
         }
-        else
+        // the bytes which can still be uploaded in this frame
+        size_t bandBytes = DEFAULT_UPLOAD_BAND_BYTES;
+        if (_uploadBytesPerFrame > 0)
+            bandBytes = _uploadBytesPerFrame > uploadedBytes ? _uploadBytesPerFrame - uploadedBytes : 0;
+
+        AsyncStruct *asyncStruct = _loadedAsyncStructs.front();
+        Image* image = &(asyncStruct->image);
+        Texture2D *texture = nullptr;
+        if (asyncStruct->uploadingTexture == nullptr)
         {
-            // convert image to texture
-            if (asyncStruct->loadSuccess)
+            // check the image has been convert to texture or not
+            auto it = _textures.find(asyncStruct->filename);
+            if (it != _textures.end())
             {
-                Image* image = &(asyncStruct->image);
-                // generate texture in render thread
-                texture = new (std::nothrow) Texture2D();
-
-                texture->initWithImage(image, asyncStruct->pixelFormat);
-                //parse 9-patch info
-                this->parseNinePatchImage(image, texture, asyncStruct->filename);
-#if CC_ENABLE_CACHE_TEXTURE_DATA
-                // cache the texture file name
-                VolatileTextureMgr::addImageTexture(texture, asyncStruct->filename);
-#endif
-                // cache the texture. retain it, since it is added in the map
-                _textures.emplace(asyncStruct->filename, texture);
-                texture->retain();
-
-                texture->autorelease();
-                // ETC1 ALPHA supports.
-                if (asyncStruct->imageAlpha.getFileType() == Image::Format::ETC) {
-                    auto alphaTexture = new(std::nothrow) Texture2D();
-                    if(alphaTexture != nullptr && alphaTexture->initWithImage(&asyncStruct->imageAlpha, asyncStruct->pixelFormat)) {
-                        texture->setAlphaTexture(alphaTexture);
-                    }
-                    CC_SAFE_RELEASE(alphaTexture);
-                }
+                texture = it->second;
             }
-            else {
+            else if (asyncStruct->cancelled)
+            {
+                texture = nullptr;
+            }
+            else if (!asyncStruct->loadSuccess)
+            {
                 texture = nullptr;
                 CCLOG("cocos2d: failed to call TextureCache::addImageAsync(%s)", asyncStruct->filename.c_str());
             }
+            else
+            {
+                // generate texture in render thread
+                texture = new (std::nothrow) Texture2D();
+                if (budgeted && (size_t)image->getDataLen() > bandBytes && texture->allocateForImage(image, asyncStruct->pixelFormat))
+                {
+                    // too big for this frame, upload it by bands
+                    asyncStruct->uploadingTexture = texture;
+                    texture = nullptr;
+                }
+                else
+                {
+                    // convert image to texture
+                    texture->initWithImage(image, asyncStruct->pixelFormat);
+                    texture = cacheAsyncTexture(asyncStruct, texture);
+                    uploadedBytes += image->getDataLen();
+                    uploaded = true;
+                }
+            }
         }
 
+        if (asyncStruct->uploadingTexture)
+        {
+            const int height = image->getHeight();
+            const size_t rowBytes = std::max((size_t)image->getDataLen() / height, (size_t)1);
+            const int rowCount = std::min(std::max((int)(bandBytes / rowBytes), 1), height - asyncStruct->uploadedRows);
+            asyncStruct->uploadingTexture->updateWithImageRows(image, asyncStruct->uploadedRows, rowCount);
+            asyncStruct->uploadedRows += rowCount;
+            uploadedBytes += rowBytes * rowCount;
+            uploaded = true;
+            if (asyncStruct->uploadedRows < height)
+                continue;
+
+            texture = cacheAsyncTexture(asyncStruct, asyncStruct->uploadingTexture);
+            asyncStruct->uploadingTexture = nullptr;
+        }
+
+        // the callbacks may request more images, which are queued in _asyncStructQueue
+        _loadedAsyncStructs.pop_front();
+
+        if (texture)
+            touchTexture(texture);
+
         // call callback function
         if (asyncStruct->callback)
         {
@@ -378,6 +493,39 @@ void TextureCache::addImageAsyncCallBack(float /*dt*/)
     }
 }
 
+Texture2D* TextureCache::cacheAsyncTexture(AsyncStruct* asyncStruct, Texture2D* texture)
+{
+    // added by addImage while it was uploaded
+    auto it = _textures.find(asyncStruct->filename);
+    if (it != _textures.end())
+    {
+        texture->release();
+        return it->second;
+    }
+
+    Image* image = &(asyncStruct->image);
+    //parse 9-patch info
+    this->parseNinePatchImage(image, texture, asyncStruct->filename);
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    // cache the texture file name
+    VolatileTextureMgr::addImageTexture(texture, asyncStruct->filename);
+#endif
+    // cache the texture. retain it, since it is added in the map
+    _textures.emplace(asyncStruct->filename, texture);
+    texture->retain();
+
+    texture->autorelease();
+    // ETC1 ALPHA supports.
+    if (asyncStruct->imageAlpha.getFileType() == Image::Format::ETC) {
+        auto alphaTexture = new(std::nothrow) Texture2D();
+        if(alphaTexture != nullptr && alphaTexture->initWithImage(&asyncStruct->imageAlpha, asyncStruct->pixelFormat)) {
+            texture->setAlphaTexture(alphaTexture);
+        }
+        CC_SAFE_RELEASE(alphaTexture);
+    }
+    return texture;
+}
+
 Texture2D * TextureCache::addImage(const std::string &path)
 {
     Texture2D * texture = nullptr;
@@ -447,6 +595,9 @@ Texture2D * TextureCache::addImage(const std::string &path)
 
     CC_SAFE_RELEASE(image);
 
+    if (texture)
+        touchTexture(texture);
+
     return texture;
 }
 
@@ -502,6 +653,9 @@ Texture2D* TextureCache::addImage(Image *image, const std::string &key)
     VolatileTextureMgr::addImage(texture, image);
 #endif
 
+    if (texture)
+        touchTexture(texture);
+
     return texture;
 }
 
@@ -616,10 +770,107 @@ Texture2D* TextureCache::getTextureForKey(const std::string &textureKeyName) con
     }
 
     if (it != _textures.end())
+    {
+        touchTexture(it->second);
         return it->second;
+    }
     return nullptr;
 }
 
+// TextureCache - Memory budget
+
+void TextureCache::setTextureMemoryBudget(size_t bytes)
+{
+    auto scheduler = Director::getInstance()->getScheduler();
+    if (bytes > 0 && _textureMemoryBudget == 0)
+        scheduler->schedule(CC_SCHEDULE_SELECTOR(TextureCache::updateTextureMemoryBudget), this, 0, false);
+    else if (bytes == 0 && _textureMemoryBudget > 0)
+        scheduler->unschedule(CC_SCHEDULE_SELECTOR(TextureCache::updateTextureMemoryBudget), this);
+
+    _textureMemoryBudget = bytes;
+    if (bytes > 0)
+        updateTextureMemoryBudget(0);
+}
+
+void TextureCache::updateTextureMemoryBudget(float /*dt*/)
+{
+    const unsigned int frame = Director::getInstance()->getTotalFrames();
+
+    typedef std::unordered_map<std::string, Texture2D*>::const_iterator TextureIterator;
+    std::vector<TextureIterator> unused;
+    size_t residentBytes = 0;
+    for (auto it = _textures.cbegin(); it != _textures.cend(); ++it)
+    {
+        Texture2D* tex = it->second;
+        residentBytes += getTextureBytes(tex);
+        // retained by sprites, sprite frames..., it may be drawn in this frame
+        if (tex->getReferenceCount() > 1)
+            tex->_lastUsedFrame = frame;
+        else if (tex->_lastUsedFrame != frame)
+            unused.push_back(it);
+    }
+
+    if (residentBytes <= _textureMemoryBudget)
+        return;
+
+    // least recently used first
+    std::sort(unused.begin(), unused.end(), [](const TextureIterator& a, const TextureIterator& b) {
+        return a->second->_lastUsedFrame < b->second->_lastUsedFrame;
+    });
+
+    for (auto& it : unused)
+    {
+        if (residentBytes <= _textureMemoryBudget)
+            break;
+
+        Texture2D* tex = it->second;
+        const size_t bytes = getTextureBytes(tex);
+        CCLOG("cocos2d: TextureCache: evicting texture: %s, unused for %u frames", it->first.c_str(), frame - tex->_lastUsedFrame);
+
+        tex->release();
+        _textures.erase(it);
+        residentBytes -= bytes;
+    }
+
+    if (residentBytes > _textureMemoryBudget)
+    {
+        CCLOG("cocos2d: TextureCache: %.2f MB of textures in use, over the budget of %.2f MB",
+            residentBytes / (1024.0f*1024.0f), _textureMemoryBudget / (1024.0f*1024.0f));
+    }
+}
+
+void TextureCache::touchTexture(Texture2D* texture) const
+{
+    texture->_lastUsedFrame = Director::getInstance()->getTotalFrames();
+}
+
+size_t TextureCache::getTextureBytes(Texture2D* texture)
+{
+    size_t bytes = (size_t)texture->getPixelsWide() * texture->getPixelsHigh() * texture->getBitsPerPixelForFormat() / 8;
+    // the mipmaps take a third more
+    if (texture->hasMipmaps())
+        bytes += bytes / 3;
+    if (texture->getAlphaTexture())
+        bytes += getTextureBytes(texture->getAlphaTexture());
+    return bytes;
+}
+
+size_t TextureCache::getResidentTextureBytes() const
+{
+    size_t bytes = 0;
+    for (auto& texture : _textures)
+        bytes += getTextureBytes(texture.second);
+    return bytes;
+}
+
+std::map<backend::PixelFormat, size_t> TextureCache::getResidentTextureBytesByPixelFormat() const
+{
+    std::map<backend::PixelFormat, size_t> bytesByFormat;
+    for (auto& texture : _textures)
+        bytesByFormat[texture.second->getPixelFormat()] += getTextureBytes(texture.second);
+    return bytesByFormat;
+}
+
 std::string TextureCache::getTextureFilePath(cocos2d::Texture2D* texture) const
 {
     for (auto& item : _textures)
@@ -638,9 +889,12 @@ void TextureCache::waitForQuit()
     // notify sub thread to quick
     std::unique_lock<std::mutex> ul(_requestMutex);
     _needQuit = true;
-    _sleepCondition.notify_one();
+    _sleepCondition.notify_all();
     ul.unlock();
-    if (_loadingThread) _loadingThread->join();
+    for (auto thread : _loadingThreads)
+    {
+        if (thread->joinable()) thread->join();
+    }
 }
 
 std::string TextureCache::getCachedTextureInfo() const
@@ -650,6 +904,7 @@ std::string TextureCache::getCachedTextureInfo() const
 
     unsigned int count = 0;
     unsigned int totalBytes = 0;
+    std::map<std::string, size_t> bytesByFormat;
 
     for (auto& texture : _textures) {
 
@@ -662,6 +917,8 @@ std::string TextureCache::getCachedTextureInfo() const
         auto bytes = tex->getPixelsWide() * tex->getPixelsHigh() * bpp / 8;
         totalBytes += bytes;
         count++;
+        const char* format = tex->getStringForFormat();
+        bytesByFormat[format ? format : "UNKNOWN"] += getTextureBytes(tex);
         snprintf(buftmp, sizeof(buftmp) - 1, "\"%s\" rc=%lu id=%p %lu x %lu @ %ld bpp => %lu KB\n",
             texture.first.c_str(),
             (long)tex->getReferenceCount(),
@@ -677,6 +934,18 @@ std::string TextureCache::getCachedTextureInfo() const
     snprintf(buftmp, sizeof(buftmp) - 1, "TextureCache dumpDebugInfo: %ld textures, for %lu KB (%.2f MB)\n", (long)count, (long)totalBytes / 1024, totalBytes / (1024.0f*1024.0f));
     buffer += buftmp;
 
+    // resident bytes, including the mipmaps and ETC alpha textures
+    for (auto& format : bytesByFormat)
+    {
+        snprintf(buftmp, sizeof(buftmp) - 1, "    %s: %lu KB\n", format.first.c_str(), (unsigned long)(format.second / 1024));
+        buffer += buftmp;
+    }
+    if (_textureMemoryBudget > 0)
+    {
+        snprintf(buftmp, sizeof(buftmp) - 1, "TextureCache budget: %lu KB\n", (unsigned long)(_textureMemoryBudget / 1024));
+        buffer += buftmp;
+    }
+
     return buffer;
 }
 
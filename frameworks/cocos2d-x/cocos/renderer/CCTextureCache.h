@@ -33,8 +33,10 @@ THE SOFTWARE.
 #include <thread>
 #include <condition_variable>
 #include <queue>
+#include <vector>
 #include <string>
 #include <unordered_map>
+#include <map>
 #include <functional>
 
 #include "base/CCRef.h"
@@ -68,6 +70,13 @@ public:
     static std::string getETC1AlphaFileSuffix();
 
 public:
+    /** Priority of an asynchronous image load. */
+    enum class AsyncPriority
+    {
+        HIGH,   ///< The image is needed now, e.g. by a visible node.
+        LOW,    ///< The image is prefetched, it is decoded when no image of high priority is waiting.
+    };
+
     /**
      * @js ctor
      */
@@ -107,9 +116,45 @@ public:
     
     void addImageAsync(const std::string &path, const std::function<void(Texture2D*)>& callback, const std::string& callbackKey );
 
+    /** Loads an image in a thread of the loading pool like addImageAsync, with a priority.
+    * The callbacks of the requests of a priority are called in the order of the requests.
+     @param path The file path.
+     @param callback A callback function would be invoked after the image is loaded.
+     @param callbackKey The key to unbind the callback with unbindImageAsync.
+     @param priority Images of high priority are decoded before the prefetched ones.
+    */
+    void addImageAsync(const std::string &path, const std::function<void(Texture2D*)>& callback, const std::string& callbackKey, AsyncPriority priority);
+
+    /** Sets the number of threads decoding the images of addImageAsync.
+    * The threads are started by the first asynchronous load and run until the cache is destroyed,
+    * a higher count starts more threads at once while a lower count only applies if set before the first load.
+    * The default is the number of cores minus one for the main thread, between 1 and 4.
+     @param count The number of threads, at least 1.
+    */
+    void setAsyncLoadingThreadCount(unsigned int count);
+
+    /** Gets the number of threads decoding the images of addImageAsync. */
+    unsigned int getAsyncLoadingThreadCount() const { return _loadingThreadCount; }
+
+    /** Sets how much of a frame is spent creating the textures of addImageAsync.
+    * Once the budget of a frame is spent the next decoded images wait for the next frame, big images are uploaded by bands
+    * of rows over several frames. At least one image or band is uploaded each frame. Disabled by default, all the decoded
+    * images of a frame are uploaded at once.
+     @param bytesPerFrame The number of bytes of image data uploaded per frame, 0 for no limit.
+     @param millisecondsPerFrame The time spent uploading per frame, 0 for no limit.
+    */
+    void setAsyncUploadBudget(unsigned int bytesPerFrame, float millisecondsPerFrame = 0);
+
+    /** Gets the number of bytes of image data uploaded per frame by addImageAsync, 0 for no limit. */
+    unsigned int getAsyncUploadBytesPerFrame() const { return _uploadBytesPerFrame; }
+
+    /** Gets the time spent uploading the images of addImageAsync per frame, 0 for no limit. */
+    float getAsyncUploadMillisecondsPerFrame() const { return _uploadMillisecondsPerFrame; }
+
     /** Unbind a specified bound image asynchronous callback.
      * In the case an object who was bound to an image asynchronous callback was destroyed before the callback is invoked,
      * the object always need to unbind this callback manually.
+     * Requests which aren't being decoded yet are cancelled.
      * @param filename It's the related/absolute path of the file image.
      * @since v3.1
      */
@@ -174,6 +219,24 @@ public:
     */
     std::string getCachedTextureInfo() const;
 
+    /** Sets the memory budget of the cached textures.
+    * Once the textures take more memory, the textures only retained by the cache are removed, the least recently
+    * used first, until they fit again. A texture is used in a frame when it is looked up with addImage, addImageAsync
+    * or getTextureForKey, or while anything else retains it. The textures used in the current frame are kept.
+    * The budget is checked every frame, it is disabled by default.
+     @param bytes The budget in bytes, 0 to disable it.
+    */
+    void setTextureMemoryBudget(size_t bytes);
+
+    /** Gets the memory budget of the cached textures, 0 when it is disabled. */
+    size_t getTextureMemoryBudget() const { return _textureMemoryBudget; }
+
+    /** Gets the memory taken by the cached textures, estimated from their size and pixel format. */
+    size_t getResidentTextureBytes() const;
+
+    /** Gets the memory taken by the cached textures for each pixel format. */
+    std::map<backend::PixelFormat, size_t> getResidentTextureBytesByPixelFormat() const;
+
     //Wait for texture cache to quit before destroy instance.
     /**Called by director, please do not called outside.*/
     void waitForQuit();
@@ -202,18 +265,29 @@ private:
     void addImageAsyncCallBack(float dt);
     void loadImage();
     void parseNinePatchImage(Image* image, Texture2D* texture, const std::string& path);
+    void updateTextureMemoryBudget(float dt);
+    void touchTexture(Texture2D* texture) const;
+    static size_t getTextureBytes(Texture2D* texture);
 public:
 protected:
     struct AsyncStruct;
+
+    void startLoadingThreads();
+    void cancelImageAsync(AsyncStruct* asyncStruct);
+    Texture2D* cacheAsyncTexture(AsyncStruct* asyncStruct, Texture2D* texture);
     
-    std::thread* _loadingThread;
+    std::vector<std::thread*> _loadingThreads;
+    unsigned int _loadingThreadCount;
 
     std::deque<AsyncStruct*> _asyncStructQueue;
     std::deque<AsyncStruct*> _requestQueue;
-    std::deque<AsyncStruct*> _responseQueue;
+    std::deque<AsyncStruct*> _prefetchRequestQueue;
+    std::deque<AsyncStruct*> _loadedAsyncStructs;
+    unsigned int _uploadBytesPerFrame;
+    float _uploadMillisecondsPerFrame;
+    size_t _textureMemoryBudget;
 
     std::mutex _requestMutex;
-    std::mutex _responseMutex;
     
     std::condition_variable _sleepCondition;
 
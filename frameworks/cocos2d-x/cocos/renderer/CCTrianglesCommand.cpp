@@ -101,6 +101,16 @@ void TrianglesCommand::generateMaterialID()
     hashMe.dst = _blendType.dst;
     hashMe.programType = _programType;
     _materialID = XXH32((const void*)&hashMe, sizeof(hashMe), 0);
+
+    // Only the default sprite program has a variant sampling several textures.
+    _multiTextureMaterialID = 0;
+    if (_programType == backend::ProgramType::POSITION_TEXTURE_COLOR)
+    {
+        hashMe.texture = nullptr;
+        _multiTextureMaterialID = XXH32((const void*)&hashMe, sizeof(hashMe), 0);
+        if (_multiTextureMaterialID == 0)
+            _multiTextureMaterialID = 1;
+    }
 }
 
 NS_CC_END
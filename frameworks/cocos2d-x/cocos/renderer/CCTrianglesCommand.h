@@ -86,6 +86,13 @@ public:
     void init(float globalOrder, cocos2d::Texture2D* texture, const BlendFunc& blendType,  const Triangles& triangles, const Mat4& mv, uint32_t flags);
     /**Get the material id of command.*/
     uint32_t getMaterialID() const { return _materialID; }
+    /**
+     Get the material id of command without the texture, used to batch commands using different textures.
+     @return 0 if the command can't be batched with commands using other textures.
+     */
+    uint32_t getMultiTextureMaterialID() const { return _multiTextureMaterialID; }
+    /**Get the texture of the command.*/
+    backend::TextureBackend* getTexture() const { return _texture; }
     /**Get a const reference of triangles.*/
     const Triangles& getTriangles() const { return _triangles; }
     /**Get the vertex count in the triangles.*/
@@ -108,6 +115,8 @@ protected:
     
     /**Generated material id.*/
     uint32_t _materialID = 0;
+    /**Generated material id without the texture.*/
+    uint32_t _multiTextureMaterialID = 0;
 
     /**Rendered triangles.*/
     Triangles _triangles;
@@ -184,8 +184,17 @@ public:
      */
     void setStencilReferenceValue(unsigned int frontRef, unsigned int backRef);
 
+    /**
+     * Get the index of the current frame in the ring of MAX_INFLIGHT_BUFFER frames in flight, advanced by endFrame().
+     * Resources written every frame are kept per frame index, so they are not written while the GPU reads them.
+     * @return The index of the current frame, less than MAX_INFLIGHT_BUFFER.
+     */
+    unsigned int getFrameIndex() const { return _frameIndex; }
+
 protected:
     virtual ~CommandBuffer() = default;
+
+    unsigned int _frameIndex = 0; ///< index of the current frame in the ring of frames in flight.
     
     unsigned int _stencilReferenceValueFront = 0; ///< front stencil reference value.
     unsigned int _stencilReferenceValueBack = 0; ///< back stencil reference value.
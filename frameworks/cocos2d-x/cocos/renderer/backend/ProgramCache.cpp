@@ -240,6 +240,12 @@ void ProgramCache::addProgram(ProgramType type)
         case ProgramType::PARTICLE_COLOR_3D:
             program = backend::Device::getInstance()->newProgram(CC3D_particle_vert, CC3D_particleColor_frag);
             break;
+        case ProgramType::POSITION_TEXTURE_COLOR_MULTI:
+            {
+                std::string def = "\n#define MULTI_TEXTURE 1\n";
+                program = backend::Device::getInstance()->newProgram(def + positionTextureColor_vert, def + positionTextureColor_frag);
+            }
+            break;
         default:
             CCASSERT(false, "Not built-in program type.");
             break;
@@ -248,13 +254,21 @@ void ProgramCache::addProgram(ProgramType type)
     ProgramCache::_cachedPrograms.emplace(type, program);
 }
 
-backend::Program* ProgramCache::getBuiltinProgram(ProgramType type) const
+backend::Program* ProgramCache::getBuiltinProgram(ProgramType type)
 {
     const auto& iter = ProgramCache::_cachedPrograms.find(type);
     if (ProgramCache::_cachedPrograms.end() != iter)
     {
         return iter->second;
     }
+#ifndef CC_USE_METAL
+    // Only used by multi-texture batching, so it is compiled on first use rather than in init().
+    if (ProgramType::POSITION_TEXTURE_COLOR_MULTI == type)
+    {
+        addProgram(type);
+        return ProgramCache::_cachedPrograms[type];
+    }
+#endif
     return nullptr;
 }
 
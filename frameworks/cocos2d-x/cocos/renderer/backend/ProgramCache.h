@@ -50,8 +50,8 @@ public:
     /** purges the cache. It releases the retained instance. */
     static void destroyInstance();
     
-    /// get built-in program
-    backend::Program* getBuiltinProgram(ProgramType type) const;
+    /// get built-in program, the multi-texture program is compiled on first request
+    backend::Program* getBuiltinProgram(ProgramType type);
     
     /**
      * Remove a program object from cache.
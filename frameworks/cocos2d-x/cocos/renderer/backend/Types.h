@@ -34,7 +34,8 @@ CC_BACKEND_BEGIN
 enum class BufferUsage : uint32_t
 {
     STATIC,
-    DYNAMIC
+    DYNAMIC,
+    STREAM ///< Dynamic data, each region is written once per frame and not rewritten while the GPU may still read it.
 };
 
 enum class BufferType : uint32_t
@@ -362,6 +363,8 @@ enum class ProgramType : size_t
     PARTICLE_TEXTURE_3D,                    //CC3D_particle_vert,                   CC3D_particleTexture_frag
     PARTICLE_COLOR_3D,                      //CC3D_particle_vert,                   CC3D_particleColor_frag
 
+    POSITION_TEXTURE_COLOR_MULTI,           //positionTextureColor_vert,    positionTextureColor_frag with MULTI_TEXTURE defined
+
     CUSTOM_PROGRAM,                         //user-define program
 };
 
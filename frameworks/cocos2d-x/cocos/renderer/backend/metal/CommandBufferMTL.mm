@@ -372,6 +372,7 @@ void CommandBufferMTL::endFrame()
     [_mtlCommandBuffer release];
     DeviceMTL::resetCurrentDrawable();
     [_autoReleasePool drain];
+    _frameIndex = (_frameIndex + 1) % MAX_INFLIGHT_BUFFER;
 }
 
 void CommandBufferMTL::afterDraw()
@@ -84,7 +84,7 @@ public:
      * New a Buffer object.
      * @param size Specifies the size in bytes of the buffer object's new data store.
      * @param type Specifies the target buffer object. The symbolic constant must be BufferType::VERTEX or BufferType::INDEX.
-     * @param usage Specifies the expected usage pattern of the data store. The symbolic constant must be BufferUsage::STATIC, BufferUsage::DYNAMIC.
+     * @param usage Specifies the expected usage pattern of the data store. The symbolic constant must be BufferUsage::STATIC, BufferUsage::DYNAMIC or BufferUsage::STREAM.
      * @return A Buffer object.
      */
     virtual Buffer* newBuffer(std::size_t size, BufferType type, BufferUsage usage) override;
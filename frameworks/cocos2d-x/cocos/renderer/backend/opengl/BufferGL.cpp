@@ -24,10 +24,14 @@
  
 #include "BufferGL.h"
 #include <cassert>
+#include <algorithm>
 #include "base/ccMacros.h"
 #include "base/CCDirector.h"
 #include "base/CCEventType.h"
 #include "base/CCEventDispatcher.h"
+#include "renderer/backend/opengl/UtilsGL.h"
+#include "renderer/backend/opengl/StateCacheGL.h"
+#include "renderer/backend/opengl/RenderThreadGL.h"
 
 CC_BACKEND_BEGIN
 
@@ -40,6 +44,8 @@ namespace {
                 return GL_STATIC_DRAW;
             case BufferUsage::DYNAMIC:
                 return GL_DYNAMIC_DRAW;
+            case BufferUsage::STREAM:
+                return GL_STREAM_DRAW;
             default:
                 return GL_DYNAMIC_DRAW;
         }
@@ -49,7 +55,9 @@ namespace {
 BufferGL::BufferGL(std::size_t size, BufferType type, BufferUsage usage)
 : Buffer(size, type, usage)
 {
-    glGenBuffers(1, &_buffer);
+    RenderThreadGL::run(this, [this]() {
+        glGenBuffers(1, &_buffer);
+    });
 
 #if CC_ENABLE_CACHE_TEXTURE_DATA
     _backToForegroundListener = EventListenerCustom::create(EVENT_RENDERER_RECREATED, [this](EventCustom*){
@@ -61,8 +69,17 @@ BufferGL::BufferGL(std::size_t size, BufferType type, BufferUsage usage)
 
 BufferGL::~BufferGL()
 {
-    if (_buffer)
-        glDeleteBuffers(1, &_buffer);
+    // Recorded jobs retain the buffer, so they have all been executed when it is destroyed.
+    std::vector<GLuint> vertexArrays;
+    for (const auto& vertexArray : _vertexArrays)
+        vertexArrays.push_back(vertexArray.handle);
+    GLuint buffer = _buffer;
+    RenderThreadGL::run(nullptr, [vertexArrays, buffer]() {
+        for (auto vertexArray : vertexArrays)
+            StateCacheGL::deleteVertexArray(vertexArray);
+        if (buffer)
+            StateCacheGL::deleteBuffer(buffer);
+    });
 
 #if CC_ENABLE_CACHE_TEXTURE_DATA
     CC_SAFE_DELETE_ARRAY(_data);
@@ -80,6 +97,8 @@ void BufferGL::usingDefaultStoredData(bool needDefaultStoredData)
 #if CC_ENABLE_CACHE_TEXTURE_DATA
 void BufferGL::reloadBuffer()
 {
+    // Vertex arrays of the lost context are gone, they are created again when needed.
+    _vertexArrays.clear();
     glGenBuffers(1, &_buffer);
 
     if(!_needDefaultStoredData)
@@ -108,25 +127,27 @@ void BufferGL::updateData(void* data, std::size_t size)
 {
     assert(size && size <= _size);
     
-    if (_buffer)
-    {
+    RenderThreadGL::run(this, data, size, [this, size](const void* data) {
+        if (!_buffer)
+            return;
+
         if (BufferType::VERTEX == _type)
         {
-            glBindBuffer(GL_ARRAY_BUFFER, _buffer);
+            StateCacheGL::bindBuffer(GL_ARRAY_BUFFER, _buffer);
             glBufferData(GL_ARRAY_BUFFER, size, data, toGLUsage(_usage));
         }
         else
         {
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffer);
+            StateCacheGL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffer);
             glBufferData(GL_ELEMENT_ARRAY_BUFFER, size, data, toGLUsage(_usage));
         }
         CHECK_GL_ERROR_DEBUG();
-        _bufferAllocated = size;
+    });
+    _bufferAllocated = size;
 
 #if CC_ENABLE_CACHE_TEXTURE_DATA
-        fillBuffer(data, 0, size);
+    fillBuffer(data, 0, size);
 #endif
-    }
 }
 
 void BufferGL::updateSubData(void* data, std::size_t offset, std::size_t size)
@@ -135,25 +156,118 @@ void BufferGL::updateSubData(void* data, std::size_t offset, std::size_t size)
     CCASSERT(_bufferAllocated != 0, "updateData should be invoke before updateSubData");
     CCASSERT(offset + size <= _bufferAllocated, "buffer size overflow");
  
-    if (_buffer)
-    {
+    RenderThreadGL::run(this, data, size, [this, offset, size](const void* data) {
+        if (!_buffer)
+            return;
+
         CHECK_GL_ERROR_DEBUG();
-        if (BufferType::VERTEX == _type)
-        {
-            glBindBuffer(GL_ARRAY_BUFFER, _buffer);
-            glBufferSubData(GL_ARRAY_BUFFER, offset, size, data);
-        }
-        else
+        GLenum target = BufferType::VERTEX == _type ? GL_ARRAY_BUFFER : GL_ELEMENT_ARRAY_BUFFER;
+        StateCacheGL::bindBuffer(target, _buffer);
+        if (BufferUsage::STREAM != _usage || !mapSubData(target, data, offset, size))
         {
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffer);
-            glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, offset, size, data);
+            glBufferSubData(target, offset, size, data);
         }
+        CHECK_GL_ERROR_DEBUG();
+    });
 
 #if CC_ENABLE_CACHE_TEXTURE_DATA
-        fillBuffer(data, offset, size);
+    fillBuffer(data, offset, size);
 #endif
-        CHECK_GL_ERROR_DEBUG();
+}
+
+bool BufferGL::mapSubData(GLenum target, const void* data, std::size_t offset, std::size_t size)
+{
+#if CC_TARGET_PLATFORM == CC_PLATFORM_WIN32 || CC_TARGET_PLATFORM == CC_PLATFORM_LINUX
+    if (!UtilsGL::supportsStreamingBuffer())
+        return false;
+
+    // The region is not read by any frame in flight, so the driver doesn't need to synchronize or keep the old contents.
+    void* mapped = glMapBufferRange(target, offset, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    if (!mapped)
+        return false;
+
+    memcpy(mapped, data, size);
+    return glUnmapBuffer(target) == GL_TRUE;
+#else
+    return false;
+#endif
+}
+
+namespace
+{
+    std::size_t hashVertexLayout(const VertexLayout& vertexLayout)
+    {
+        // Order independent, attributes are stored in an unordered map.
+        std::size_t hash = vertexLayout.getStride();
+        for (const auto& iter : vertexLayout.getAttributes())
+        {
+            const auto& attribute = iter.second;
+            std::size_t value = attribute.index ^ ((std::size_t)attribute.format << 8) ^ ((std::size_t)attribute.needToBeNormallized << 15) ^ (attribute.offset << 16);
+            hash += value * 2654435761u;
+        }
+        return hash;
+    }
+}
+
+GLuint BufferGL::getVertexArray(const VertexLayout& vertexLayout)
+{
+    const auto& attributes = vertexLayout.getAttributes();
+    auto hash = hashVertexLayout(vertexLayout);
+    for (const auto& vertexArray : _vertexArrays)
+    {
+        if (vertexArray.hash != hash ||
+            vertexArray.stride != vertexLayout.getStride() ||
+            vertexArray.attributes.size() != attributes.size())
+            continue;
+
+        bool matched = true;
+        for (const auto& iter : attributes)
+        {
+            const auto& attribute = iter.second;
+            auto found = std::find_if(vertexArray.attributes.begin(), vertexArray.attributes.end(), [&attribute](const VertexArrayAttribute& stored) {
+                return stored.index == attribute.index &&
+                       stored.format == attribute.format &&
+                       stored.offset == attribute.offset &&
+                       stored.needToBeNormallized == attribute.needToBeNormallized;
+            });
+            if (found == vertexArray.attributes.end())
+            {
+                matched = false;
+                break;
+            }
+        }
+        if (matched)
+            return vertexArray.handle;
     }
+
+    return createVertexArray(vertexLayout, hash);
+}
+
+GLuint BufferGL::createVertexArray(const VertexLayout& vertexLayout, std::size_t hash)
+{
+    VertexArray vertexArray;
+    vertexArray.hash = hash;
+    vertexArray.stride = vertexLayout.getStride();
+    glGenVertexArrays(1, &vertexArray.handle);
+    StateCacheGL::bindVertexArray(vertexArray.handle);
+
+    for (const auto& iter : vertexLayout.getAttributes())
+    {
+        const auto& attribute = iter.second;
+        StateCacheGL::enableVertexAttribArray(attribute.index);
+        StateCacheGL::vertexAttribPointer(_buffer,
+            attribute.index,
+            UtilsGL::getGLAttributeSize(attribute.format),
+            UtilsGL::toGLAttributeType(attribute.format),
+            attribute.needToBeNormallized,
+            vertexLayout.getStride(),
+            attribute.offset);
+        vertexArray.attributes.push_back({attribute.index, attribute.format, attribute.offset, attribute.needToBeNormallized});
+    }
+    CHECK_GL_ERROR_DEBUG();
+
+    _vertexArrays.push_back(std::move(vertexArray));
+    return _vertexArrays.back().handle;
 }
 
 CC_BACKEND_END
@@ -25,6 +25,7 @@
 #pragma once
 
 #include "../Buffer.h"
+#include "../VertexLayout.h"
 #include "platform/CCGL.h"
 #include "base/CCEventListenerCustom.h"
 
@@ -45,7 +46,7 @@ public:
     /**
      * @param size Specifies the size in bytes of the buffer object's new data store.
      * @param type Specifies the target buffer object. The symbolic constant must be BufferType::VERTEX or BufferType::INDEX.
-     * @param usage Specifies the expected usage pattern of the data store. The symbolic constant must be BufferUsage::STATIC, BufferUsage::DYNAMIC.
+     * @param usage Specifies the expected usage pattern of the data store. The symbolic constant must be BufferUsage::STATIC, BufferUsage::DYNAMIC or BufferUsage::STREAM.
      */
     BufferGL(std::size_t size, BufferType type, BufferUsage usage);
     ~BufferGL();
@@ -80,7 +81,34 @@ public:
      */
     inline GLuint getHandler() const { return _buffer; }
 
+    /**
+     * Get the vertex array object sourcing the attributes of a vertex layout from this buffer, it is created on first use.
+     * The vertex arrays are owned by the buffer and deleted with it.
+     * @param vertexLayout Specifies the vertex layout.
+     * @return Vertex array object.
+     */
+    GLuint getVertexArray(const VertexLayout& vertexLayout);
+
 private:
+    struct VertexArrayAttribute
+    {
+        std::size_t index;
+        VertexFormat format;
+        std::size_t offset;
+        bool needToBeNormallized;
+    };
+
+    struct VertexArray
+    {
+        std::size_t hash;
+        std::size_t stride;
+        std::vector<VertexArrayAttribute> attributes;
+        GLuint handle;
+    };
+
+    bool mapSubData(GLenum target, const void* data, std::size_t offset, std::size_t size);
+    GLuint createVertexArray(const VertexLayout& vertexLayout, std::size_t hash);
+
 #if CC_ENABLE_CACHE_TEXTURE_DATA
     void reloadBuffer();
     void fillBuffer(void* data, std::size_t offset, std::size_t size);
@@ -93,6 +121,7 @@ private:
     std::size_t _bufferAllocated = 0;
     char* _data = nullptr;
     bool _needDefaultStoredData = true;
+    std::vector<VertexArray> _vertexArrays;
 };
 //end of _opengl group
 ///> @}
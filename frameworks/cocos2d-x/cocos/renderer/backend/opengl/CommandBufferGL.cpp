@@ -33,12 +33,19 @@
 #include "base/CCEventType.h"
 #include "base/CCDirector.h"
 #include "renderer/backend/opengl/UtilsGL.h"
+#include "renderer/backend/opengl/StateCacheGL.h"
+#include "renderer/backend/opengl/RenderThreadGL.h"
 #include <algorithm>
+#include <memory>
 
 CC_BACKEND_BEGIN
 
 namespace
 {
+#if CC_TARGET_PLATFORM == CC_PLATFORM_WIN32 || CC_TARGET_PLATFORM == CC_PLATFORM_LINUX
+    // A frame fence not signaled after a second means a stalled GPU, stop waiting for it.
+    const GLuint64 FRAME_FENCE_TIMEOUT = 1000000000;
+#endif
 
     GLuint getHandler(TextureBackend *texture)
     {
@@ -71,14 +78,18 @@ namespace
     }
 }
 
+// Jobs recorded by the command buffer don't retain it, it lives as long as the renderer which stops the render thread first.
 CommandBufferGL::CommandBufferGL()
 {
-    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &_defaultFBO);
+    RenderThreadGL::run(nullptr, [this]() {
+        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &_defaultFBO);
+    });
 
 #if CC_ENABLE_CACHE_TEXTURE_DATA
     _backToForegroundListener = EventListenerCustom::create(EVENT_RENDERER_RECREATED, [this](EventCustom*){
        if(_generatedFBO)
            glGenFramebuffers(1, &_generatedFBO); //recreate framebuffer
+       StateCacheGL::invalidate();
     });
     Director::getInstance()->getEventDispatcher()->addEventListenerWithFixedPriority(_backToForegroundListener, -1);
 #endif
@@ -91,6 +102,14 @@ CommandBufferGL::~CommandBufferGL()
 
     cleanResources();
 
+#if CC_TARGET_PLATFORM == CC_PLATFORM_WIN32 || CC_TARGET_PLATFORM == CC_PLATFORM_LINUX
+    for (auto& fence : _frameFences)
+    {
+        if (fence)
+            glDeleteSync(fence);
+    }
+#endif
+
 #if CC_ENABLE_CACHE_TEXTURE_DATA
     Director::getInstance()->getEventDispatcher()->removeEventListener(_backToForegroundListener);
 #endif
@@ -98,11 +117,41 @@ CommandBufferGL::~CommandBufferGL()
 
 void CommandBufferGL::beginFrame()
 {
+#if CC_TARGET_PLATFORM == CC_PLATFORM_WIN32 || CC_TARGET_PLATFORM == CC_PLATFORM_LINUX
+    // the index is advanced on this thread, the job uses the value of this frame
+    unsigned int frameIndex = _frameIndex;
+    RenderThreadGL::run(nullptr, [this, frameIndex]() {
+        // Wait until the GPU is done with the frame that used the same streaming buffers.
+        auto& fence = _frameFences[frameIndex];
+        if (fence)
+        {
+            GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FRAME_FENCE_TIMEOUT);
+            if (result == GL_TIMEOUT_EXPIRED || result == GL_WAIT_FAILED)
+            {
+                CCLOG("CommandBufferGL: waiting for the frame fence %s, finishing the GPU work",
+                      result == GL_WAIT_FAILED ? "failed" : "timed out");
+                glFinish();
+            }
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    });
+#endif
 }
 
 void CommandBufferGL::beginRenderPass(const RenderPassDescriptor& descirptor)
 {
-    applyRenderPassDescriptor(descirptor);
+    RenderThreadGL::retainUntilExecuted(descirptor.depthAttachmentTexture);
+    RenderThreadGL::retainUntilExecuted(descirptor.stencilAttachmentTexture);
+    for (const auto& texture : descirptor.colorAttachmentsTexture)
+        RenderThreadGL::retainUntilExecuted(texture);
+
+    // RenderPassDescriptor declares operator= but no copy constructor, copy it through operator=.
+    std::shared_ptr<RenderPassDescriptor> renderPass = std::make_shared<RenderPassDescriptor>();
+    *renderPass = descirptor;
+    RenderThreadGL::run(nullptr, [this, renderPass]() {
+        applyRenderPassDescriptor(*renderPass);
+    });
 }
 
 void CommandBufferGL::applyRenderPassDescriptor(const RenderPassDescriptor& descirptor)
@@ -265,9 +314,9 @@ void CommandBufferGL::applyRenderPassDescriptor(const RenderPassDescriptor& desc
         
         mask |= GL_DEPTH_BUFFER_BIT;
         glClearDepth(descirptor.clearDepthValue);
-        glEnable(GL_DEPTH_TEST);
-        glDepthMask(GL_TRUE);
-        glDepthFunc(GL_ALWAYS);
+        StateCacheGL::setEnabled(GL_DEPTH_TEST, true);
+        StateCacheGL::depthMask(GL_TRUE);
+        StateCacheGL::depthFunc(GL_ALWAYS);
     }
     
     CHECK_GL_ERROR_DEBUG();
@@ -286,10 +335,10 @@ void CommandBufferGL::applyRenderPassDescriptor(const RenderPassDescriptor& desc
     if (descirptor.needClearDepth)
     {
         if (!oldDepthTest)
-            glDisable(GL_DEPTH_TEST);
+            StateCacheGL::setEnabled(GL_DEPTH_TEST, false);
         
-        glDepthMask(oldDepthWrite);
-        glDepthFunc(oldDepthFunc);
+        StateCacheGL::depthMask(oldDepthWrite);
+        StateCacheGL::depthFunc(oldDepthFunc);
         glClearDepth(oldDepthClearValue);
     }
     
@@ -310,7 +359,9 @@ void CommandBufferGL::setRenderPipeline(RenderPipeline* renderPipeline)
 
 void CommandBufferGL::setViewport(int x, int y, unsigned int w, unsigned int h)
 {
-    glViewport(x, y, w, h);
+    RenderThreadGL::run(nullptr, [x, y, w, h]() {
+        glViewport(x, y, w, h);
+    });
     _viewPort.x = x;
     _viewPort.y = y;
     _viewPort.w = w;
@@ -324,7 +375,10 @@ void CommandBufferGL::setCullMode(CullMode mode)
 
 void CommandBufferGL::setWinding(Winding winding)
 {
-    glFrontFace(UtilsGL::toGLFrontFace(winding));
+    auto frontFace = UtilsGL::toGLFrontFace(winding);
+    RenderThreadGL::run(nullptr, [frontFace]() {
+        StateCacheGL::frontFace(frontFace);
+    });
 }
 
 void CommandBufferGL::setIndexBuffer(Buffer* buffer)
@@ -357,18 +411,24 @@ void CommandBufferGL::setProgramState(ProgramState* programState)
 
 void CommandBufferGL::drawArrays(PrimitiveType primitiveType, std::size_t start,  std::size_t count)
 {
-    prepareDrawing();
-    glDrawArrays(UtilsGL::toGLPrimitiveType(primitiveType), start, count);
+    auto state = captureDrawState();
+    RenderThreadGL::run(nullptr, [this, state, primitiveType, start, count]() {
+        prepareDrawing(state);
+        glDrawArrays(UtilsGL::toGLPrimitiveType(primitiveType), start, count);
+    });
     
     cleanResources();
 }
 
 void CommandBufferGL::drawElements(PrimitiveType primitiveType, IndexFormat indexType, std::size_t count, std::size_t offset)
 {
-    prepareDrawing();
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indexBuffer->getHandler());
-    glDrawElements(UtilsGL::toGLPrimitiveType(primitiveType), count, UtilsGL::toGLIndexType(indexType), (GLvoid*)offset);
-    CHECK_GL_ERROR_DEBUG();
+    auto state = captureDrawState();
+    RenderThreadGL::run(nullptr, [this, state, primitiveType, indexType, count, offset]() {
+        prepareDrawing(state);
+        StateCacheGL::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, state.indexBuffer->getHandler());
+        glDrawElements(UtilsGL::toGLPrimitiveType(primitiveType), count, UtilsGL::toGLIndexType(indexType), (GLvoid*)offset);
+        CHECK_GL_ERROR_DEBUG();
+    });
     cleanResources();
 }
 
@@ -378,6 +438,17 @@ void CommandBufferGL::endRenderPass()
 
 void CommandBufferGL::endFrame()
 {
+    unsigned int frameIndex = _frameIndex;
+    _frameIndex = (_frameIndex + 1) % MAX_INFLIGHT_BUFFER;
+    RenderThreadGL::run(nullptr, [this, frameIndex]() {
+#if CC_TARGET_PLATFORM == CC_PLATFORM_WIN32 || CC_TARGET_PLATFORM == CC_PLATFORM_LINUX
+        if (UtilsGL::supportsStreamingBuffer())
+            _frameFences[frameIndex] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+#else
+        CC_UNUSED_PARAM(frameIndex);
+#endif
+        StateCacheGL::endFrame();
+    });
 }
 
 void CommandBufferGL::setDepthStencilState(DepthStencilState* depthStencilState)	
@@ -392,75 +463,114 @@ void CommandBufferGL::setDepthStencilState(DepthStencilState* depthStencilState)
     }	
 }
 
-void CommandBufferGL::prepareDrawing() const
+CommandBufferGL::DrawState CommandBufferGL::captureDrawState() const
+{
+    DrawState state;
+    state.program = _renderPipeline->getProgram();
+    state.programState = _programState;
+    state.vertexBuffer = _vertexBuffer;
+    state.indexBuffer = _indexBuffer;
+    state.depthStencilState = _depthStencilStateGL;
+    state.stencilReferenceValueFront = _stencilReferenceValueFront;
+    state.stencilReferenceValueBack = _stencilReferenceValueBack;
+    state.cullMode = _cullMode;
+
+    if (RenderThreadGL::isRunning() && _programState)
+    {
+        // Uniform callbacks read the scene, so they are invoked now and the render thread gets a snapshot of the uniforms.
+        for (auto &cb : _programState->getCallbackUniforms())
+        {
+            cb.second(_programState, cb.first);
+        }
+        state.programState = _programState->clone();
+        RenderThreadGL::retainUntilExecuted(state.programState);
+        state.programState->release();
+    }
+
+    RenderThreadGL::retainUntilExecuted(state.program);
+    RenderThreadGL::retainUntilExecuted(state.vertexBuffer);
+    RenderThreadGL::retainUntilExecuted(state.indexBuffer);
+    RenderThreadGL::retainUntilExecuted(state.depthStencilState);
+    return state;
+}
+
+void CommandBufferGL::prepareDrawing(const DrawState& state) const
 {   
-    const auto& program = _renderPipeline->getProgram();
-    glUseProgram(program->getHandler());
+    const auto& program = state.program;
+    StateCacheGL::useProgram(program->getHandler());
     
-    bindVertexBuffer(program);
-    setUniforms(program);
+    bindVertexBuffer(state);
+    setUniforms(state);
 
     // Set depth/stencil state.
-    if (_depthStencilStateGL)
+    if (state.depthStencilState)
     {
-        _depthStencilStateGL->apply(_stencilReferenceValueFront, _stencilReferenceValueBack);
+        state.depthStencilState->apply(state.stencilReferenceValueFront, state.stencilReferenceValueBack);
     }
         
     else
         DepthStencilStateGL::reset();
     
     // Set cull mode.
-    if (CullMode::NONE == _cullMode)
+    if (CullMode::NONE == state.cullMode)
     {
-        glDisable(GL_CULL_FACE);
+        StateCacheGL::setEnabled(GL_CULL_FACE, false);
     }
     else
     {
-        glEnable(GL_CULL_FACE);
-        glCullFace(UtilsGL::toGLCullMode(_cullMode));
+        StateCacheGL::setEnabled(GL_CULL_FACE, true);
+        StateCacheGL::cullFace(UtilsGL::toGLCullMode(state.cullMode));
     }
 }
 
-void CommandBufferGL::bindVertexBuffer(ProgramGL *program) const
+void CommandBufferGL::bindVertexBuffer(const DrawState& state) const
 {
     // Bind vertex buffers and set the attributes.
-    auto vertexLayout = _programState->getVertexLayout();
+    auto vertexLayout = state.programState->getVertexLayout();
     
     if (!vertexLayout->isValid())
         return;
-    
-    glBindBuffer(GL_ARRAY_BUFFER, _vertexBuffer->getHandler());
 
+    // The vertex array object keeps the attribute states, binding it replaces specifying every attribute.
+    if (UtilsGL::supportsVertexArrayObject())
+    {
+        StateCacheGL::bindVertexArray(state.vertexBuffer->getVertexArray(*vertexLayout));
+        return;
+    }
+    
     const auto& attributes = vertexLayout->getAttributes();
     for (const auto& attributeInfo : attributes)
     {
         const auto& attribute = attributeInfo.second;
-        glEnableVertexAttribArray(attribute.index);
-        glVertexAttribPointer(attribute.index,
+        StateCacheGL::enableVertexAttribArray(attribute.index);
+        StateCacheGL::vertexAttribPointer(state.vertexBuffer->getHandler(),
+            attribute.index,
             UtilsGL::getGLAttributeSize(attribute.format),
             UtilsGL::toGLAttributeType(attribute.format),
             attribute.needToBeNormallized,
             vertexLayout->getStride(),
-            (GLvoid*)attribute.offset);
+            attribute.offset);
     }
 }
 
-void CommandBufferGL::setUniforms(ProgramGL* program) const
+void CommandBufferGL::setUniforms(const DrawState& state) const
 {
-    if (_programState)
+    auto program = state.program;
+    auto programState = state.programState;
+    if (programState)
     {
-        auto& callbacks = _programState->getCallbackUniforms();
-        auto& uniformInfos = _programState->getProgram()->getAllActiveUniformInfo(ShaderStage::VERTEX);
+        auto& callbacks = programState->getCallbackUniforms();
+        auto& uniformInfos = programState->getProgram()->getAllActiveUniformInfo(ShaderStage::VERTEX);
         std::size_t bufferSize = 0;
         char* buffer = nullptr;
-        _programState->getVertexUniformBuffer(&buffer, bufferSize);
+        programState->getVertexUniformBuffer(&buffer, bufferSize);
 
         for (auto &cb : callbacks)
         {
-            cb.second(_programState, cb.first);
+            cb.second(programState, cb.first);
         }
 
-        int i = 0;
+        unsigned int skipped = 0;
         for(auto& iter : uniformInfos)
         {
             auto& uniformInfo = iter.second;
@@ -468,14 +578,20 @@ void CommandBufferGL::setUniforms(ProgramGL* program) const
                 continue;
 
             int elementCount = uniformInfo.count;
+            auto data = buffer + uniformInfo.bufferOffset;
+            if (!program->updateUniformCache(uniformInfo.location, data, uniformInfo.size * elementCount))
+            {
+                ++skipped;
+                continue;
+            }
             setUniform(uniformInfo.isArray,
                 uniformInfo.location,
                 elementCount,
                 uniformInfo.type,
-                (void*)(buffer + uniformInfo.bufferOffset));
+                (void*)data);
         }
         
-        const auto& textureInfo = _programState->getVertexTextureInfos();
+        const auto& textureInfo = programState->getVertexTextureInfos();
         for(const auto& iter : textureInfo)
         {
             const auto& textures = iter.second.textures;
@@ -492,11 +608,17 @@ void CommandBufferGL::setUniforms(ProgramGL* program) const
             }
             
             auto arrayCount = slot.size();
+            if (!program->updateUniformCache(location, slot.data(), arrayCount * sizeof(uint32_t)))
+            {
+                ++skipped;
+                continue;
+            }
             if (arrayCount > 1)
                 glUniform1iv(location, (uint32_t)arrayCount, (GLint*)slot.data());
             else
                 glUniform1i(location, slot[0]);
         }
+        StateCacheGL::addSkippedUniforms(skipped);
     }
 }
 
@@ -601,25 +723,28 @@ void CommandBufferGL::cleanResources()
 
 void CommandBufferGL::setLineWidth(float lineWidth)
 {
-    if(lineWidth > 0.0f)
-        glLineWidth(lineWidth);
-    else
-        glLineWidth(1.0f);
-    
+    RenderThreadGL::run(nullptr, [lineWidth]() {
+        if(lineWidth > 0.0f)
+            StateCacheGL::lineWidth(lineWidth);
+        else
+            StateCacheGL::lineWidth(1.0f);
+    });
 }
 
 
 void CommandBufferGL::setScissorRect(bool isEnabled, float x, float y, float width, float height)
 {
-    if(isEnabled)
-    {
-        glEnable(GL_SCISSOR_TEST);
-        glScissor(x, y, width, height);
-    }
-    else
-    {
-        glDisable(GL_SCISSOR_TEST);
-    }
+    RenderThreadGL::run(nullptr, [isEnabled, x, y, width, height]() {
+        if(isEnabled)
+        {
+            StateCacheGL::setEnabled(GL_SCISSOR_TEST, true);
+            StateCacheGL::scissor(x, y, width, height);
+        }
+        else
+        {
+            StateCacheGL::setEnabled(GL_SCISSOR_TEST, false);
+        }
+    });
 }
 
 void CommandBufferGL::captureScreen(std::function<void(const unsigned char*, int, int)> callback)
@@ -632,8 +757,12 @@ void CommandBufferGL::captureScreen(std::function<void(const unsigned char*, int
         callback(nullptr, 0, 0);
         return;
     }
-    glPixelStorei(GL_PACK_ALIGNMENT, 1);
-    glReadPixels(0, 0, _viewPort.w, _viewPort.h, GL_RGBA, GL_UNSIGNED_BYTE, buffer.get());
+    // The callback is invoked on the calling thread once the pixels are read.
+    auto viewPort = _viewPort;
+    RenderThreadGL::runSync([&buffer, viewPort]() {
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glReadPixels(0, 0, viewPort.w, viewPort.h, GL_RGBA, GL_UNSIGNED_BYTE, buffer.get());
+    });
 
     std::shared_ptr<GLubyte> flippedBuffer(new GLubyte[bufferSize], [](GLubyte* p) { CC_SAFE_DELETE_ARRAY(p); });
     memset(flippedBuffer.get(), 0, bufferSize);
@@ -178,9 +178,23 @@ private:
         unsigned int h = 0;
     };
     
-    void prepareDrawing() const;
-    void bindVertexBuffer(ProgramGL* program) const;
-    void setUniforms(ProgramGL* program) const;
+    // The objects and states a draw call reads, captured when the draw call is issued.
+    struct DrawState
+    {
+        ProgramGL* program = nullptr;
+        ProgramState* programState = nullptr;
+        BufferGL* vertexBuffer = nullptr;
+        BufferGL* indexBuffer = nullptr;
+        DepthStencilStateGL* depthStencilState = nullptr;
+        unsigned int stencilReferenceValueFront = 0;
+        unsigned int stencilReferenceValueBack = 0;
+        CullMode cullMode = CullMode::NONE;
+    };
+
+    DrawState captureDrawState() const;
+    void prepareDrawing(const DrawState& state) const;
+    void bindVertexBuffer(const DrawState& state) const;
+    void setUniforms(const DrawState& state) const;
     void setUniform(bool isArray, GLuint location, unsigned int size, GLenum uniformType, void* data) const;
     void cleanResources();
     void applyRenderPassDescriptor(const RenderPassDescriptor& descirptor);
@@ -205,6 +219,11 @@ private:
     Viewport _viewPort;
     GLboolean _alphaTestEnabled = false;
 
+#if CC_TARGET_PLATFORM == CC_PLATFORM_WIN32 || CC_TARGET_PLATFORM == CC_PLATFORM_LINUX
+    // Fences of the frames in flight, streaming buffers of a frame are reused once its fence is signaled.
+    GLsync _frameFences[MAX_INFLIGHT_BUFFER] = {};
+#endif
+
 #if CC_ENABLE_CACHE_TEXTURE_DATA
     EventListenerCustom* _backToForegroundListener = nullptr;
 #endif
@@ -30,6 +30,8 @@
 #include "base/CCEventDispatcher.h"
 #include "base/CCEventType.h"
 #include "renderer/backend/opengl/UtilsGL.h"
+#include "renderer/backend/opengl/StateCacheGL.h"
+#include "renderer/backend/opengl/RenderThreadGL.h"
 
 CC_BACKEND_BEGIN
 namespace {
@@ -51,9 +53,12 @@ ProgramGL::ProgramGL(const std::string& vertexShader, const std::string& fragmen
 
     CC_SAFE_RETAIN(_vertexShaderModule);
     CC_SAFE_RETAIN(_fragmentShaderModule);
-    compileProgram();
-    computeUniformInfos();
-    computeLocations();
+    // The program is queried right after linking, wait for the render thread.
+    RenderThreadGL::runSync([this]() {
+        compileProgram();
+        computeUniformInfos();
+        computeLocations();
+    });
 #if CC_ENABLE_CACHE_TEXTURE_DATA
     for(const auto& uniform: _activeUniformInfos)
     {
@@ -74,8 +79,12 @@ ProgramGL::~ProgramGL()
 {
     CC_SAFE_RELEASE(_vertexShaderModule);
     CC_SAFE_RELEASE(_fragmentShaderModule);
-    if (_program)
-        glDeleteProgram(_program);
+    // Recorded jobs retain the program, so they have all been executed when it is destroyed.
+    GLuint program = _program;
+    RenderThreadGL::run(nullptr, [program]() {
+        if (program)
+            StateCacheGL::deleteProgram(program);
+    });
 
 #if CC_ENABLE_CACHE_TEXTURE_DATA
     Director::getInstance()->getEventDispatcher()->removeEventListener(_backToForegroundListener);
@@ -86,6 +95,7 @@ ProgramGL::~ProgramGL()
 void ProgramGL::reloadProgram()
 {
     _activeUniformInfos.clear();
+    _uniformCache.clear();
     _mapToCurrentActiveLocation.clear();
     _mapToOriginalLocation.clear();
     static_cast<ShaderModuleGL*>(_vertexShaderModule)->compileShader(backend::ShaderStage::VERTEX, std::move(vsPreDefine + _vertexShader));
@@ -184,7 +194,10 @@ void ProgramGL::computeLocations()
 
 bool ProgramGL::getAttributeLocation(const std::string& attributeName, unsigned int& location) const
 {
-    GLint loc = glGetAttribLocation(_program, attributeName.c_str());
+    GLint loc = -1;
+    RenderThreadGL::runSync([this, &attributeName, &loc]() {
+        loc = glGetAttribLocation(_program, attributeName.c_str());
+    });
     if (-1 == loc)
     {
         CCLOG("Cocos2d: %s: can not find vertex attribute of %s", __FUNCTION__, attributeName.c_str());
@@ -201,34 +214,36 @@ const std::unordered_map<std::string, AttributeBindInfo> ProgramGL::getActiveAtt
 
     if (!_program) return attributes;
 
-    GLint numOfActiveAttributes = 0;
-    glGetProgramiv(_program, GL_ACTIVE_ATTRIBUTES, &numOfActiveAttributes);
+    RenderThreadGL::runSync([this, &attributes]() {
+        GLint numOfActiveAttributes = 0;
+        glGetProgramiv(_program, GL_ACTIVE_ATTRIBUTES, &numOfActiveAttributes);
 
 
-    if (numOfActiveAttributes <= 0)
-        return attributes;
+        if (numOfActiveAttributes <= 0)
+            return;
 
-    attributes.reserve(numOfActiveAttributes);
+        attributes.reserve(numOfActiveAttributes);
 
-    int MAX_ATTRIBUTE_NAME_LENGTH = 256;
-    std::vector<char> attrName(MAX_ATTRIBUTE_NAME_LENGTH + 1);
+        int MAX_ATTRIBUTE_NAME_LENGTH = 256;
+        std::vector<char> attrName(MAX_ATTRIBUTE_NAME_LENGTH + 1);
 
-    GLint attrNameLen = 0;
-    GLenum attrType;
-    GLint attrSize;
-    backend::AttributeBindInfo info;
+        GLint attrNameLen = 0;
+        GLenum attrType;
+        GLint attrSize;
+        backend::AttributeBindInfo info;
 
-    for (int i = 0; i < numOfActiveAttributes; i++)
-    {
-        glGetActiveAttrib(_program, i, MAX_ATTRIBUTE_NAME_LENGTH, &attrNameLen, &attrSize, &attrType, attrName.data());
-        CHECK_GL_ERROR_DEBUG();
-        info.attributeName = std::string(attrName.data(), attrName.data() + attrNameLen);
-        info.location = glGetAttribLocation(_program, info.attributeName.c_str());
-        info.type = attrType;
-        info.size = UtilsGL::getGLDataTypeSize(attrType) * attrSize;
-        CHECK_GL_ERROR_DEBUG();
-        attributes[info.attributeName] = info;
-    }
+        for (int i = 0; i < numOfActiveAttributes; i++)
+        {
+            glGetActiveAttrib(_program, i, MAX_ATTRIBUTE_NAME_LENGTH, &attrNameLen, &attrSize, &attrType, attrName.data());
+            CHECK_GL_ERROR_DEBUG();
+            info.attributeName = std::string(attrName.data(), attrName.data() + attrNameLen);
+            info.location = glGetAttribLocation(_program, info.attributeName.c_str());
+            info.type = attrType;
+            info.size = UtilsGL::getGLDataTypeSize(attrType) * attrSize;
+            CHECK_GL_ERROR_DEBUG();
+            attributes[info.attributeName] = info;
+        }
+    });
 
     return attributes;
 
@@ -282,7 +297,11 @@ int ProgramGL::getAttributeLocation(Attribute name) const
 
 int ProgramGL::getAttributeLocation(const std::string& name) const
 {
-    return glGetAttribLocation(_program, name.c_str());
+    int location = -1;
+    RenderThreadGL::runSync([this, &name, &location]() {
+        location = glGetAttribLocation(_program, name.c_str());
+    });
+    return location;
 }
 
 UniformLocation ProgramGL::getUniformLocation(backend::Uniform name) const
@@ -348,4 +367,20 @@ std::size_t ProgramGL::getUniformBufferSize(ShaderStage stage) const
     return _totalBufferSize;
 }
 
+bool ProgramGL::updateUniformCache(int location, const void* data, std::size_t size)
+{
+    if (location < 0)
+        return true;
+
+    if (location >= (int)_uniformCache.size())
+        _uniformCache.resize(location + 1);
+
+    auto& cached = _uniformCache[location];
+    if (cached.size() == size && memcmp(cached.data(), data, size) == 0)
+        return false;
+
+    cached.assign((const char*)data, (const char*)data + size);
+    return true;
+}
+
 CC_BACKEND_END
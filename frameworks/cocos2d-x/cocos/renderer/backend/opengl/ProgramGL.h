@@ -157,6 +157,15 @@ public:
      */
     virtual const std::unordered_map<std::string, UniformInfo>& getAllActiveUniformInfo(ShaderStage stage) const override ;
 
+    /**
+     * Compare uniform data with the value last uploaded to this program, and remember it if they differ.
+     * @param location Specifies the uniform location.
+     * @param data Specifies the uniform data.
+     * @param size Specifies the uniform data size in bytes.
+     * @return true if the data differs from the uploaded value and needs to be uploaded, otherwise false.
+     */
+    bool updateUniformCache(int location, const void* data, std::size_t size);
+
 private:
     void compileProgram();
     bool getAttributeLocation(const std::string& attributeName, unsigned int& location) const;
@@ -187,6 +196,7 @@ private:
     UniformLocation _builtinUniformLocation[UNIFORM_MAX];
     int _builtinAttributeLocation[Attribute::ATTRIBUTE_MAX];
     std::unordered_map<int, int> _bufferOffset;
+    std::vector<std::vector<char>> _uniformCache; ///< uploaded uniform values indexed by location.
 };
 //end of _opengl group
 /// @}
@@ -27,6 +27,8 @@
 #include "DepthStencilStateGL.h"
 #include "ProgramGL.h"
 #include "UtilsGL.h"
+#include "StateCacheGL.h"
+#include "RenderThreadGL.h"
 
 #include <assert.h>
 
@@ -58,19 +60,21 @@ void RenderPipelineGL::updateBlendState(const BlendDescriptor& descriptor)
     auto writeMaskBlue = (uint32_t)descriptor.writeMask & (uint32_t)ColorWriteMask::BLUE;
     auto writeMaskAlpha = (uint32_t)descriptor.writeMask & (uint32_t)ColorWriteMask::ALPHA;
 
-    if (blendEnabled)
-    {
-        glEnable(GL_BLEND);
-        glBlendEquationSeparate(rgbBlendOperation, alphaBlendOperation);
-        glBlendFuncSeparate(sourceRGBBlendFactor,
-                            destinationRGBBlendFactor,
-                            sourceAlphaBlendFactor,
-                            destinationAlphaBlendFactor);
-    }
-    else
-        glDisable(GL_BLEND);
-    
-    glColorMask(writeMaskRed, writeMaskGreen, writeMaskBlue, writeMaskAlpha);
+    RenderThreadGL::run(nullptr, [=]() {
+        if (blendEnabled)
+        {
+            StateCacheGL::setEnabled(GL_BLEND, true);
+            StateCacheGL::blendEquationSeparate(rgbBlendOperation, alphaBlendOperation);
+            StateCacheGL::blendFuncSeparate(sourceRGBBlendFactor,
+                                            destinationRGBBlendFactor,
+                                            sourceAlphaBlendFactor,
+                                            destinationAlphaBlendFactor);
+        }
+        else
+            StateCacheGL::setEnabled(GL_BLEND, false);
+
+        StateCacheGL::colorMask(writeMaskRed != 0, writeMaskGreen != 0, writeMaskBlue != 0, writeMaskAlpha != 0);
+    });
 }
 
 RenderPipelineGL::~RenderPipelineGL()
@@ -0,0 +1,201 @@
+/****************************************************************************
+ Copyright (c) 2018-2019 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+ 
+ 
+#include "RenderThreadGL.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+CC_BACKEND_BEGIN
+
+namespace
+{
+    struct JobList
+    {
+        std::vector<RenderThreadGL::Job> jobs;
+        std::vector<Ref*> objects;
+    };
+
+    std::thread renderThread;
+    std::thread::id renderThreadId;
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::function<void(bool)> contextCallback;
+
+    // Only touched by the cocos thread.
+    JobList recording;
+    // Owned by the render thread while busy, by the cocos thread otherwise.
+    JobList executing;
+    // Objects of executed jobs, released by the cocos thread.
+    std::vector<Ref*> executedObjects;
+    bool busy = false;
+    bool quit = false;
+
+    void threadLoop()
+    {
+        contextCallback(true);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true)
+        {
+            condition.wait(lock, []() { return busy || quit; });
+            if (!busy)
+                break;
+
+            lock.unlock();
+            for (auto& job : executing.jobs)
+                job();
+            executing.jobs.clear();
+            lock.lock();
+
+            executedObjects.insert(executedObjects.end(), executing.objects.begin(), executing.objects.end());
+            executing.objects.clear();
+            busy = false;
+            condition.notify_all();
+        }
+        lock.unlock();
+
+        contextCallback(false);
+    }
+
+    // Wait until the render thread is idle and release the objects of executed jobs, called by the cocos thread.
+    void waitIdle(std::unique_lock<std::mutex>& lock)
+    {
+        condition.wait(lock, []() { return !busy; });
+
+        std::vector<Ref*> objects;
+        objects.swap(executedObjects);
+        lock.unlock();
+        // Releasing may destroy objects whose destructors record jobs, so it is done without the lock.
+        for (auto object : objects)
+            object->release();
+        lock.lock();
+    }
+
+    void submit()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        waitIdle(lock);
+        // Destructors invoked by waitIdle() may have recorded jobs, check after it.
+        if (recording.jobs.empty() && recording.objects.empty())
+            return;
+
+        std::swap(recording, executing);
+        busy = true;
+        condition.notify_all();
+    }
+}
+
+bool RenderThreadGL::_running = false;
+
+void RenderThreadGL::start(const std::function<void(bool)>& makeContextCurrent)
+{
+    if (_running)
+        return;
+
+    contextCallback = makeContextCurrent;
+    contextCallback(false);
+    quit = false;
+    _running = true;
+    renderThread = std::thread(threadLoop);
+    renderThreadId = renderThread.get_id();
+}
+
+void RenderThreadGL::stop()
+{
+    if (!_running)
+        return;
+
+    finish();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+    }
+    condition.notify_all();
+    renderThread.join();
+    renderThreadId = std::thread::id();
+    _running = false;
+
+    contextCallback(true);
+    contextCallback = nullptr;
+}
+
+bool RenderThreadGL::isRenderThread()
+{
+    return std::this_thread::get_id() == renderThreadId;
+}
+
+void RenderThreadGL::record(Ref* owner, Job&& job)
+{
+    recording.jobs.push_back(std::move(job));
+    retainUntilExecuted(owner);
+}
+
+void RenderThreadGL::retainUntilExecuted(Ref* object)
+{
+    if (!_running || !object || isRenderThread())
+        return;
+
+    object->retain();
+    recording.objects.push_back(object);
+}
+
+void RenderThreadGL::runSync(const Job& job)
+{
+    if (!_running || isRenderThread())
+    {
+        job();
+        return;
+    }
+
+    record(nullptr, Job(job));
+    finish();
+}
+
+void RenderThreadGL::commitFrame()
+{
+    if (!_running)
+        return;
+
+    submit();
+}
+
+void RenderThreadGL::finish()
+{
+    if (!_running)
+        return;
+
+    // Released objects may record more jobs, e.g. deleting their GL objects.
+    do
+    {
+        submit();
+        std::unique_lock<std::mutex> lock(mutex);
+        waitIdle(lock);
+    } while (!recording.jobs.empty() || !recording.objects.empty());
+}
+
+CC_BACKEND_END
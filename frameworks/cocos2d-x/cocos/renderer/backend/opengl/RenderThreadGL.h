@@ -0,0 +1,139 @@
+/****************************************************************************
+ Copyright (c) 2018-2019 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+ 
+ 
+#pragma once
+
+#include "base/ccMacros.h"
+#include "base/CCRef.h"
+#include "renderer/backend/Macros.h"
+
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <memory>
+
+CC_BACKEND_BEGIN
+/**
+ * @addtogroup _opengl
+ * @{
+ */
+
+/**
+ * Executes the GL commands of the backend on a dedicated render thread.
+ * When running, GL commands issued by the cocos thread are recorded as jobs and a frame of recorded jobs is executed on
+ * the render thread while the cocos thread goes on with the next frame. At most one frame is in flight, `commitFrame()`
+ * waits for the previous frame before handing over the current one.
+ * When not running, which is the default, jobs are executed at once on the calling thread.
+ */
+class RenderThreadGL
+{
+public:
+    using Job = std::function<void()>;
+
+    /**
+     * Start the render thread.
+     * @param makeContextCurrent Makes the GL context current on the calling thread with true, releases it with false.
+     * It is invoked with false on the cocos thread and then with true on the render thread when starting, and the other way round when stopping.
+     */
+    static void start(const std::function<void(bool)>& makeContextCurrent);
+
+    /// Execute all recorded jobs, stop the render thread and give the GL context back to the cocos thread.
+    static void stop();
+
+    /// Whether the render thread is running.
+    static bool isRunning() { return _running; }
+
+    /// Whether the calling thread is the render thread.
+    static bool isRenderThread();
+
+    /**
+     * Run a job issuing GL commands. It is recorded if the render thread is running and the caller is not the render thread,
+     * otherwise it is executed at once.
+     * @param owner Specifies the object used by the job, it is retained until the job is executed. Can be nullptr.
+     * @param job Specifies the job.
+     */
+    template <typename T>
+    static void run(Ref* owner, T&& job)
+    {
+        if (!_running || isRenderThread())
+            job();
+        else
+            record(owner, Job(std::forward<T>(job)));
+    }
+
+    /**
+     * Run a job reading data owned by the caller. A recorded job gets a copy of the data, the caller may modify or free it after returning.
+     * @param owner Specifies the object used by the job, it is retained until the job is executed. Can be nullptr.
+     * @param data Specifies the data read by the job.
+     * @param size Specifies the data size in bytes.
+     * @param job Specifies the job, invoked with the data to read.
+     */
+    template <typename T>
+    static void run(Ref* owner, const void* data, std::size_t size, const T& job)
+    {
+        if (!_running || isRenderThread())
+        {
+            job(data);
+            return;
+        }
+
+        if (!data)
+        {
+            record(owner, [job]() { job(nullptr); });
+            return;
+        }
+
+        std::shared_ptr<char> copy(new char[size], std::default_delete<char[]>());
+        memcpy(copy.get(), data, size);
+        record(owner, [copy, job]() { job(copy.get()); });
+    }
+
+    /**
+     * Run a job and wait until it is executed, used for GL queries.
+     * All the jobs recorded before are executed first.
+     */
+    static void runSync(const Job& job);
+
+    /**
+     * Keep an object alive until the jobs recorded so far are executed.
+     * @param object Specifies the object, can be nullptr.
+     */
+    static void retainUntilExecuted(Ref* object);
+
+    /// Hand the jobs recorded for the current frame to the render thread, waits until the previous frame is executed.
+    static void commitFrame();
+
+    /// Wait until all recorded jobs are executed.
+    static void finish();
+
+private:
+    static void record(Ref* owner, Job&& job);
+
+    static bool _running;
+};
+
+//end of _opengl group
+/// @}
+CC_BACKEND_END
@@ -26,18 +26,26 @@
 
 #include "platform/CCPlatformMacros.h"
 #include "base/ccMacros.h"
+#include "renderer/backend/opengl/RenderThreadGL.h"
 
 CC_BACKEND_BEGIN
 
 ShaderModuleGL::ShaderModuleGL(ShaderStage stage, const std::string& source)
 : ShaderModule(stage)
 {
-    compileShader(stage, source);
+    RenderThreadGL::runSync([this, stage, &source]() {
+        compileShader(stage, source);
+    });
 }
 
 ShaderModuleGL::~ShaderModuleGL()
 {
-    deleteShader();
+    GLuint shader = _shader;
+    RenderThreadGL::run(nullptr, [shader]() {
+        if (shader)
+            glDeleteShader(shader);
+    });
+    _shader = 0;
 }
 
 void ShaderModuleGL::compileShader(ShaderStage stage, const std::string &source)
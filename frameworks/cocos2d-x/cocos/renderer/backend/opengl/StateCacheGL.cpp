@@ -0,0 +1,499 @@
+/****************************************************************************
+ Copyright (c) 2018-2019 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+ 
+ 
+#include "StateCacheGL.h"
+
+CC_BACKEND_BEGIN
+
+namespace
+{
+    const GLuint UNKNOWN = ~0u;
+    const GLboolean UNKNOWN_BOOLEAN = 0xFF;
+
+    // Faces of GL_FRONT, GL_BACK or GL_FRONT_AND_BACK, index 0 is front and index 1 is back.
+    inline int firstFace(GLenum face) { return GL_BACK == face ? 1 : 0; }
+    inline int lastFace(GLenum face) { return GL_FRONT == face ? 0 : 1; }
+}
+
+GLuint StateCacheGL::_program = UNKNOWN;
+GLuint StateCacheGL::_arrayBuffer = UNKNOWN;
+GLuint StateCacheGL::_elementArrayBuffer = UNKNOWN;
+GLuint StateCacheGL::_vertexArray = UNKNOWN;
+unsigned int StateCacheGL::_enabledAttributes = 0;
+unsigned int StateCacheGL::_knownAttributes = 0;
+StateCacheGL::VertexAttribute StateCacheGL::_attributes[MAX_VERTEX_ATTRIBUTES];
+unsigned int StateCacheGL::_activeTextureUnit = UNKNOWN;
+GLuint StateCacheGL::_textures2D[MAX_TEXTURE_UNITS];
+GLuint StateCacheGL::_texturesCube[MAX_TEXTURE_UNITS];
+signed char StateCacheGL::_capabilities[5];
+GLenum StateCacheGL::_blendEquation[2];
+GLenum StateCacheGL::_blendFunc[4];
+GLboolean StateCacheGL::_colorMask[4];
+GLboolean StateCacheGL::_depthMask = UNKNOWN_BOOLEAN;
+GLenum StateCacheGL::_depthFunc = UNKNOWN;
+StateCacheGL::StencilFace StateCacheGL::_stencilFaces[2];
+GLenum StateCacheGL::_cullFace = UNKNOWN;
+GLenum StateCacheGL::_frontFace = UNKNOWN;
+GLfloat StateCacheGL::_lineWidth = -1.f;
+GLint StateCacheGL::_scissor[4];
+StateCacheGL::Stats StateCacheGL::_stats;
+StateCacheGL::Stats StateCacheGL::_lastFrameStats;
+
+namespace
+{
+    // Start from the unknown state, GL states are not known before the first call.
+    struct StateCacheInitializer
+    {
+        StateCacheInitializer() { StateCacheGL::invalidate(); }
+    } stateCacheInitializer;
+}
+
+unsigned int StateCacheGL::Stats::total() const
+{
+    return program + buffer + vertexArray + vertexAttribute + texture + capability + blend + depthStencil + rasterizer + uniform;
+}
+
+void StateCacheGL::invalidate()
+{
+    _program = UNKNOWN;
+    _arrayBuffer = UNKNOWN;
+    _vertexArray = UNKNOWN;
+    invalidateVertexArrayStates();
+    _activeTextureUnit = UNKNOWN;
+    for (int i = 0; i < MAX_TEXTURE_UNITS; ++i)
+    {
+        _textures2D[i] = UNKNOWN;
+        _texturesCube[i] = UNKNOWN;
+    }
+    for (auto& capability : _capabilities)
+        capability = -1;
+    _blendEquation[0] = _blendEquation[1] = UNKNOWN;
+    _blendFunc[0] = _blendFunc[1] = _blendFunc[2] = _blendFunc[3] = UNKNOWN;
+    _colorMask[0] = _colorMask[1] = _colorMask[2] = _colorMask[3] = UNKNOWN_BOOLEAN;
+    _depthMask = UNKNOWN_BOOLEAN;
+    _depthFunc = UNKNOWN;
+    for (auto& face : _stencilFaces)
+    {
+        face.func = UNKNOWN;
+        face.sfail = UNKNOWN;
+        face.writeMaskValid = false;
+    }
+    _cullFace = UNKNOWN;
+    _frontFace = UNKNOWN;
+    _lineWidth = -1.f;
+    _scissor[2] = -1;
+}
+
+void StateCacheGL::endFrame()
+{
+    _lastFrameStats = _stats;
+    _stats = Stats();
+}
+
+void StateCacheGL::useProgram(GLuint program)
+{
+    if (program == _program)
+    {
+        ++_stats.program;
+        return;
+    }
+    _program = program;
+    glUseProgram(program);
+}
+
+void StateCacheGL::deleteProgram(GLuint program)
+{
+    if (program == _program)
+        _program = UNKNOWN;
+    glDeleteProgram(program);
+}
+
+void StateCacheGL::bindBuffer(GLenum target, GLuint buffer)
+{
+    GLuint* current = nullptr;
+    if (GL_ARRAY_BUFFER == target)
+        current = &_arrayBuffer;
+    else if (GL_ELEMENT_ARRAY_BUFFER == target)
+        current = &_elementArrayBuffer;
+
+    if (current)
+    {
+        if (*current == buffer)
+        {
+            ++_stats.buffer;
+            return;
+        }
+        *current = buffer;
+    }
+    glBindBuffer(target, buffer);
+}
+
+void StateCacheGL::deleteBuffer(GLuint buffer)
+{
+    if (buffer == _arrayBuffer)
+        _arrayBuffer = UNKNOWN;
+    if (buffer == _elementArrayBuffer)
+        _elementArrayBuffer = UNKNOWN;
+    for (auto& attribute : _attributes)
+    {
+        if (buffer == attribute.buffer)
+            attribute.buffer = UNKNOWN;
+    }
+    glDeleteBuffers(1, &buffer);
+}
+
+void StateCacheGL::invalidateVertexArrayStates()
+{
+    _elementArrayBuffer = UNKNOWN;
+    _enabledAttributes = 0;
+    _knownAttributes = 0;
+    for (auto& attribute : _attributes)
+        attribute.buffer = UNKNOWN;
+}
+
+void StateCacheGL::bindVertexArray(GLuint vertexArray)
+{
+    if (vertexArray == _vertexArray)
+    {
+        ++_stats.vertexArray;
+        return;
+    }
+    _vertexArray = vertexArray;
+    invalidateVertexArrayStates();
+    glBindVertexArray(vertexArray);
+}
+
+void StateCacheGL::deleteVertexArray(GLuint vertexArray)
+{
+    if (vertexArray == _vertexArray)
+    {
+        // GL reverts to the default vertex array.
+        _vertexArray = 0;
+        invalidateVertexArrayStates();
+    }
+    glDeleteVertexArrays(1, &vertexArray);
+}
+
+void StateCacheGL::enableVertexAttribArray(GLuint index)
+{
+    if (index >= MAX_VERTEX_ATTRIBUTES)
+    {
+        glEnableVertexAttribArray(index);
+        return;
+    }
+
+    unsigned int bit = 1u << index;
+    if ((_knownAttributes & bit) && (_enabledAttributes & bit))
+    {
+        ++_stats.vertexAttribute;
+        return;
+    }
+    _knownAttributes |= bit;
+    _enabledAttributes |= bit;
+    glEnableVertexAttribArray(index);
+}
+
+void StateCacheGL::vertexAttribPointer(GLuint buffer, GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, std::size_t offset)
+{
+    if (index < MAX_VERTEX_ATTRIBUTES)
+    {
+        auto& attribute = _attributes[index];
+        if (attribute.buffer == buffer &&
+            attribute.size == size &&
+            attribute.type == type &&
+            attribute.normalized == normalized &&
+            attribute.stride == stride &&
+            attribute.offset == offset)
+        {
+            ++_stats.vertexAttribute;
+            return;
+        }
+        attribute = {buffer, size, type, normalized, stride, offset};
+    }
+
+    bindBuffer(GL_ARRAY_BUFFER, buffer);
+    glVertexAttribPointer(index, size, type, normalized, stride, (GLvoid*)offset);
+}
+
+void StateCacheGL::bindTexture(GLenum target, GLuint texture, unsigned int unit)
+{
+    GLuint* current = nullptr;
+    if (unit < MAX_TEXTURE_UNITS)
+    {
+        if (GL_TEXTURE_2D == target)
+            current = &_textures2D[unit];
+        else if (GL_TEXTURE_CUBE_MAP == target)
+            current = &_texturesCube[unit];
+    }
+
+    // The unit is selected even if the texture is bound already,
+    // glTexImage2D and glTexParameteri called after binding act on the texture of the active unit.
+    if (unit != _activeTextureUnit)
+    {
+        _activeTextureUnit = unit;
+        glActiveTexture(GL_TEXTURE0 + unit);
+    }
+
+    if (current && *current == texture)
+    {
+        ++_stats.texture;
+        return;
+    }
+
+    if (current)
+        *current = texture;
+    glBindTexture(target, texture);
+}
+
+void StateCacheGL::deleteTexture(GLuint texture)
+{
+    for (int i = 0; i < MAX_TEXTURE_UNITS; ++i)
+    {
+        if (texture == _textures2D[i])
+            _textures2D[i] = UNKNOWN;
+        if (texture == _texturesCube[i])
+            _texturesCube[i] = UNKNOWN;
+    }
+    glDeleteTextures(1, &texture);
+}
+
+int StateCacheGL::getCapabilityIndex(GLenum capability)
+{
+    switch (capability)
+    {
+        case GL_BLEND:
+            return 0;
+        case GL_CULL_FACE:
+            return 1;
+        case GL_DEPTH_TEST:
+            return 2;
+        case GL_STENCIL_TEST:
+            return 3;
+        case GL_SCISSOR_TEST:
+            return 4;
+        default:
+            return -1;
+    }
+}
+
+void StateCacheGL::setEnabled(GLenum capability, bool enabled)
+{
+    int index = getCapabilityIndex(capability);
+    if (index >= 0)
+    {
+        if (_capabilities[index] == (signed char)enabled)
+        {
+            ++_stats.capability;
+            return;
+        }
+        _capabilities[index] = enabled;
+    }
+
+    if (enabled)
+        glEnable(capability);
+    else
+        glDisable(capability);
+}
+
+void StateCacheGL::blendEquationSeparate(GLenum modeRGB, GLenum modeAlpha)
+{
+    if (_blendEquation[0] == modeRGB && _blendEquation[1] == modeAlpha)
+    {
+        ++_stats.blend;
+        return;
+    }
+    _blendEquation[0] = modeRGB;
+    _blendEquation[1] = modeAlpha;
+    glBlendEquationSeparate(modeRGB, modeAlpha);
+}
+
+void StateCacheGL::blendFuncSeparate(GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha, GLenum dstAlpha)
+{
+    if (_blendFunc[0] == srcRGB && _blendFunc[1] == dstRGB &&
+        _blendFunc[2] == srcAlpha && _blendFunc[3] == dstAlpha)
+    {
+        ++_stats.blend;
+        return;
+    }
+    _blendFunc[0] = srcRGB;
+    _blendFunc[1] = dstRGB;
+    _blendFunc[2] = srcAlpha;
+    _blendFunc[3] = dstAlpha;
+    glBlendFuncSeparate(srcRGB, dstRGB, srcAlpha, dstAlpha);
+}
+
+void StateCacheGL::colorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha)
+{
+    if (_colorMask[0] == red && _colorMask[1] == green &&
+        _colorMask[2] == blue && _colorMask[3] == alpha)
+    {
+        ++_stats.blend;
+        return;
+    }
+    _colorMask[0] = red;
+    _colorMask[1] = green;
+    _colorMask[2] = blue;
+    _colorMask[3] = alpha;
+    glColorMask(red, green, blue, alpha);
+}
+
+void StateCacheGL::depthMask(GLboolean flag)
+{
+    if (_depthMask == flag)
+    {
+        ++_stats.depthStencil;
+        return;
+    }
+    _depthMask = flag;
+    glDepthMask(flag);
+}
+
+void StateCacheGL::depthFunc(GLenum func)
+{
+    if (_depthFunc == func)
+    {
+        ++_stats.depthStencil;
+        return;
+    }
+    _depthFunc = func;
+    glDepthFunc(func);
+}
+
+void StateCacheGL::stencilFuncSeparate(GLenum face, GLenum func, GLint ref, GLuint mask)
+{
+    bool changed = false;
+    for (int i = firstFace(face); i <= lastFace(face); ++i)
+    {
+        auto& stencil = _stencilFaces[i];
+        if (stencil.func != func || stencil.ref != ref || stencil.readMask != mask)
+        {
+            stencil.func = func;
+            stencil.ref = ref;
+            stencil.readMask = mask;
+            changed = true;
+        }
+    }
+
+    if (!changed)
+    {
+        ++_stats.depthStencil;
+        return;
+    }
+    glStencilFuncSeparate(face, func, ref, mask);
+}
+
+void StateCacheGL::stencilOpSeparate(GLenum face, GLenum sfail, GLenum dpfail, GLenum dppass)
+{
+    bool changed = false;
+    for (int i = firstFace(face); i <= lastFace(face); ++i)
+    {
+        auto& stencil = _stencilFaces[i];
+        if (stencil.sfail != sfail || stencil.dpfail != dpfail || stencil.dppass != dppass)
+        {
+            stencil.sfail = sfail;
+            stencil.dpfail = dpfail;
+            stencil.dppass = dppass;
+            changed = true;
+        }
+    }
+
+    if (!changed)
+    {
+        ++_stats.depthStencil;
+        return;
+    }
+    glStencilOpSeparate(face, sfail, dpfail, dppass);
+}
+
+void StateCacheGL::stencilMaskSeparate(GLenum face, GLuint mask)
+{
+    bool changed = false;
+    for (int i = firstFace(face); i <= lastFace(face); ++i)
+    {
+        auto& stencil = _stencilFaces[i];
+        if (!stencil.writeMaskValid || stencil.writeMask != mask)
+        {
+            stencil.writeMask = mask;
+            stencil.writeMaskValid = true;
+            changed = true;
+        }
+    }
+
+    if (!changed)
+    {
+        ++_stats.depthStencil;
+        return;
+    }
+    glStencilMaskSeparate(face, mask);
+}
+
+void StateCacheGL::cullFace(GLenum mode)
+{
+    if (_cullFace == mode)
+    {
+        ++_stats.rasterizer;
+        return;
+    }
+    _cullFace = mode;
+    glCullFace(mode);
+}
+
+void StateCacheGL::frontFace(GLenum mode)
+{
+    if (_frontFace == mode)
+    {
+        ++_stats.rasterizer;
+        return;
+    }
+    _frontFace = mode;
+    glFrontFace(mode);
+}
+
+void StateCacheGL::lineWidth(GLfloat width)
+{
+    if (_lineWidth == width)
+    {
+        ++_stats.rasterizer;
+        return;
+    }
+    _lineWidth = width;
+    glLineWidth(width);
+}
+
+void StateCacheGL::scissor(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    if (_scissor[0] == x && _scissor[1] == y && _scissor[2] == width && _scissor[3] == height)
+    {
+        ++_stats.rasterizer;
+        return;
+    }
+    _scissor[0] = x;
+    _scissor[1] = y;
+    _scissor[2] = width;
+    _scissor[3] = height;
+    glScissor(x, y, width, height);
+}
+
+CC_BACKEND_END
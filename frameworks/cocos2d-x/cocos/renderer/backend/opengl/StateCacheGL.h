@@ -0,0 +1,207 @@
+/****************************************************************************
+ Copyright (c) 2018-2019 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+ 
+ 
+#pragma once
+
+#include "base/ccMacros.h"
+#include "platform/CCGL.h"
+#include "renderer/backend/Macros.h"
+
+#include <cstddef>
+
+CC_BACKEND_BEGIN
+/**
+ * @addtogroup _opengl
+ * @{
+ */
+
+/**
+ * Shadow copy of the GL states changed by the backend.
+ * The backend changes GL states through this class, so a call that would set a state to its current value is skipped.
+ * Code that changes GL states directly, i.e. a custom command issuing raw GL calls, should invoke `invalidate()` afterwards.
+ */
+class StateCacheGL
+{
+public:
+    /**
+     * Number of GL calls skipped because the state was already set.
+     */
+    struct Stats
+    {
+        unsigned int program = 0;
+        unsigned int buffer = 0;
+        unsigned int vertexArray = 0;
+        unsigned int vertexAttribute = 0;
+        unsigned int texture = 0;
+        unsigned int capability = 0;
+        unsigned int blend = 0;
+        unsigned int depthStencil = 0;
+        unsigned int rasterizer = 0;
+        unsigned int uniform = 0;
+
+        /// Total number of skipped calls.
+        unsigned int total() const;
+    };
+
+    /// Forget all the cached states, the next call of each state goes to GL.
+    static void invalidate();
+
+    /// Finish the statistics of current frame, see `getFrameStats()`.
+    static void endFrame();
+
+    /**
+     * Get the number of skipped calls of the last finished frame.
+     * @return Skipped calls of the last frame.
+     */
+    static const Stats& getFrameStats() { return _lastFrameStats; }
+
+    /**
+     * Record uniform uploads skipped by the caller.
+     * @param count Specifies the number of skipped uploads.
+     */
+    static void addSkippedUniforms(unsigned int count) { _stats.uniform += count; }
+
+    static void useProgram(GLuint program);
+    /// Should be invoked instead of glDeleteProgram, GL may reuse the name of a deleted program.
+    static void deleteProgram(GLuint program);
+
+    /**
+     * Bind a buffer to GL_ARRAY_BUFFER or GL_ELEMENT_ARRAY_BUFFER.
+     * @param target Specifies the buffer target.
+     * @param buffer Specifies the buffer object.
+     */
+    static void bindBuffer(GLenum target, GLuint buffer);
+    /// Should be invoked instead of glDeleteBuffers, GL may reuse the name of a deleted buffer.
+    static void deleteBuffer(GLuint buffer);
+
+    /**
+     * Bind a vertex array object, 0 binds the default vertex array.
+     * Vertex attributes and the element array buffer binding belong to the vertex array, so their cached states are dropped when it changes.
+     */
+    static void bindVertexArray(GLuint vertexArray);
+    /// Should be invoked instead of glDeleteVertexArrays, GL may reuse the name of a deleted vertex array.
+    static void deleteVertexArray(GLuint vertexArray);
+
+    static void enableVertexAttribArray(GLuint index);
+
+    /**
+     * Specify a vertex attribute sourced from the given buffer.
+     * The buffer is bound to GL_ARRAY_BUFFER only if the attribute has to be specified again.
+     */
+    static void vertexAttribPointer(GLuint buffer, GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, std::size_t offset);
+
+    /**
+     * Bind a texture to a texture unit, the unit is left active.
+     * @param target Specifies the texture target, GL_TEXTURE_2D or GL_TEXTURE_CUBE_MAP.
+     * @param texture Specifies the texture object.
+     * @param unit Specifies the texture unit, starts from 0.
+     */
+    static void bindTexture(GLenum target, GLuint texture, unsigned int unit = 0);
+    /// Should be invoked instead of glDeleteTextures, GL may reuse the name of a deleted texture.
+    static void deleteTexture(GLuint texture);
+
+    /**
+     * Enable or disable a server-side capability.
+     * GL_BLEND, GL_CULL_FACE, GL_DEPTH_TEST, GL_STENCIL_TEST and GL_SCISSOR_TEST are cached, others go to GL directly.
+     */
+    static void setEnabled(GLenum capability, bool enabled);
+
+    static void blendEquationSeparate(GLenum modeRGB, GLenum modeAlpha);
+    static void blendFuncSeparate(GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha, GLenum dstAlpha);
+    static void colorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha);
+
+    static void depthMask(GLboolean flag);
+    static void depthFunc(GLenum func);
+
+    /**
+     * Set stencil states of one face.
+     * @param face Specifies the face, GL_FRONT, GL_BACK or GL_FRONT_AND_BACK.
+     */
+    static void stencilFuncSeparate(GLenum face, GLenum func, GLint ref, GLuint mask);
+    static void stencilOpSeparate(GLenum face, GLenum sfail, GLenum dpfail, GLenum dppass);
+    static void stencilMaskSeparate(GLenum face, GLuint mask);
+
+    static void cullFace(GLenum mode);
+    static void frontFace(GLenum mode);
+    static void lineWidth(GLfloat width);
+    static void scissor(GLint x, GLint y, GLsizei width, GLsizei height);
+
+private:
+    static constexpr int MAX_TEXTURE_UNITS = 16;
+    static constexpr int MAX_VERTEX_ATTRIBUTES = 16;
+
+    struct VertexAttribute
+    {
+        GLuint buffer;
+        GLint size;
+        GLenum type;
+        GLboolean normalized;
+        GLsizei stride;
+        std::size_t offset;
+    };
+
+    struct StencilFace
+    {
+        GLenum func;
+        GLint ref;
+        GLuint readMask;
+        GLenum sfail;
+        GLenum dpfail;
+        GLenum dppass;
+        GLuint writeMask;
+        bool writeMaskValid;
+    };
+
+    static int getCapabilityIndex(GLenum capability);
+    static void invalidateVertexArrayStates();
+
+    static GLuint _program;
+    static GLuint _arrayBuffer;
+    static GLuint _elementArrayBuffer;
+    static GLuint _vertexArray;
+    static unsigned int _enabledAttributes;
+    static unsigned int _knownAttributes;
+    static VertexAttribute _attributes[MAX_VERTEX_ATTRIBUTES];
+    static unsigned int _activeTextureUnit;
+    static GLuint _textures2D[MAX_TEXTURE_UNITS];
+    static GLuint _texturesCube[MAX_TEXTURE_UNITS];
+    static signed char _capabilities[5];
+    static GLenum _blendEquation[2];
+    static GLenum _blendFunc[4];
+    static GLboolean _colorMask[4];
+    static GLboolean _depthMask;
+    static GLenum _depthFunc;
+    static StencilFace _stencilFaces[2];
+    static GLenum _cullFace;
+    static GLenum _frontFace;
+    static GLfloat _lineWidth;
+    static GLint _scissor[4];
+
+    static Stats _stats;
+    static Stats _lastFrameStats;
+};
+//end of _opengl group
+/// @}
+CC_BACKEND_END
@@ -30,6 +30,8 @@
 #include "base/CCDirector.h"
 #include "platform/CCPlatformConfig.h"
 #include "renderer/backend/opengl/UtilsGL.h"
+#include "renderer/backend/opengl/StateCacheGL.h"
+#include "renderer/backend/opengl/RenderThreadGL.h"
 
 CC_BACKEND_BEGIN
 
@@ -75,16 +77,59 @@ void TextureInfoGL::applySamplerDescriptor(const SamplerDescriptor& descriptor,
     }
 }
 
+
+namespace {
+    // Read a block of RGBA pixels through a temporary frame buffer the texture is attached to.
+    void readPixels(GLenum target, GLuint texture, std::size_t x, std::size_t y, std::size_t width, std::size_t height, unsigned char* image)
+    {
+        GLint defaultFBO = 0;
+        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &defaultFBO);
+
+        GLuint frameBuffer = 0;
+        glGenFramebuffers(1, &frameBuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, frameBuffer);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, target, texture, 0);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glReadPixels(x,y,width, height,GL_RGBA,GL_UNSIGNED_BYTE, image);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, defaultFBO);
+        glDeleteFramebuffers(1, &frameBuffer);
+    }
+
+    void deliverPixels(unsigned char* image, std::size_t bytePerRow, std::size_t width, std::size_t height, bool flipImage, const std::function<void(const unsigned char*, std::size_t, std::size_t)>& callback)
+    {
+        if(flipImage)
+        {
+            unsigned char* flippedImage = new unsigned char[bytePerRow * height];
+            for (int i = 0; i < height; ++i)
+            {
+                memcpy(&flippedImage[i * bytePerRow],
+                       &image[(height - i - 1) * bytePerRow],
+                       bytePerRow);
+            }
+            CC_SAFE_DELETE_ARRAY(image);
+            callback(flippedImage, width, height);
+            CC_SAFE_DELETE_ARRAY(flippedImage);
+        } else
+        {
+            callback(image, width, height);
+            CC_SAFE_DELETE_ARRAY(image);
+        }
+    }
+}
+
 Texture2DGL::Texture2DGL(const TextureDescriptor& descriptor) : Texture2DBackend(descriptor)
 {
-    glGenTextures(1, &_textureInfo.texture);
+    RenderThreadGL::run(this, [this]() {
+        glGenTextures(1, &_texture);
+    });
 
     updateTextureDescriptor(descriptor);
 
 #if CC_ENABLE_CACHE_TEXTURE_DATA
     // Listen this event to restored texture id after coming to foreground on Android.
     _backToForegroundListener = EventListenerCustom::create(EVENT_RENDERER_RECREATED, [this](EventCustom*){
-        glGenTextures(1, &(this->_textureInfo.texture));
+        glGenTextures(1, &(this->_texture));
         this->initWithZeros();
     });
     Director::getInstance()->getEventDispatcher()->addEventListenerWithFixedPriority(_backToForegroundListener, -1);
@@ -121,9 +166,13 @@ void Texture2DGL::updateTextureDescriptor(const cocos2d::backend::TextureDescrip
 
 Texture2DGL::~Texture2DGL()
 {
-    if (_textureInfo.texture)
-        glDeleteTextures(1, &_textureInfo.texture);
-    _textureInfo.texture = 0;
+    // Recorded jobs retain the texture, so they have all been executed when it is destroyed.
+    GLuint texture = _texture;
+    RenderThreadGL::run(nullptr, [texture]() {
+        if (texture)
+            StateCacheGL::deleteTexture(texture);
+    });
+    _texture = 0;
 #if CC_ENABLE_CACHE_TEXTURE_DATA
     Director::getInstance()->getEventDispatcher()->removeEventListener(_backToForegroundListener);
 #endif
@@ -133,78 +182,77 @@ void Texture2DGL::updateSamplerDescriptor(const SamplerDescriptor &sampler) {
     bool isPow2 = ISPOW2(_width) && ISPOW2(_height);
     _textureInfo.applySamplerDescriptor(sampler, isPow2, _hasMipmaps);
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, _textureInfo.texture);
+    TextureInfoGL textureInfo = _textureInfo;
+    RenderThreadGL::run(this, [this, sampler, textureInfo]() {
+        StateCacheGL::bindTexture(GL_TEXTURE_2D, _texture);
 
-    if (sampler.magFilter != SamplerFilter::DONT_CARE)
-    {
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, _textureInfo.magFilterGL);
-    }
+        if (sampler.magFilter != SamplerFilter::DONT_CARE)
+        {
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, textureInfo.magFilterGL);
+        }
 
-    if (sampler.minFilter != SamplerFilter::DONT_CARE)
-    {
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, _textureInfo.minFilterGL);
-    }
+        if (sampler.minFilter != SamplerFilter::DONT_CARE)
+        {
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, textureInfo.minFilterGL);
+        }
 
-    if (sampler.sAddressMode != SamplerAddressMode::DONT_CARE)
-    {
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, _textureInfo.sAddressModeGL);
-    }
+        if (sampler.sAddressMode != SamplerAddressMode::DONT_CARE)
+        {
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, textureInfo.sAddressModeGL);
+        }
 
-    if (sampler.tAddressMode != SamplerAddressMode::DONT_CARE)
-    {
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, _textureInfo.tAddressModeGL);
-    }
+        if (sampler.tAddressMode != SamplerAddressMode::DONT_CARE)
+        {
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, textureInfo.tAddressModeGL);
+        }
+    });
 }
 
 void Texture2DGL::updateData(uint8_t* data, std::size_t width , std::size_t height, std::size_t level)
 {
     //Set the row align only when mipmapsNum == 1 and the data is uncompressed
+    GLint alignment = 1;
     auto mipmapEnalbed = isMipmapEnabled(_textureInfo.minFilterGL) || isMipmapEnabled(_textureInfo.magFilterGL);
+    unsigned int bytesPerRow = width * _bitsPerElement / 8;
     if(!mipmapEnalbed)
     {
-        unsigned int bytesPerRow = width * _bitsPerElement / 8;
-
         if(bytesPerRow % 8 == 0)
         {
-            glPixelStorei(GL_UNPACK_ALIGNMENT, 8);
+            alignment = 8;
         }
         else if(bytesPerRow % 4 == 0)
         {
-            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+            alignment = 4;
         }
         else if(bytesPerRow % 2 == 0)
         {
-            glPixelStorei(GL_UNPACK_ALIGNMENT, 2);
-        }
-        else
-        {
-            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            alignment = 2;
         }
     }
-    else
-    {
-        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-    }
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, _textureInfo.texture);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, _textureInfo.magFilterGL);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, _textureInfo.minFilterGL);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, _textureInfo.sAddressModeGL);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, _textureInfo.tAddressModeGL);
-
-
-    glTexImage2D(GL_TEXTURE_2D,
-                level,
-                _textureInfo.internalFormat,
-                width,
-                height,
-                0,
-                _textureInfo.format,
-                _textureInfo.type,
-                data);
-    CHECK_GL_ERROR_DEBUG();
+    // Rows are tightly packed with the alignment above.
+    TextureInfoGL textureInfo = _textureInfo;
+    RenderThreadGL::run(this, data, bytesPerRow * height, [this, textureInfo, alignment, width, height, level](const void* data) {
+        glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+
+        StateCacheGL::bindTexture(GL_TEXTURE_2D, _texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, textureInfo.magFilterGL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, textureInfo.minFilterGL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, textureInfo.sAddressModeGL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, textureInfo.tAddressModeGL);
+
+
+        glTexImage2D(GL_TEXTURE_2D,
+                    level,
+                    textureInfo.internalFormat,
+                    width,
+                    height,
+                    0,
+                    textureInfo.format,
+                    textureInfo.type,
+                    data);
+        CHECK_GL_ERROR_DEBUG();
+    });
 
     if(!_hasMipmaps && level > 0)
         _hasMipmaps = true;
@@ -213,25 +261,27 @@ void Texture2DGL::updateData(uint8_t* data, std::size_t width , std::size_t heig
 void Texture2DGL::updateCompressedData(uint8_t *data, std::size_t width, std::size_t height,
                                        std::size_t dataLen, std::size_t level)
 {
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, _textureInfo.texture);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, _textureInfo.magFilterGL);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, _textureInfo.minFilterGL);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, _textureInfo.sAddressModeGL);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, _textureInfo.tAddressModeGL);
-
-
-    glCompressedTexImage2D(GL_TEXTURE_2D,
-                           level,
-                           _textureInfo.internalFormat,
-                           (GLsizei)width,
-                           (GLsizei)height,
-                           0,
-                           dataLen,
-                           data);
-    CHECK_GL_ERROR_DEBUG();
+    TextureInfoGL textureInfo = _textureInfo;
+    RenderThreadGL::run(this, data, dataLen, [this, textureInfo, width, height, dataLen, level](const void* data) {
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+        StateCacheGL::bindTexture(GL_TEXTURE_2D, _texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, textureInfo.magFilterGL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, textureInfo.minFilterGL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, textureInfo.sAddressModeGL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, textureInfo.tAddressModeGL);
+
+
+        glCompressedTexImage2D(GL_TEXTURE_2D,
+                               level,
+                               textureInfo.internalFormat,
+                               (GLsizei)width,
+                               (GLsizei)height,
+                               0,
+                               dataLen,
+                               data);
+        CHECK_GL_ERROR_DEBUG();
+    });
 
     if(!_hasMipmaps && level > 0)
         _hasMipmaps = true;
@@ -239,19 +289,23 @@ void Texture2DGL::updateCompressedData(uint8_t *data, std::size_t width, std::si
 
 void Texture2DGL::updateSubData(std::size_t xoffset, std::size_t yoffset, std::size_t width, std::size_t height, std::size_t level, uint8_t* data)
 {
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, _textureInfo.texture);
-
-    glTexSubImage2D(GL_TEXTURE_2D,
-                    level,
-                    xoffset,
-                    yoffset,
-                    width,
-                    height,
-                    _textureInfo.format,
-                    _textureInfo.type,
-                    data);
-    CHECK_GL_ERROR_DEBUG();
+    // The sub image is tightly packed, a recorded job only gets a copy of that many bytes.
+    TextureInfoGL textureInfo = _textureInfo;
+    RenderThreadGL::run(this, data, width * height * _bitsPerElement / 8, [this, textureInfo, xoffset, yoffset, width, height, level](const void* data) {
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        StateCacheGL::bindTexture(GL_TEXTURE_2D, _texture);
+
+        glTexSubImage2D(GL_TEXTURE_2D,
+                        level,
+                        xoffset,
+                        yoffset,
+                        width,
+                        height,
+                        textureInfo.format,
+                        textureInfo.type,
+                        data);
+        CHECK_GL_ERROR_DEBUG();
+    });
 
     if(!_hasMipmaps && level > 0)
         _hasMipmaps = true;
@@ -261,19 +315,21 @@ void Texture2DGL::updateCompressedSubData(std::size_t xoffset, std::size_t yoffs
                                           std::size_t height, std::size_t dataLen, std::size_t level,
                                           uint8_t *data)
 {
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, _textureInfo.texture);
-
-    glCompressedTexSubImage2D(GL_TEXTURE_2D,
-                              level,
-                              xoffset,
-                              yoffset,
-                              width,
-                              height,
-                              _textureInfo.format,
-                              dataLen,
-                              data);
-    CHECK_GL_ERROR_DEBUG();
+    TextureInfoGL textureInfo = _textureInfo;
+    RenderThreadGL::run(this, data, dataLen, [this, textureInfo, xoffset, yoffset, width, height, dataLen, level](const void* data) {
+        StateCacheGL::bindTexture(GL_TEXTURE_2D, _texture);
+
+        glCompressedTexSubImage2D(GL_TEXTURE_2D,
+                                  level,
+                                  xoffset,
+                                  yoffset,
+                                  width,
+                                  height,
+                                  textureInfo.format,
+                                  dataLen,
+                                  data);
+        CHECK_GL_ERROR_DEBUG();
+    });
 
     if(!_hasMipmaps && level > 0)
         _hasMipmaps = true;
@@ -281,8 +337,7 @@ void Texture2DGL::updateCompressedSubData(std::size_t xoffset, std::size_t yoffs
 
 void Texture2DGL::apply(int index) const
 {
-    glActiveTexture(GL_TEXTURE0 + index);
-    glBindTexture(GL_TEXTURE_2D, _textureInfo.texture);
+    StateCacheGL::bindTexture(GL_TEXTURE_2D, _texture, index);
 }
 
 void Texture2DGL::generateMipmaps()
@@ -293,46 +348,22 @@ void Texture2DGL::generateMipmaps()
     if(!_hasMipmaps)
     {
         _hasMipmaps = true;
-        glBindTexture(GL_TEXTURE_2D, _textureInfo.texture);
-        glGenerateMipmap(GL_TEXTURE_2D);
+        RenderThreadGL::run(this, [this]() {
+            StateCacheGL::bindTexture(GL_TEXTURE_2D, _texture);
+            glGenerateMipmap(GL_TEXTURE_2D);
+        });
     }
 }
 
 void Texture2DGL::getBytes(std::size_t x, std::size_t y, std::size_t width, std::size_t height, bool flipImage, std::function<void(const unsigned char*, std::size_t, std::size_t)> callback)
 {
-    GLint defaultFBO = 0;
-    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &defaultFBO);
-
-    GLuint frameBuffer = 0;
-    glGenFramebuffers(1, &frameBuffer);
-    glBindFramebuffer(GL_FRAMEBUFFER, frameBuffer);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _textureInfo.texture, 0);
-    glPixelStorei(GL_PACK_ALIGNMENT, 1);
-
     auto bytePerRow = width * _bitsPerElement / 8;
     unsigned char* image = new unsigned char[bytePerRow * height];
-    glReadPixels(x,y,width, height,GL_RGBA,GL_UNSIGNED_BYTE, image);
-
-    if(flipImage)
-    {
-        unsigned char* flippedImage = new unsigned char[bytePerRow * height];
-        for (int i = 0; i < height; ++i)
-        {
-            memcpy(&flippedImage[i * bytePerRow],
-                   &image[(height - i - 1) * bytePerRow],
-                   bytePerRow);
-        }
-		CC_SAFE_DELETE_ARRAY(image);
-        callback(flippedImage, width, height);
-        CC_SAFE_DELETE_ARRAY(flippedImage);
-    } else
-    {
-        callback(image, width, height);
-        CC_SAFE_DELETE_ARRAY(image);
-    }
-
-    glBindFramebuffer(GL_FRAMEBUFFER, defaultFBO);
-    glDeleteFramebuffers(1, &frameBuffer);
+    // The callback is invoked on the calling thread once the pixels are read.
+    RenderThreadGL::runSync([this, x, y, width, height, image]() {
+        readPixels(GL_TEXTURE_2D, _texture, x, y, width, height, image);
+    });
+    deliverPixels(image, bytePerRow, width, height, flipImage, callback);
 }
 
 TextureCubeGL::TextureCubeGL(const TextureDescriptor& descriptor)
@@ -341,13 +372,15 @@ TextureCubeGL::TextureCubeGL(const TextureDescriptor& descriptor)
     assert(_width == _height);
     _textureType = TextureType::TEXTURE_CUBE;
     UtilsGL::toGLTypes(_textureFormat, _textureInfo.internalFormat, _textureInfo.format, _textureInfo.type, _isCompressed);
-    glGenTextures(1, &_textureInfo.texture);
+    RenderThreadGL::run(this, [this]() {
+        glGenTextures(1, &_texture);
+    });
     updateSamplerDescriptor(descriptor.samplerDescriptor);
 
 #if CC_ENABLE_CACHE_TEXTURE_DATA
     // Listen this event to restored texture id after coming to foreground on Android.
     _backToForegroundListener = EventListenerCustom::create(EVENT_COME_TO_FOREGROUND, [this](EventCustom*){
-        glGenTextures(1, &(this->_textureInfo.texture));
+        glGenTextures(1, &(this->_texture));
         this->setTexParameters();
     });
     Director::getInstance()->getEventDispatcher()->addEventListenerWithFixedPriority(_backToForegroundListener, -1);
@@ -357,15 +390,17 @@ TextureCubeGL::TextureCubeGL(const TextureDescriptor& descriptor)
 
 void TextureCubeGL::setTexParameters()
 {
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, _textureInfo.texture);
+    TextureInfoGL textureInfo = _textureInfo;
+    RenderThreadGL::run(this, [this, textureInfo]() {
+        StateCacheGL::bindTexture(GL_TEXTURE_CUBE_MAP, _texture);
 
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, _textureInfo.minFilterGL);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, _textureInfo.magFilterGL);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, _textureInfo.sAddressModeGL);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, _textureInfo.tAddressModeGL);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, textureInfo.minFilterGL);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, textureInfo.magFilterGL);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, textureInfo.sAddressModeGL);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, textureInfo.tAddressModeGL);
 
-    glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+        StateCacheGL::bindTexture(GL_TEXTURE_CUBE_MAP, 0);
+    });
 }
 
 void TextureCubeGL::updateTextureDescriptor(const cocos2d::backend::TextureDescriptor &descriptor)
@@ -377,9 +412,13 @@ void TextureCubeGL::updateTextureDescriptor(const cocos2d::backend::TextureDescr
 
 TextureCubeGL::~TextureCubeGL()
 {
-    if(_textureInfo.texture)
-        glDeleteTextures(1, &_textureInfo.texture);
-    _textureInfo.texture = 0;
+    // Recorded jobs retain the texture, so they have all been executed when it is destroyed.
+    GLuint texture = _texture;
+    RenderThreadGL::run(nullptr, [texture]() {
+        if (texture)
+            StateCacheGL::deleteTexture(texture);
+    });
+    _texture = 0;
 
 #if CC_ENABLE_CACHE_TEXTURE_DATA
     Director::getInstance()->getEventDispatcher()->removeEventListener(_backToForegroundListener);
@@ -394,64 +433,43 @@ void TextureCubeGL::updateSamplerDescriptor(const SamplerDescriptor &sampler)
 
 void TextureCubeGL::apply(int index) const
 {
-    glActiveTexture(GL_TEXTURE0+ index);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, _textureInfo.texture);
+    StateCacheGL::bindTexture(GL_TEXTURE_CUBE_MAP, _texture, index);
     CHECK_GL_ERROR_DEBUG();
 }
 
 void TextureCubeGL::updateFaceData(TextureCubeFace side, void *data)
 {
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, _textureInfo.texture);
-    CHECK_GL_ERROR_DEBUG();
-    int i = static_cast<int>(side);
-    glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i,
-        0,                  // level
-        GL_RGBA,            // internal format
-        _width,              // width
-        _height,              // height
-        0,                  // border
-        _textureInfo.internalFormat,            // format
-        _textureInfo.type,  // type
-        data);              // pixel data
-
-    CHECK_GL_ERROR_DEBUG();
-    glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+    TextureInfoGL textureInfo = _textureInfo;
+    std::size_t width = _width;
+    std::size_t height = _height;
+    RenderThreadGL::run(this, data, width * height * _bitsPerElement / 8, [this, textureInfo, side, width, height](const void* data) {
+        StateCacheGL::bindTexture(GL_TEXTURE_CUBE_MAP, _texture);
+        CHECK_GL_ERROR_DEBUG();
+        int i = static_cast<int>(side);
+        glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i,
+            0,                  // level
+            GL_RGBA,            // internal format
+            width,              // width
+            height,              // height
+            0,                  // border
+            textureInfo.internalFormat,            // format
+            textureInfo.type,  // type
+            data);              // pixel data
+
+        CHECK_GL_ERROR_DEBUG();
+        StateCacheGL::bindTexture(GL_TEXTURE_CUBE_MAP, 0);
+    });
 }
 
 void TextureCubeGL::getBytes(std::size_t x, std::size_t y, std::size_t width, std::size_t height, bool flipImage, std::function<void(const unsigned char*, std::size_t, std::size_t)> callback)
 {
-    GLint defaultFBO = 0;
-    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &defaultFBO);
-    GLuint frameBuffer = 0;
-    glGenFramebuffers(1, &frameBuffer);
-    glBindFramebuffer(GL_FRAMEBUFFER, frameBuffer);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP, _textureInfo.texture, 0);
-    glPixelStorei(GL_PACK_ALIGNMENT, 1);
-
     auto bytePerRow = width * _bitsPerElement / 8;
     unsigned char* image = new unsigned char[bytePerRow * height];
-    glReadPixels(x,y,width, height,GL_RGBA,GL_UNSIGNED_BYTE, image);
-
-    if(flipImage)
-    {
-        unsigned char* flippedImage = new unsigned char[bytePerRow * height];
-        for (int i = 0; i < height; ++i)
-        {
-            memcpy(&flippedImage[i * bytePerRow],
-                   &image[(height - i - 1) * bytePerRow],
-                   bytePerRow);
-        }
-        callback(flippedImage, width, height);
-        CC_SAFE_DELETE_ARRAY(flippedImage);
-    } else
-    {
-        callback(image, width, height);
-        CC_SAFE_DELETE_ARRAY(image);
-    }
-
-    glBindFramebuffer(GL_FRAMEBUFFER, defaultFBO);
-    glDeleteFramebuffers(1, &frameBuffer);
+    // The callback is invoked on the calling thread once the pixels are read.
+    RenderThreadGL::runSync([this, x, y, width, height, image]() {
+        readPixels(GL_TEXTURE_CUBE_MAP, _texture, x, y, width, height, image);
+    });
+    deliverPixels(image, bytePerRow, width, height, flipImage, callback);
 }
 
 void TextureCubeGL::generateMipmaps()
@@ -462,8 +480,10 @@ void TextureCubeGL::generateMipmaps()
     if(!_hasMipmaps)
     {
         _hasMipmaps = true;
-        glBindTexture(GL_TEXTURE_CUBE_MAP, _textureInfo.texture);
-        glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
+        RenderThreadGL::run(this, [this]() {
+            StateCacheGL::bindTexture(GL_TEXTURE_CUBE_MAP, _texture);
+            glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
+        });
     }
 }
 
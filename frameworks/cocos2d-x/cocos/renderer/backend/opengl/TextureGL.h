@@ -46,8 +46,6 @@ struct TextureInfoGL
     GLint internalFormat = GL_RGBA;
     GLenum format = GL_RGBA;
     GLenum type = GL_UNSIGNED_BYTE;
-
-    GLuint texture = 0;
 };
 
 /**
@@ -139,7 +137,7 @@ public:
      * Get texture object.
      * @return Texture object.
      */
-    inline GLuint getHandler() const { return _textureInfo.texture; }
+    inline GLuint getHandler() const { return _texture; }
 
     /**
      * Set texture to pipeline
@@ -151,6 +149,8 @@ private:
     void initWithZeros();
 
     TextureInfoGL _textureInfo;
+    // Only touched by the thread executing GL commands, see RenderThreadGL.
+    GLuint _texture = 0;
     EventListener* _backToForegroundListener = nullptr;
 };
 
@@ -201,7 +201,7 @@ public:
      * Get texture object.
      * @return Texture object.
      */
-    inline GLuint getHandler() const { return _textureInfo.texture; }
+    inline GLuint getHandler() const { return _texture; }
 
     /**
      * Set texture to pipeline
@@ -213,6 +213,8 @@ private:
     void setTexParameters();
 
     TextureInfoGL _textureInfo;
+    // Only touched by the thread executing GL commands, see RenderThreadGL.
+    GLuint _texture = 0;
     EventListener* _backToForegroundListener = nullptr;
 };
 
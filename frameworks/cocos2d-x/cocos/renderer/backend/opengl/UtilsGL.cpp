@@ -25,6 +25,7 @@
 #include "UtilsGL.h"
 #include "ProgramGL.h"
 #include "renderer/backend/Types.h"
+#include "base/CCConfiguration.h"
 
 CC_BACKEND_BEGIN
 
@@ -554,4 +555,29 @@ GLenum UtilsGL::toGLCullMode(CullMode mode)
         return GL_FRONT;
 }
 
+bool UtilsGL::supportsStreamingBuffer()
+{
+#if CC_TARGET_PLATFORM == CC_PLATFORM_WIN32 || CC_TARGET_PLATFORM == CC_PLATFORM_LINUX
+    static const bool supported = (GLEW_VERSION_3_0 || GLEW_ARB_map_buffer_range) && (GLEW_VERSION_3_2 || GLEW_ARB_sync);
+    return supported;
+#else
+    return false;
+#endif
+}
+
+bool UtilsGL::supportsVertexArrayObject()
+{
+#if CC_TARGET_PLATFORM == CC_PLATFORM_WIN32 || CC_TARGET_PLATFORM == CC_PLATFORM_LINUX
+    static const bool supported = Configuration::getInstance()->supportsShareableVAO() && (GLEW_VERSION_3_0 || GLEW_ARB_vertex_array_object);
+    return supported;
+#elif CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID
+    // The OES entry points are loaded at runtime, see initExtensions() in CCGLViewImpl-android.cpp.
+    static const bool supported = Configuration::getInstance()->supportsShareableVAO() &&
+                                  glGenVertexArraysOESEXT && glBindVertexArrayOESEXT && glDeleteVertexArraysOESEXT;
+    return supported;
+#else
+    return false;
+#endif
+}
+
 CC_BACKEND_END
\ No newline at end of file
@@ -152,6 +152,20 @@ public:
      * @return Cull mode.
      */
     static GLenum toGLCullMode(CullMode mode);
+
+    /**
+     * Whether BufferUsage::STREAM buffers can be written with unsynchronized glMapBufferRange, which needs
+     * glMapBufferRange and fence sync objects to keep frames in flight from being overwritten.
+     * @return true if supported, otherwise false.
+     */
+    static bool supportsStreamingBuffer();
+
+    /**
+     * Whether vertex array objects can be used, either by GL 3.0 or by the OES/ARB vertex_array_object extension.
+     * Can be turned off by defining CC_TEXTURE_ATLAS_USE_VAO as 0.
+     * @return true if supported, otherwise false.
+     */
+    static bool supportsVertexArrayObject();
 };
 //end of _opengl group
 /// @}
@@ -31,10 +31,38 @@ precision lowp float;
 varying vec4 v_fragmentColor;
 varying vec2 v_texCoord;
 
+#ifdef MULTI_TEXTURE
+#ifdef GL_ES
+varying mediump float v_textureSlot;
+#else
+varying float v_textureSlot;
+#endif
+
+uniform sampler2D u_textures[8];
+
+// Sampler arrays can only be indexed by constant expressions in GLSL ES 1.00.
+vec4 textureSlot(float slot, vec2 texCoord)
+{
+    if (slot < 3.5)
+    {
+        if (slot < 1.5)
+            return slot < 0.5 ? texture2D(u_textures[0], texCoord) : texture2D(u_textures[1], texCoord);
+        return slot < 2.5 ? texture2D(u_textures[2], texCoord) : texture2D(u_textures[3], texCoord);
+    }
+    if (slot < 5.5)
+        return slot < 4.5 ? texture2D(u_textures[4], texCoord) : texture2D(u_textures[5], texCoord);
+    return slot < 6.5 ? texture2D(u_textures[6], texCoord) : texture2D(u_textures[7], texCoord);
+}
+#else
 uniform sampler2D u_texture;
+#endif
 
 void main()
 {
+#ifdef MULTI_TEXTURE
+    gl_FragColor = v_fragmentColor * textureSlot(v_textureSlot, v_texCoord);
+#else
     gl_FragColor = v_fragmentColor * texture2D(u_texture, v_texCoord);
+#endif
 }
 )";
@@ -38,11 +38,23 @@ varying vec4 v_fragmentColor;
 varying vec2 v_texCoord;
 #endif
 
+#ifdef MULTI_TEXTURE
+attribute float a_textureSlot;
+#ifdef GL_ES
+varying mediump float v_textureSlot;
+#else
+varying float v_textureSlot;
+#endif
+#endif
+
 void main()
 {
     gl_Position = u_MVPMatrix * a_position;
     v_fragmentColor = a_color;
     v_texCoord = a_texCoord;
+#ifdef MULTI_TEXTURE
+    v_textureSlot = a_textureSlot;
+#endif
 }
 )";
 
@@ -34,6 +34,8 @@
 #include "base/CCDirector.h"
 #include "base/CCEventCustom.h"
 
+#include <chrono>
+
 #pragma comment(lib,"lua51.lib")
 
 NS_CC_BEGIN
@@ -265,6 +267,12 @@ int LuaEngine::handleScheduler(void* data)
         return 0;
     
     SchedulerScriptData* schedulerInfo = static_cast<SchedulerScriptData*>(data);
+
+    if (_scheduleBatching)
+    {
+        _scheduleBatch.push_back({schedulerInfo->handler, schedulerInfo->elapse});
+        return 0;
+    }
     
     _stack->pushFloat(schedulerInfo->elapse);
     int ret = _stack->executeFunctionByHandler(schedulerInfo->handler, 1);
@@ -273,6 +281,142 @@ int LuaEngine::handleScheduler(void* data)
     return ret;
 }
 
+// Calls the handlers of the queue, looked up when called so that a handler released by an earlier one is skipped.
+// The xpcall of Lua 5.1 doesn't pass arguments to the function, LuaJIT's does.
+static const char* s_scheduleDispatcherSource =
+    "local xpcall = xpcall\n"
+    "local call = jit and xpcall or function(func, traceback, dt)\n"
+    "    return xpcall(function() return func(dt) end, traceback)\n"
+    "end\n"
+    "local function logError(msg)\n"
+    "    print(\"[LUA ERROR] \" .. tostring(msg))\n"
+    "end\n"
+    "return function(functions, traceback, queue, count)\n"
+    "    traceback = traceback or logError\n"
+    "    for i = 1, count * 2, 2 do\n"
+    "        local func = functions[queue[i]]\n"
+    "        if func then\n"
+    "            call(func, traceback, queue[i + 1])\n"
+    "        end\n"
+    "    end\n"
+    "end\n";
+
+void LuaEngine::beginScheduleBatch()
+{
+    _scheduleBatching = _scheduleBatchEnabled;
+}
+
+void LuaEngine::endScheduleBatch()
+{
+    if (!_scheduleBatching)
+        return;
+    _scheduleBatching = false;
+    if (_scheduleBatch.empty())
+        return;
+
+    lua_State* L = _stack->getLuaState();
+    if (_scheduleDispatcher == LUA_NOREF)
+    {
+        if (luaL_loadbuffer(L, s_scheduleDispatcherSource, strlen(s_scheduleDispatcherSource), "=scheduleDispatcher") != 0
+            || lua_pcall(L, 0, 1, 0) != 0)
+        {
+            CCLOG("[LUA ERROR] %s", lua_tostring(L, -1));
+            lua_pop(L, 1);
+            // call the handlers one by one from now on
+            _scheduleBatchEnabled = false;
+            auto batch = std::move(_scheduleBatch);
+            _scheduleBatch.clear();
+            for (const auto& call : batch)
+            {
+                SchedulerScriptData data(call.handler, call.elapse);
+                handleScheduler(&data);
+            }
+            return;
+        }
+        _scheduleDispatcher = luaL_ref(L, LUA_REGISTRYINDEX);
+        lua_newtable(L);
+        _scheduleQueue = luaL_ref(L, LUA_REGISTRYINDEX);
+    }
+
+    lua_rawgeti(L, LUA_REGISTRYINDEX, _scheduleDispatcher);              /* L: dispatcher */
+    lua_pushstring(L, TOLUA_REFID_FUNCTION_MAPPING);
+    lua_rawget(L, LUA_REGISTRYINDEX);                                   /* L: dispatcher functions */
+    lua_getglobal(L, "__G__TRACKBACK__");                               /* L: dispatcher functions G */
+    // a callback updating another scheduler dispatches again while the outer queue is read, give it its own table
+    if (_scheduleDispatchDepth > 0)
+        lua_createtable(L, (int)_scheduleBatch.size() * 2, 0);         /* L: dispatcher functions G queue */
+    else
+        lua_rawgeti(L, LUA_REGISTRYINDEX, _scheduleQueue);               /* L: dispatcher functions G queue */
+    int index = 1;
+    for (const auto& call : _scheduleBatch)
+    {
+        lua_pushinteger(L, call.handler);
+        lua_rawseti(L, -2, index++);                  /* queue[index] = handler */
+        lua_pushnumber(L, call.elapse);
+        lua_rawseti(L, -2, index++);                  /* queue[index] = elapse */
+    }
+    lua_pushinteger(L, (lua_Integer)_scheduleBatch.size());             /* L: dispatcher functions G queue count */
+    // the callbacks may schedule others, which are due from the next frame
+    _scheduleBatch.clear();
+    ++_scheduleDispatchDepth;
+    _stack->executeFunction(4);
+    --_scheduleDispatchDepth;
+    _stack->clean();
+}
+
+void LuaEngine::setGCPause(int pause)
+{
+    _gcPause = pause;
+    lua_gc(_stack->getLuaState(), LUA_GCSETPAUSE, pause);
+}
+
+void LuaEngine::setGCStepMul(int stepMul)
+{
+    lua_gc(_stack->getLuaState(), LUA_GCSETSTEPMUL, stepMul);
+}
+
+void LuaEngine::collectGarbageInIdleTime(float idleTime)
+{
+    lua_State* L = _stack->getLuaState();
+    _gcStats.frameTime = 0;
+    _gcStats.frameSteps = 0;
+
+    auto budget = std::min((long long)_gcBudget, (long long)(idleTime * 1000000));
+    int count = lua_gc(L, LUA_GCCOUNT, 0);
+    if (_gcCycleEndCount == 0)
+    {
+        _gcCycleEndCount = count;
+    }
+    // a step starts a new cycle when the collector is paused, start it before the allocations would,
+    // once the memory has grown by half of the pause
+    if (budget > 0 && !_gcInCycle)
+    {
+        _gcInCycle = (long long)count * 100 >= (long long)_gcCycleEndCount * (100 + (_gcPause - 100) / 2);
+    }
+
+    if (budget > 0 && _gcInCycle)
+    {
+        auto start = std::chrono::steady_clock::now();
+        long long elapsed = 0;
+        do
+        {
+            ++_gcStats.frameSteps;
+            if (lua_gc(L, LUA_GCSTEP, 0))
+            {
+                _gcInCycle = false;
+                ++_gcStats.cycles;
+                _gcCycleEndCount = lua_gc(L, LUA_GCCOUNT, 0);
+            }
+            elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        } while (_gcInCycle && elapsed < budget);
+
+        _gcStats.frameTime = (int)elapsed;
+        _gcStats.maxFrameTime = std::max(_gcStats.maxFrameTime, _gcStats.frameTime);
+        count = lua_gc(L, LUA_GCCOUNT, 0);
+    }
+    _gcStats.count = count;
+}
+
 int LuaEngine::handleCommonEvent(void* data)
 {
     if (NULL == data)
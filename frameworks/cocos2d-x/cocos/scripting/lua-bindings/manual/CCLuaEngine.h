@@ -191,9 +191,108 @@ public:
      * @return default return 0 otherwise return values according different ScriptHandlerMgr::HandlerType.
      */
     virtual int handleEvent(ScriptHandlerMgr::HandlerType type,void* data);
+
+    /**
+     * Enable or disable the batched dispatch of the schedule callbacks, enabled by default.
+     * When enabled, the callbacks scheduled by Scheduler::scheduleScriptFunc which are due in a frame are
+     * queued and called by a Lua dispatcher within a single lua_pcall, each under its own xpcall with __G__TRACKBACK__.
+     *
+     * @param enabled true to batch the schedule callbacks, false to call them one by one.
+     */
+    void setScheduleBatchEnabled(bool enabled) { _scheduleBatchEnabled = enabled; }
+
+    /**
+     * Whether the schedule callbacks are dispatched in batch.
+     *
+     * @return true if the schedule callbacks are dispatched in batch.
+     */
+    bool isScheduleBatchEnabled() const { return _scheduleBatchEnabled; }
+
+    /**
+     * Start queuing the schedule callbacks, called by the Scheduler.
+     *
+     * @lua NA
+     * @js NA
+     */
+    virtual void beginScheduleBatch() override;
+
+    /**
+     * Call the queued schedule callbacks, called by the Scheduler.
+     *
+     * @lua NA
+     * @js NA
+     */
+    virtual void endScheduleBatch() override;
+
+    /**
+     * Statistics of the garbage collection steps run in the idle time of the frames.
+     * The collections triggered by the allocations are not counted.
+     */
+    struct GCStats
+    {
+        int frameTime = 0;      ///< Time spent in the last frame, in microseconds.
+        int maxFrameTime = 0;   ///< Longest time spent in a frame, in microseconds.
+        int frameSteps = 0;     ///< Steps run in the last frame.
+        unsigned int cycles = 0; ///< Collection cycles finished in the idle time.
+        int count = 0;          ///< Memory used by Lua after the last frame, in KB.
+    };
+
+    /**
+     * Set the time the garbage collector may run in the idle time left at the end of each frame.
+     * The collector still runs when the allocations trigger it, the idle steps make it rarely needed.
+     *
+     * @param budget The maximum time per frame in microseconds, 0 to disable the idle steps. 1000 by default.
+     */
+    void setGCBudget(int budget) { _gcBudget = budget; }
+
+    /**
+     * Get the time the garbage collector may run in the idle time of each frame.
+     *
+     * @return The maximum time per frame in microseconds.
+     */
+    int getGCBudget() const { return _gcBudget; }
+
+    /**
+     * Set the pause of the Lua garbage collector, see collectgarbage("setpause").
+     * The idle steps start a new cycle once the memory has grown by half of the pause.
+     *
+     * @param pause The growth of the memory in percent before a new cycle starts.
+     */
+    void setGCPause(int pause);
+
+    /**
+     * Set the step multiplier of the Lua garbage collector, see collectgarbage("setstepmul").
+     *
+     * @param stepMul The speed of the collector relative to the allocations, in percent.
+     */
+    void setGCStepMul(int stepMul);
+
+    /**
+     * Get the statistics of the idle garbage collection.
+     *
+     * @return The statistics, updated at the end of each frame.
+     */
+    const GCStats& getGCStats() const { return _gcStats; }
+
+    /**
+     * Run garbage collection steps within the idle time of the frame and the GC budget, called by the Director.
+     *
+     * @lua NA
+     * @js NA
+     */
+    virtual void collectGarbageInIdleTime(float idleTime) override;
 private:
     LuaEngine(void)
     : _stack(nullptr)
+    , _scheduleBatchEnabled(true)
+    , _scheduleBatching(false)
+    , _scheduleDispatcher(LUA_NOREF)
+    , _scheduleQueue(LUA_NOREF)
+    , _scheduleDispatchDepth(0)
+    , _gcBudget(1000)
+    , _gcPause(200)
+    , _gcInCycle(false)
+    , _gcCycleEndCount(0)
     {
     }
     bool init(void);
@@ -215,6 +314,28 @@ private:
 private:
     static LuaEngine* _defaultEngine;
     LuaStack *_stack;
+
+    // schedule callbacks due in the current frame: handler and elapsed time
+    struct ScheduledCall
+    {
+        int handler;
+        float elapse;
+    };
+    std::vector<ScheduledCall> _scheduleBatch;
+    bool _scheduleBatchEnabled;
+    bool _scheduleBatching;
+    // registry references of the Lua dispatcher and of the table reused to pass the queue
+    int _scheduleDispatcher;
+    int _scheduleQueue;
+    // number of dispatches running, only the outermost one uses _scheduleQueue
+    int _scheduleDispatchDepth;
+
+    int _gcBudget;
+    int _gcPause;
+    // whether the idle steps are in the middle of a cycle, and the memory in KB when they finished the last one
+    bool _gcInCycle;
+    int _gcCycleEndCount;
+    GCStats _gcStats;
 };
 
 NS_CC_END
@@ -47,12 +47,18 @@ extern "C" {
 #include "scripting/lua-bindings/manual/cocos2d/LuaScriptHandlerMgr.h"
 #include "scripting/lua-bindings/auto/lua_cocos2dx_auto.hpp"
 #include "scripting/lua-bindings/manual/cocos2d/lua_cocos2dx_manual.hpp"
+#include "scripting/lua-bindings/manual/cocos2d/lua_cocos2dx_ffi_manual.hpp"
 #include "scripting/lua-bindings/manual/LuaBasicConversions.h"
 #include "scripting/lua-bindings/auto/lua_cocos2dx_physics_auto.hpp"
 #include "scripting/lua-bindings/manual/cocos2d/lua_cocos2dx_physics_manual.hpp"
 #include "scripting/lua-bindings/auto/lua_cocos2dx_backend_auto.hpp"
 #include "base/ZipUtils.h"
 #include "platform/CCFileUtils.h"
+#include "platform/CCFileArchive.h"
+#include "scripting/lua-bindings/manual/CCLuaEngine.h"
+#include "base/ccUTF8.h"
+#include "xxhash.h"
+#include <chrono>
 
 namespace {
     int get_string_for_print(lua_State * L, std::string* out)
@@ -142,6 +148,7 @@ bool LuaStack::init()
     register_all_cocos2dx_backend(_state);
     register_all_cocos2dx_manual(_state);
     register_all_cocos2dx_module_manual(_state);
+    register_all_cocos2dx_ffi_manual(_state);
     register_all_cocos2dx_math_manual(_state);
     register_all_cocos2dx_shaders_manual(_state);
     register_all_cocos2dx_bytearray_manual(_state);
@@ -608,16 +615,23 @@ int LuaStack::reload(const char* moduleFileName)
     return executeString(require.c_str());
 }
 
-int LuaStack::loadChunksFromZIP(const char *zipFilePath)
+// A zip of Lua chunks, mapped for as long as one of its chunks can be required.
+struct LuaStack::ZipChunkSource
+{
+    Data data;
+    std::unique_ptr<ZipFile> zip;
+};
+
+int LuaStack::loadChunksFromZIP(const char *zipFilePath, bool lazy)
 {
     pushString(zipFilePath);
-    luaLoadChunksFromZIP(_state);
+    luaLoadChunksFromZIP(_state, lazy);
     int ret = lua_toboolean(_state, -1);
     lua_pop(_state, 1);
     return ret;
 }
 
-int LuaStack::luaLoadChunksFromZIP(lua_State *L)
+int LuaStack::luaLoadChunksFromZIP(lua_State *L, bool lazy)
 {
     if (lua_gettop(L) < 1) {
         CCLOG("luaLoadChunksFromZIP() - invalid arguments");
@@ -630,6 +644,53 @@ int LuaStack::luaLoadChunksFromZIP(lua_State *L)
     FileUtils *utils = FileUtils::getInstance();
     std::string zipFilePath = utils->fullPathForFilename(zipFilename);
 
+    // The mapped zip bypasses the file data decoder, an encoded zip is decoded and compiled at once.
+    if (lazy && !utils->getFileDataDecoder()) {
+        std::shared_ptr<ZipChunkSource> source = std::make_shared<ZipChunkSource>();
+        source->data = FileArchive::mapFile(zipFilePath);
+        if (source->data.getSize() > 0)
+            source->zip.reset(ZipFile::createWithBuffer(source->data.getBytes(), (unsigned long)source->data.getSize()));
+
+        if (!source->zip) {
+            CCLOG("lua_loadChunksFromZIP() - not found or invalid zip file: %s", zipFilePath.c_str());
+            lua_pushboolean(L, 0);
+            return 1;
+        }
+
+        CCLOG("lua_loadChunksFromZIP() - map zip file: %s", zipFilePath.c_str());
+        lua_getglobal(L, "package");
+        lua_getfield(L, -1, "loaded");
+
+        int count = 0;
+        std::string filename = source->zip->getFirstFilename();
+        while (filename.length()) {
+            // special fix for protobuf find path in zip.
+            int offset = 0;
+            if (filename.find("framework.protobuf.") != std::string::npos) {
+                offset = 19;
+            }
+            const char *moduleName = filename.c_str() + offset;
+            ZipChunk& chunk = _zipChunks[moduleName];
+            chunk.source = source;
+            chunk.entryName = filename;
+            // clear loaded, make the next require run the new module.
+            lua_pushnil(L);
+            lua_setfield(L, -2, moduleName);
+            ++count;
+            filename = source->zip->getNextFilename();
+        }
+        lua_pop(L, 2);
+
+        if (!_lazyZipLoaderAdded) {
+            // before cocos2dx_lua_loader, the chunks of the zip replace the script files
+            addLuaLoader(lazyZipChunkLoader);
+            _lazyZipLoaderAdded = true;
+        }
+        CCLOG("lua_loadChunksFromZIP() - registered chunks count: %d", count);
+        lua_pushboolean(L, 1);
+        return 1;
+    }
+
     do {
         ZipFile *zip = nullptr;
         Data zipFileData(utils->getDataFromFile(zipFilePath));
@@ -682,8 +743,45 @@ int LuaStack::luaLoadChunksFromZIP(lua_State *L)
     return 1;
 }
 
+int LuaStack::lazyZipChunkLoader(lua_State *L)
+{
+    const char *moduleName = luaL_checkstring(L, 1);
+    LuaStack *stack = LuaEngine::getInstance()->getLuaStack();
+    auto iter = stack->_zipChunks.find(moduleName);
+    if (iter == stack->_zipChunks.end())
+        return 0;
+
+    const ZipChunk& chunk = iter->second;
+    ResizableBufferAdapter<std::vector<char> > buffer(&stack->_zipChunkBuffer);
+    if (!chunk.source->zip->getFileData(chunk.entryName, &buffer) || stack->_zipChunkBuffer.empty()) {
+        CCLOG("can not get file data of %s", chunk.entryName.c_str());
+        return 0;
+    }
+
+    stack->luaLoadBuffer(L, stack->_zipChunkBuffer.data(), (int)stack->_zipChunkBuffer.size(), chunk.entryName.c_str());
+    return 1;
+}
+
 namespace {
 
+const std::string BYTECODE_CACHE_FOLDER = "luabytecode/";
+const char BYTECODE_CACHE_MAGIC[4] = { 'C', 'C', 'B', 'C' };
+// magic and compile time of the source in microseconds
+const size_t BYTECODE_CACHE_HEADER_SIZE = 8;
+// cache file names start with the hash of the chunk name
+const size_t BYTECODE_CACHE_NAME_HASH_LENGTH = 8;
+
+int writeBytecode(lua_State* L, const void* p, size_t sz, void* ud)
+{
+    static_cast<std::string*>(ud)->append(static_cast<const char*>(p), sz);
+    return 0;
+}
+
+double millisecondsSince(const std::chrono::steady_clock::time_point& start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
 void skipBOM(const char*& chunk, int& chunkSize)
 {
     // UTF-8 BOM? skip
@@ -698,11 +796,151 @@ void skipBOM(const char*& chunk, int& chunkSize)
 
 } // end anonymous namespace
 
+void LuaStack::setBytecodeCacheEnabled(bool enabled)
+{
+    _bytecodeCacheEnabled = false;
+    _bytecodeCacheStats = BytecodeCacheStats();
+    _bytecodeCacheFiles.clear();
+    if (!enabled)
+        return;
+
+    // bytecode only loads in the VM which wrote it
+    std::string version(LUA_RELEASE);
+    lua_getglobal(_state, "jit");
+    if (lua_istable(_state, -1))
+    {
+        lua_getfield(_state, -1, "version");
+        lua_getfield(_state, -2, "arch");
+        if (lua_isstring(_state, -2) && lua_isstring(_state, -1))
+            version = StringUtils::format("%s %s", lua_tostring(_state, -2), lua_tostring(_state, -1));
+        lua_pop(_state, 2);
+    }
+    lua_pop(_state, 1);
+    version += StringUtils::format(" %d", (int)sizeof(void*) * 8);
+
+    FileUtils *utils = FileUtils::getInstance();
+    const std::string root = utils->getWritablePath() + BYTECODE_CACHE_FOLDER;
+    _bytecodeCachePath = root + StringUtils::format("%08x/", XXH32(version.data(), (int)version.size(), 0));
+    if (!utils->isDirectoryExist(_bytecodeCachePath))
+    {
+        // drop the cache of the previous VM
+        if (utils->isDirectoryExist(root))
+            utils->removeDirectory(root);
+        if (!utils->createDirectory(_bytecodeCachePath))
+        {
+            CCLOG("LuaStack: can't create the bytecode cache %s", _bytecodeCachePath.c_str());
+            return;
+        }
+    }
+    else
+    {
+        // list the cache once, the stale versions of a chunk are removed when it is loaded
+        for (const auto& file : utils->listFiles(_bytecodeCachePath))
+        {
+            const size_t slash = file.find_last_of('/');
+            const std::string fileName = slash == std::string::npos ? file : file.substr(slash + 1);
+            if (fileName.size() > BYTECODE_CACHE_NAME_HASH_LENGTH)
+                _bytecodeCacheFiles[fileName.substr(0, BYTECODE_CACHE_NAME_HASH_LENGTH)].push_back(fileName);
+        }
+    }
+    _bytecodeCacheEnabled = true;
+}
+
+void LuaStack::clearBytecodeCache()
+{
+    FileUtils *utils = FileUtils::getInstance();
+    const std::string root = utils->getWritablePath() + BYTECODE_CACHE_FOLDER;
+    if (utils->isDirectoryExist(root))
+        utils->removeDirectory(root);
+    _bytecodeCacheFiles.clear();
+    if (_bytecodeCacheEnabled && !utils->createDirectory(_bytecodeCachePath))
+        _bytecodeCacheEnabled = false;
+}
+
+int LuaStack::luaLoadCachedBuffer(lua_State *L, const char *chunk, int chunkSize, const char *chunkName)
+{
+    // keyed by name, contents and size of the source
+    const unsigned int nameHash = XXH32(chunkName, (int)strlen(chunkName), 0);
+    const std::string namePrefix = StringUtils::format("%08x", nameHash);
+    const std::string cacheFile = _bytecodeCachePath + namePrefix + StringUtils::format("%08x%x.bc",
+        XXH32(chunk, chunkSize, nameHash), chunkSize);
+    FileUtils *utils = FileUtils::getInstance();
+
+    auto start = std::chrono::steady_clock::now();
+    Data cached;
+    if (utils->isFileExist(cacheFile) && utils->getContents(cacheFile, &cached) == FileUtils::Status::OK)
+    {
+        const unsigned char *bytes = cached.getBytes();
+        int cachedStatus = -1; // not loaded
+        if (cached.getSize() > (ssize_t)BYTECODE_CACHE_HEADER_SIZE && memcmp(bytes, BYTECODE_CACHE_MAGIC, sizeof(BYTECODE_CACHE_MAGIC)) == 0)
+        {
+            cachedStatus = luaL_loadbuffer(L, (const char*)bytes + BYTECODE_CACHE_HEADER_SIZE,
+                                           (size_t)cached.getSize() - BYTECODE_CACHE_HEADER_SIZE, chunkName);
+        }
+        if (cachedStatus == 0)
+        {
+            const uint32_t compileMicroseconds = (uint32_t)bytes[4] | ((uint32_t)bytes[5] << 8) | ((uint32_t)bytes[6] << 16) | ((uint32_t)bytes[7] << 24);
+            const double milliseconds = millisecondsSince(start);
+            ++_bytecodeCacheStats.hits;
+            _bytecodeCacheStats.loadMilliseconds += milliseconds;
+            _bytecodeCacheStats.savedMilliseconds += compileMicroseconds / 1000.0 - milliseconds;
+            pruneBytecodeCache(namePrefix, cacheFile.substr(_bytecodeCachePath.size()));
+            return 0;
+        }
+        // truncated or corrupted, compile it again
+        if (cachedStatus > 0)
+            lua_pop(L, 1); // error message
+        ++_bytecodeCacheStats.failures;
+    }
+
+    start = std::chrono::steady_clock::now();
+    int r = luaL_loadbuffer(L, chunk, chunkSize, chunkName);
+    if (r)
+        return r;
+    const double milliseconds = millisecondsSince(start);
+    ++_bytecodeCacheStats.misses;
+    _bytecodeCacheStats.compileMilliseconds += milliseconds;
+
+    const uint32_t compileMicroseconds = (uint32_t)(milliseconds * 1000.0);
+    std::string bytecode(BYTECODE_CACHE_MAGIC, sizeof(BYTECODE_CACHE_MAGIC));
+    for (int i = 0; i < 4; ++i)
+        bytecode.push_back((char)((compileMicroseconds >> (i * 8)) & 0xff));
+    if (lua_dump(L, writeBytecode, &bytecode) != 0 || !utils->writeStringToFile(bytecode, cacheFile))
+    {
+        CCLOG("LuaStack: can't cache the bytecode of %s", chunkName);
+        ++_bytecodeCacheStats.failures;
+        return r;
+    }
+
+    pruneBytecodeCache(namePrefix, cacheFile.substr(_bytecodeCachePath.size()));
+    return r;
+}
+
+void LuaStack::pruneBytecodeCache(const std::string& namePrefix, const std::string& cacheFileName)
+{
+    auto it = _bytecodeCacheFiles.find(namePrefix);
+    if (it == _bytecodeCacheFiles.end())
+        return;
+
+    // the source changed, drop the bytecode of its previous versions
+    FileUtils *utils = FileUtils::getInstance();
+    for (const auto& fileName : it->second)
+    {
+        if (fileName != cacheFileName)
+            utils->removeFile(_bytecodeCachePath + fileName);
+    }
+    _bytecodeCacheFiles.erase(it);
+}
+
 int LuaStack::luaLoadBuffer(lua_State *L, const char *chunk, int chunkSize, const char *chunkName)
 {
     int r = 0;
     skipBOM(chunk, chunkSize);
-    r = luaL_loadbuffer(L, chunk, chunkSize, chunkName);
+    // LuaJIT and Lua bytecode start with ESC
+    if (_bytecodeCacheEnabled && chunkSize > 0 && chunk[0] != '\x1b')
+        r = luaLoadCachedBuffer(L, chunk, chunkSize, chunkName);
+    else
+        r = luaL_loadbuffer(L, chunk, chunkSize, chunkName);
 
 #if defined(COCOS2D_DEBUG) && COCOS2D_DEBUG > 0
     if (r)
@@ -27,6 +27,11 @@
 #ifndef __CC_LUA_STACK_H_
 #define __CC_LUA_STACK_H_
 
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+
 extern "C" {
 #include "lua.h"
 }
@@ -290,22 +295,66 @@ public:
      * @return 0, LUA_ERRSYNTAX or LUA_ERRMEM:.
      */
     int luaLoadBuffer(lua_State *L, const char *chunk, int chunkSize, const char *chunkName);
+
+    /**
+     * Counters of the bytecode cache, see setBytecodeCacheEnabled.
+     */
+    struct BytecodeCacheStats
+    {
+        unsigned int hits = 0;         ///< Chunks loaded from the cache.
+        unsigned int misses = 0;       ///< Chunks compiled from source then written to the cache.
+        unsigned int failures = 0;     ///< Cache files which couldn't be read back or written.
+        double compileMilliseconds = 0;///< Time spent compiling the missed chunks.
+        double loadMilliseconds = 0;   ///< Time spent loading the cached chunks.
+        double savedMilliseconds = 0;  ///< Compile time recorded for the cached chunks minus the time to load them.
+
+        /** Gets the ratio of chunks loaded from the cache. */
+        float getHitRate() const { return hits + misses > 0 ? (float)hits / (hits + misses) : 0.0f; }
+    };
+
+    /**
+     * Enables the bytecode cache of luaLoadBuffer.
+     * Source chunks are compiled once then their bytecode is saved under FileUtils::getWritablePath,
+     * keyed by the hash of the chunk and of its name, and loaded instead of the source on the next launches.
+     * The cache is listed once when enabled, loading a chunk removes the bytecode cached for previous contents of the same name.
+     * The cache is dropped when the Lua VM changes version or architecture. Precompiled chunks aren't cached.
+     *
+     * @param enabled whether to use the cache, disabled by default.
+     */
+    void setBytecodeCacheEnabled(bool enabled);
+
+    /** Whether the bytecode cache is enabled. */
+    bool isBytecodeCacheEnabled() const { return _bytecodeCacheEnabled; }
+
+    /** Removes the files of the bytecode cache. */
+    void clearBytecodeCache();
+
+    /** Gets the counters of the bytecode cache since it was enabled. */
+    const BytecodeCacheStats& getBytecodeCacheStats() const { return _bytecodeCacheStats; }
     
     /**
      * Load the Lua chunks from the zip file
      * 
+     * In lazy mode only the central directory of the zip is read, the zip stays mapped and a
+     * chunk is decompressed and compiled by a loader of package.loaders the first time it is required.
+     * Otherwise every chunk is compiled into package.preload.
+     * Lazy mode is ignored if a file data decoder is set, see FileUtils::setFileDataDecoder.
+     * In both modes the chunks of a zip loaded later replace the ones with the same name.
+     *
      * @param zipFilePath file path to zip file.
+     * @param lazy whether to compile the chunks on demand.
      * @return 1 if load successfully otherwise 0.
      */
-    int loadChunksFromZIP(const char *zipFilePath);
+    int loadChunksFromZIP(const char *zipFilePath, bool lazy = true);
     
     /**
      * Load the Lua chunks from current lua_State.
      *
      * @param L the current lua_State.
+     * @param lazy whether to compile the chunks on demand, see loadChunksFromZIP.
      * @return 1 if load successfully otherwise 0.
      */
-    int luaLoadChunksFromZIP(lua_State *L);
+    int luaLoadChunksFromZIP(lua_State *L, bool lazy = true);
     
 protected:
     LuaStack()
@@ -316,9 +365,32 @@ protected:
     
     bool init();
     bool initWithLuaState(lua_State *L);
+
+    // loader of package.loaders for the chunks registered by luaLoadChunksFromZIP in lazy mode
+    static int lazyZipChunkLoader(lua_State *L);
+
+    int luaLoadCachedBuffer(lua_State *L, const char *chunk, int chunkSize, const char *chunkName);
+    // removes the cache files of the chunk name other than the current one
+    void pruneBytecodeCache(const std::string& namePrefix, const std::string& cacheFileName);
+
+    struct ZipChunkSource;
+    struct ZipChunk
+    {
+        std::shared_ptr<ZipChunkSource> source;
+        std::string entryName;
+    };
     
     lua_State *_state;
     int _callFromLua;
+    std::unordered_map<std::string, ZipChunk> _zipChunks;
+    bool _lazyZipLoaderAdded = false;
+    std::vector<char> _zipChunkBuffer;
+
+    bool _bytecodeCacheEnabled = false;
+    std::string _bytecodeCachePath;
+    BytecodeCacheStats _bytecodeCacheStats;
+    // cache file names by the hash of the chunk name, listed once by setBytecodeCacheEnabled
+    std::unordered_map<std::string, std::vector<std::string>> _bytecodeCacheFiles;
 };
 
 NS_CC_END
@@ -33,97 +33,250 @@ THE SOFTWARE.
 
 using namespace cocos2d;
 
-extern "C"
+namespace
 {
-    int cocos2dx_lua_loader(lua_State *L)
+    const std::string BYTECODE_FILE_EXT     = ".luac";
+    const std::string NOT_BYTECODE_FILE_EXT = ".lua";
+
+    bool endsWith(const std::string& str, size_t length, const std::string& suffix)
     {
-        static const std::string BYTECODE_FILE_EXT    = ".luac";
-        static const std::string NOT_BYTECODE_FILE_EXT = ".lua";
+        return length >= suffix.length() && str.compare(length - suffix.length(), suffix.length(), suffix) == 0;
+    }
 
-        std::string filename(luaL_checkstring(L, 1));
-        size_t pos = filename.rfind(BYTECODE_FILE_EXT);
-        if (pos != std::string::npos && pos == filename.length() - BYTECODE_FILE_EXT.length())
-            filename = filename.substr(0, pos);
-        else
+    // Length of str without the .luac or .lua extension, the rank tells which one was found.
+    size_t stripLuaExtension(const std::string& str, unsigned int* rank)
+    {
+        if (endsWith(str, str.length(), BYTECODE_FILE_EXT))
         {
-            pos = filename.rfind(NOT_BYTECODE_FILE_EXT);
-            if (pos != std::string::npos && pos == filename.length() - NOT_BYTECODE_FILE_EXT.length())
-                filename = filename.substr(0, pos);
+            *rank = 0;
+            return str.length() - BYTECODE_FILE_EXT.length();
         }
+        if (endsWith(str, str.length(), NOT_BYTECODE_FILE_EXT))
+        {
+            *rank = 1;
+            return str.length() - NOT_BYTECODE_FILE_EXT.length();
+        }
+        *rank = 2;
+        return str.length();
+    }
+
+    LuaModuleIndex* s_sharedLuaModuleIndex = nullptr;
+}
+
+NS_CC_BEGIN
 
-        pos = filename.find_first_of('.');
+LuaModuleIndex* LuaModuleIndex::getInstance()
+{
+    if (s_sharedLuaModuleIndex == nullptr)
+        s_sharedLuaModuleIndex = new (std::nothrow) LuaModuleIndex();
+    return s_sharedLuaModuleIndex;
+}
+
+void LuaModuleIndex::destroyInstance()
+{
+    CC_SAFE_DELETE(s_sharedLuaModuleIndex);
+}
+
+void LuaModuleIndex::addFiles(const std::vector<std::string>& files)
+{
+    _files.reserve(_files.size() + files.size());
+    for (const auto& file : files)
+    {
+        _files.push_back(file);
+        indexFile(file);
+    }
+}
+
+bool LuaModuleIndex::addFilesFromManifest(const std::string& filename)
+{
+    std::string contents;
+    if (FileUtils::getInstance()->getContents(filename, &contents) != FileUtils::Status::OK)
+    {
+        CCLOG("can not read Lua module manifest %s", filename.c_str());
+        return false;
+    }
+
+    std::vector<std::string> files;
+    size_t lineStart = 0;
+    while (lineStart < contents.size())
+    {
+        size_t lineEnd = contents.find('\n', lineStart);
+        if (lineEnd == std::string::npos)
+            lineEnd = contents.size();
+        size_t pathEnd = lineEnd;
+        if (pathEnd > lineStart && contents[pathEnd - 1] == '\r')
+            --pathEnd;
+        if (pathEnd > lineStart && contents[lineStart] != '#')
+            files.emplace_back(contents, lineStart, pathEnd - lineStart);
+        lineStart = lineEnd + 1;
+    }
+    addFiles(files);
+    return true;
+}
+
+void LuaModuleIndex::addFilesFromSearchArchives()
+{
+    addFiles(FileUtils::getInstance()->getSearchArchiveEntries());
+}
+
+void LuaModuleIndex::clear()
+{
+    _files.clear();
+    _modules.clear();
+}
+
+void LuaModuleIndex::setPackagePath(const char* packagePath)
+{
+    if (_packagePath == packagePath)
+        return;
+
+    _packagePath = packagePath;
+    _templates.clear();
+    _indexable = true;
+
+    size_t begin = 0;
+    while (begin < _packagePath.length())
+    {
+        size_t next = _packagePath.find(';', begin);
+        if (next == std::string::npos)
+            next = _packagePath.length();
+
+        Template entry;
+        entry.path = _packagePath.substr(begin, next - begin);
+        if (entry.path.compare(0, 2, "./") == 0)
+            entry.path.erase(0, 2);
+        unsigned int rank;
+        entry.path.resize(stripLuaExtension(entry.path, &rank));
+        entry.wildcard = entry.path.find('?');
+        entry.singleWildcard = entry.wildcard != std::string::npos && entry.path.find('?', entry.wildcard + 1) == std::string::npos;
+        // an entry with several '?' can't be matched against the files, an empty one never matches
+        if (!entry.singleWildcard && !entry.path.empty())
+            _indexable = false;
+        _templates.push_back(entry);
+
+        begin = next + 1;
+    }
+
+    _modules.clear();
+    for (const auto& file : _files)
+        indexFile(file);
+}
+
+void LuaModuleIndex::indexFile(const std::string& file)
+{
+    unsigned int rank;
+    const size_t length = stripLuaExtension(file, &rank);
+
+    for (size_t i = 0; i < _templates.size(); ++i)
+    {
+        const Template& entry = _templates[i];
+        if (!entry.singleWildcard)
+            continue;
+
+        const size_t suffixLength = entry.path.length() - entry.wildcard - 1;
+        if (length <= entry.wildcard + suffixLength
+            || file.compare(0, entry.wildcard, entry.path, 0, entry.wildcard) != 0
+            || file.compare(length - suffixLength, suffixLength, entry.path, entry.wildcard + 1, suffixLength) != 0)
+            continue;
+
+        std::string moduleFile = file.substr(entry.wildcard, length - entry.wildcard - suffixLength);
+        // module names have their '.' replaced by '/', such a file can't be required
+        if (moduleFile.find('.') != std::string::npos)
+            continue;
+
+        const unsigned int priority = static_cast<unsigned int>(i) * 3 + rank;
+        auto iter = _modules.find(moduleFile);
+        if (iter == _modules.end())
+        {
+            IndexedChunk chunk;
+            chunk.priority = priority;
+            chunk.chunkName = file;
+            _modules.emplace(std::move(moduleFile), std::move(chunk));
+        }
+        else if (priority < iter->second.priority)
+        {
+            iter->second.priority = priority;
+            iter->second.chunkName = file;
+        }
+    }
+}
+
+bool LuaModuleIndex::loadChunk(const char* packagePath, const std::string& moduleFile, std::string* chunkName, Data* chunk)
+{
+    setPackagePath(packagePath);
+
+    if (_indexable)
+    {
+        auto iter = _modules.find(moduleFile);
+        if (iter != _modules.end())
+        {
+            *chunk = FileUtils::getInstance()->getDataViewFromFile(iter->second.chunkName);
+            if (!chunk->isNull())
+            {
+                *chunkName = iter->second.chunkName;
+                return true;
+            }
+        }
+    }
+
+    // not shipped in the index, e.g. a file downloaded by a hot update
+    return probeChunk(moduleFile, chunkName, chunk);
+}
+
+bool LuaModuleIndex::probeChunk(const std::string& moduleFile, std::string* chunkName, Data* chunk)
+{
+    FileUtils* utils = FileUtils::getInstance();
+    const std::string* extensions[] = { &BYTECODE_FILE_EXT, &NOT_BYTECODE_FILE_EXT, nullptr };
+
+    for (const auto& entry : _templates)
+    {
+        _probePath.assign(entry.path);
+        size_t pos = entry.wildcard;
         while (pos != std::string::npos)
         {
-            filename.replace(pos, 1, "/");
-            pos = filename.find_first_of('.');
+            _probePath.replace(pos, 1, moduleFile);
+            pos = _probePath.find('?', pos + moduleFile.length());
+        }
+
+        const size_t length = _probePath.length();
+        for (const auto extension : extensions)
+        {
+            _probePath.resize(length);
+            if (extension)
+                _probePath.append(*extension);
+            if (utils->isFileExist(_probePath))
+            {
+                *chunk = utils->getDataViewFromFile(_probePath);
+                *chunkName = _probePath;
+                return true;
+            }
         }
+    }
+    return false;
+}
+
+NS_CC_END
+
+extern "C"
+{
+    int cocos2dx_lua_loader(lua_State *L)
+    {
+        std::string filename(luaL_checkstring(L, 1));
+        unsigned int rank;
+        filename.resize(stripLuaExtension(filename, &rank));
+        std::replace(filename.begin(), filename.end(), '.', '/');
 
         // search file in package.path
         Data chunk;
         std::string chunkName;
-        FileUtils* utils = FileUtils::getInstance();
 
         lua_getglobal(L, "package");
         lua_getfield(L, -1, "path");
-        std::string searchpath(lua_tostring(L, -1));
-        lua_pop(L, 1);
-        size_t begin = 0;
-        size_t next = searchpath.find_first_of(';', 0);
-
-        do
-        {
-            if (next == std::string::npos)
-                next = searchpath.length();
-            std::string prefix = searchpath.substr(begin, next-begin);
-            if (prefix[0] == '.' && prefix[1] == '/')
-                prefix = prefix.substr(2);
-
-            pos = prefix.rfind(BYTECODE_FILE_EXT);
-            if (pos != std::string::npos && pos == prefix.length() - BYTECODE_FILE_EXT.length())
-            {
-                prefix = prefix.substr(0, pos);
-            }
-            else
-            {
-                pos = prefix.rfind(NOT_BYTECODE_FILE_EXT);
-                if (pos != std::string::npos && pos == prefix.length() - NOT_BYTECODE_FILE_EXT.length())
-                    prefix = prefix.substr(0, pos);
-            }
-            pos = prefix.find_first_of('?', 0);
-            while (pos != std::string::npos)
-            {
-                prefix.replace(pos, 1, filename);
-                pos = prefix.find_first_of('?', pos + filename.length() + 1);
-            }
-            chunkName = prefix + BYTECODE_FILE_EXT;
-            if (utils->isFileExist(chunkName)) // && !utils->isDirectoryExist(chunkName))
-            {
-                chunk = utils->getDataFromFile(chunkName);
-                break;
-            }
-            else
-            {
-                chunkName = prefix + NOT_BYTECODE_FILE_EXT;
-                if (utils->isFileExist(chunkName) ) //&& !utils->isDirectoryExist(chunkName))
-                {
-                    chunk = utils->getDataFromFile(chunkName);
-                    break;
-                }
-                else
-                {
-                    chunkName = prefix;
-                    if (utils->isFileExist(chunkName)) // && !utils->isDirectoryExist(chunkName))
-                    {
-                        chunk = utils->getDataFromFile(chunkName);
-                        break;
-                    }
-                }
-            }
+        const char* searchpath = lua_tostring(L, -1);
+        bool found = LuaModuleIndex::getInstance()->loadChunk(searchpath ? searchpath : "", filename, &chunkName, &chunk);
+        lua_pop(L, 2);
 
-            begin = next + 1;
-            next = searchpath.find_first_of(';', begin);
-        } while (begin < searchpath.length());
-        if (chunk.getSize() > 0)
+        if (found && chunk.getSize() > 0)
         {
             LuaStack* stack = LuaEngine::getInstance()->getLuaStack();
             stack->luaLoadBuffer(L, reinterpret_cast<const char*>(chunk.getBytes()),
@@ -131,7 +284,7 @@ extern "C"
         }
         else
         {
-            CCLOG("can not get file data of %s", chunkName.c_str());
+            CCLOG("can not get file data of %s", found ? chunkName.c_str() : filename.c_str());
             return 0;
         }
 
@@ -26,7 +26,9 @@ THE SOFTWARE.
 #ifndef __COCOS2DX_LUA_LOADER_H__
 #define __COCOS2DX_LUA_LOADER_H__
 
-
+#include <string>
+#include <vector>
+#include <unordered_map>
 
 extern "C"
 {
@@ -37,4 +39,86 @@ extern "C"
 extern int cocos2dx_lua_loader(lua_State *L);
 }
 
+#include "platform/CCPlatformMacros.h"
+#include "base/CCData.h"
+
+NS_CC_BEGIN
+
+/**
+ * Maps module names to chunk files for cocos2dx_lua_loader, so requiring a module is a hash lookup
+ * instead of probing `.luac`, `.lua` and the bare name for every entry of package.path.
+ *
+ * The index is built from a list of files relative to the search paths, e.g. a manifest generated by
+ * `cmake/scripts/generate_path_manifest.py` or the entries of the archives added by `FileUtils::addSearchArchive`.
+ * Chunks are recorded by relative path, so they are still resolved through the search paths and a hot
+ * update placed in an earlier search path wins. Modules which aren't indexed are probed as before.
+ */
+class LuaModuleIndex
+{
+public:
+    /** Gets the instance used by cocos2dx_lua_loader. */
+    static LuaModuleIndex* getInstance();
+
+    /** Destroys the instance. */
+    static void destroyInstance();
+
+    /**
+     * Adds files to the index.
+     * @param files Paths relative to the search paths, using '/' as separator.
+     */
+    void addFiles(const std::vector<std::string>& files);
+
+    /**
+     * Adds the files listed by a manifest, one path relative to the search paths per line, '#' starts a comment line.
+     * @return Whether the manifest could be read.
+     */
+    bool addFilesFromManifest(const std::string& filename);
+
+    /** Adds the entries of the archives added by `FileUtils::addSearchArchive`. */
+    void addFilesFromSearchArchives();
+
+    /** Removes all the files from the index. */
+    void clear();
+
+    /** Gets the number of indexed modules for the current package.path. */
+    size_t getModuleCount() const { return _modules.size(); }
+
+    /**
+     * Finds and reads the chunk of a module.
+     * @param packagePath The value of package.path, the index is rebuilt when it changes.
+     * @param moduleFile The module name with '.' replaced by '/'.
+     * @param chunkName Receives the path of the chunk.
+     * @param chunk Receives the contents of the chunk.
+     * @return Whether a chunk was found.
+     */
+    bool loadChunk(const char* packagePath, const std::string& moduleFile, std::string* chunkName, Data* chunk);
+
+private:
+    struct Template
+    {
+        std::string path;      ///< Entry of package.path without "./" and the Lua file extension.
+        size_t wildcard;       ///< Position of the first '?'.
+        bool singleWildcard;   ///< Whether the entry can be matched against the files.
+    };
+
+    struct IndexedChunk
+    {
+        unsigned int priority; ///< Lower is tried first: template index * 3 + extension rank.
+        std::string chunkName;
+    };
+
+    void setPackagePath(const char* packagePath);
+    void indexFile(const std::string& file);
+    bool probeChunk(const std::string& moduleFile, std::string* chunkName, Data* chunk);
+
+    std::string _packagePath;
+    std::vector<Template> _templates;
+    bool _indexable = false;
+    std::vector<std::string> _files;
+    std::unordered_map<std::string, IndexedChunk> _modules;
+    std::string _probePath;
+};
+
+NS_CC_END
+
 #endif // __COCOS2DX_LUA_LOADER_H__
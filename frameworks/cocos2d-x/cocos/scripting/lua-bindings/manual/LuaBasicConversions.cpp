@@ -2026,11 +2026,92 @@ void vec2_array_to_luaval(lua_State* L,const cocos2d::Vec2* points, int count)
     }
 }
 
+// registry keys of the table to fill and of the C function whose return value fills it, see luaval_set_out_table
+static char s_outTableKey;
+static char s_outTableFunctionKey;
+// skips the registry lookup while no table is waiting
+static lua_State* s_outTableState = nullptr;
+// the stack top of the C function when it pushes its return value, i.e. its argument count
+static int s_outTableTop = 0;
+
+void luaval_set_out_table(lua_State* L, int lo, int func, int argc)
+{
+    if (nullptr == L)
+        return;
+
+    if (lo < 0 && lo > LUA_REGISTRYINDEX)
+        lo = lua_gettop(L) + lo + 1;
+    if (func < 0 && func > LUA_REGISTRYINDEX)
+        func = lua_gettop(L) + func + 1;
+
+    if (!lua_istable(L, lo) || !lua_iscfunction(L, func))
+    {
+        luaval_clear_out_table(L);
+        return;
+    }
+
+    lua_pushlightuserdata(L, &s_outTableKey);           /* L: key */
+    lua_pushvalue(L, lo);                               /* L: key table */
+    lua_rawset(L, LUA_REGISTRYINDEX);                   /* L: */
+    lua_pushlightuserdata(L, &s_outTableFunctionKey);   /* L: key */
+    lua_pushvalue(L, func);                             /* L: key func */
+    lua_rawset(L, LUA_REGISTRYINDEX);                   /* L: */
+    s_outTableState = L;
+    s_outTableTop = argc;
+}
+
+void luaval_clear_out_table(lua_State* L)
+{
+    if (nullptr == L || nullptr == s_outTableState)
+        return;
+
+    lua_pushlightuserdata(L, &s_outTableKey);           /* L: key */
+    lua_pushnil(L);                                     /* L: key nil */
+    lua_rawset(L, LUA_REGISTRYINDEX);                   /* L: */
+    lua_pushlightuserdata(L, &s_outTableFunctionKey);   /* L: key */
+    lua_pushnil(L);                                     /* L: key nil */
+    lua_rawset(L, LUA_REGISTRYINDEX);                   /* L: */
+    s_outTableState = nullptr;
+}
+
+// whether the value about to be pushed is the return value of the function armed by luaval_set_out_table:
+// it is pushed by that function itself right above its arguments, not by a nested call or a callback argument
+static bool is_out_table_return(lua_State* L)
+{
+    if (L != s_outTableState || lua_gettop(L) != s_outTableTop)
+        return false;
+
+    lua_Debug ar;
+    if (!lua_getstack(L, 0, &ar) || !lua_getinfo(L, "f", &ar))
+        return false;
+                                                        /* L: func */
+    lua_pushlightuserdata(L, &s_outTableFunctionKey);   /* L: func key */
+    lua_rawget(L, LUA_REGISTRYINDEX);                   /* L: func armed */
+    bool isReturn = lua_rawequal(L, -1, -2) != 0;
+    lua_pop(L, 2);                                      /* L: */
+    return isReturn;
+}
+
+// pushes the table waiting to be filled, or a new table sized for the value
+static void push_value_table(lua_State* L, int narr, int nrec)
+{
+    if (nullptr != s_outTableState && is_out_table_return(L))
+    {
+        lua_pushlightuserdata(L, &s_outTableKey);       /* L: key */
+        lua_rawget(L, LUA_REGISTRYINDEX);               /* L: table */
+        luaval_clear_out_table(L);
+        if (lua_istable(L, -1))
+            return;
+        lua_pop(L, 1);
+    }
+    lua_createtable(L, narr, nrec);
+}
+
 void vec2_to_luaval(lua_State* L,const cocos2d::Vec2& vec2)
 {
     if (NULL  == L)
         return;
-    lua_newtable(L);                                    /* L: table */
+    push_value_table(L, 0, 2);                          /* L: table */
     lua_pushstring(L, "x");                             /* L: table key */
     lua_pushnumber(L, (lua_Number) vec2.x);               /* L: table key value*/
     lua_rawset(L, -3);                                  /* table[key] = value, L: table */
@@ -2045,7 +2126,7 @@ void vec3_to_luaval(lua_State* L,const cocos2d::Vec3& vec3)
     if (NULL  == L)
         return;
 
-    lua_newtable(L);                                    /* L: table */
+    push_value_table(L, 0, 3);                          /* L: table */
     lua_pushstring(L, "x");                             /* L: table key */
     lua_pushnumber(L, (lua_Number) vec3.x);             /* L: table key value*/
     lua_rawset(L, -3);                                  /* table[key] = value, L: table */
@@ -2062,7 +2143,7 @@ void vec4_to_luaval(lua_State* L,const cocos2d::Vec4& vec4)
     if (NULL  == L)
         return;
 
-    lua_newtable(L);                                    /* L: table */
+    push_value_table(L, 0, 4);                          /* L: table */
     lua_pushstring(L, "x");                             /* L: table key */
     lua_pushnumber(L, (lua_Number) vec4.x);             /* L: table key value*/
     lua_rawset(L, -3);                                  /* table[key] = value, L: table */
@@ -2160,7 +2241,7 @@ void size_to_luaval(lua_State* L,const Size& sz)
 {
     if (NULL  == L)
         return;
-    lua_newtable(L);                                    /* L: table */
+    push_value_table(L, 0, 2);                          /* L: table */
     lua_pushstring(L, "width");                         /* L: table key */
     lua_pushnumber(L, (lua_Number) sz.width);           /* L: table key value*/
     lua_rawset(L, -3);                                  /* table[key] = value, L: table */
@@ -2173,7 +2254,7 @@ void rect_to_luaval(lua_State* L,const Rect& rt)
 {
     if (NULL  == L)
         return;
-    lua_newtable(L);                                    /* L: table */
+    push_value_table(L, 0, 4);                          /* L: table */
     lua_pushstring(L, "x");                             /* L: table key */
     lua_pushnumber(L, (lua_Number) rt.origin.x);               /* L: table key value*/
     lua_rawset(L, -3);                                  /* table[key] = value, L: table */
@@ -2192,7 +2273,7 @@ void color4b_to_luaval(lua_State* L,const Color4B& cc)
 {
     if (NULL  == L)
         return;
-    lua_newtable(L);                                    /* L: table */
+    push_value_table(L, 0, 4);                          /* L: table */
     lua_pushstring(L, "r");                             /* L: table key */
     lua_pushnumber(L, (lua_Number) cc.r);               /* L: table key value*/
     lua_rawset(L, -3);                                  /* table[key] = value, L: table */
@@ -2211,7 +2292,7 @@ void color4f_to_luaval(lua_State* L,const Color4F& cc)
 {
     if (NULL  == L)
         return;
-    lua_newtable(L);                                    /* L: table */
+    push_value_table(L, 0, 4);                          /* L: table */
     lua_pushstring(L, "r");                             /* L: table key */
     lua_pushnumber(L, (lua_Number) cc.r);               /* L: table key value*/
     lua_rawset(L, -3);                                  /* table[key] = value, L: table */
@@ -2230,7 +2311,7 @@ void color3b_to_luaval(lua_State* L,const Color3B& cc)
 {
     if (NULL  == L)
         return;
-    lua_newtable(L);                                    /* L: table */
+    push_value_table(L, 0, 3);                          /* L: table */
     lua_pushstring(L, "r");                             /* L: table key */
     lua_pushnumber(L, (lua_Number) cc.r);               /* L: table key value*/
     lua_rawset(L, -3);                                  /* table[key] = value, L: table */
@@ -2575,7 +2656,7 @@ void mat4_to_luaval(lua_State* L, const cocos2d::Mat4& mat)
     if (nullptr  == L)
         return;
 
-    lua_newtable(L);                                    /* L: table */
+    push_value_table(L, 16, 0);                         /* L: table */
     int indexTable = 1;
 
     for (int i = 0; i < 16; i++)
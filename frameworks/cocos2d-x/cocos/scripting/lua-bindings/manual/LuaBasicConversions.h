@@ -817,6 +817,26 @@ extern bool luaval_to_std_map_string_string(lua_State* L, int lo, std::map<std::
  * @{
  **/
 
+/**
+ * Make the cocos2d::Vec2, Vec3, Vec4, Size, Rect, Color3B, Color4B, Color4F or Mat4 returned by the C function
+ * at the index func fill the table at the index lo instead of a new table, so that returning the value doesn't allocate.
+ * Only the value the function pushes right above its argc arguments fills the table, the values pushed by nested calls
+ * or for callbacks are new tables. The table is only filled once.
+ *
+ * @param L the current lua_State.
+ * @param lo the index of the table in the Lua stack.
+ * @param func the index of the C function in the Lua stack, nothing is armed if it isn't a C function.
+ * @param argc the number of arguments the function is called with.
+ */
+extern void luaval_set_out_table(lua_State* L, int lo, int func, int argc);
+
+/**
+ * Cancel luaval_set_out_table if no value has filled the table yet.
+ *
+ * @param L the current lua_State.
+ */
+extern void luaval_clear_out_table(lua_State* L);
+
 /**
  * Push a table converted from a cocos2d::Vec2 object into the Lua stack.
  * The format of table as follows: {x=numberValue1, y=numberValue2}
@@ -19,12 +19,17 @@
 
 #define RD_AUDIO_BUFFER "Rapid2D_CAudioBuffer"
 #define RD_AUDIO_SOURCE "Rapid2D_CAudioPlayer"
+#define RD_AUDIO_STREAM "Rapid2D_CAudioStream"
 
 typedef struct _RDAudioItem {
     ALuint id;
     bool deleted;
 } RDAudioItem;
 
+typedef struct _RDAudioStreamItem {
+    RDAudioStream *stream;
+} RDAudioStreamItem;
+
 static void callback(int handler, ALuint bufferID)
 {
     lua_State * L = cocos2d::LuaEngine::getInstance()->getLuaStack()->getLuaState();
@@ -78,12 +83,47 @@ static int lnewSource(lua_State * L)
     return 1;// number of return values
 }
 
+static int lnewStream(lua_State * L)
+{
+    // FilePath
+    const char *path = luaL_checkstring(L, 1);
+    RDAudioStream *stream = RDAudio::getInstance()->newStream(path);
+    if (!stream) {
+        cocos2d::log("Rapid2D_CAudio.newStream() fail");
+        return 0;
+    }
+    
+    // create userdata
+    RDAudioStreamItem *streamItem = (RDAudioStreamItem *)lua_newuserdata(L, sizeof(RDAudioStreamItem));
+    streamItem->stream = stream;
+    // set metatable
+    luaL_getmetatable(L, RD_AUDIO_STREAM);
+    lua_setmetatable(L, -2);
+    return 1;// number of return values
+}
+
+static int lsetCacheSize(lua_State * L)
+{
+    lua_Number bytes = luaL_checknumber(L, 1);
+    RDAudio::getInstance()->setBufferCacheSize(bytes > 0 ? (size_t)bytes : 0);
+    return 0;
+}
+
+static int lgetCacheSize(lua_State * L)
+{
+    // cache size, bytes of all the buffers
+    lua_pushnumber(L, (lua_Number)RDAudio::getInstance()->getBufferCacheSize());
+    lua_pushnumber(L, (lua_Number)RDAudio::getInstance()->getCachedBufferBytes());
+    return 2;// number of return values
+}
+
 /******************** for buffer metatable ********************/
 static int lBufferGC(lua_State *L)
 {
     RDAudioItem *bufferItem = (RDAudioItem *)luaL_checkudata(L, 1, RD_AUDIO_BUFFER);
     if (!bufferItem->deleted) {
-        alDeleteBuffers(1, &bufferItem->id);
+        // kept in the buffer cache of RDAudio
+        RDAudio::getInstance()->releaseBuffer(bufferItem->id);
         bufferItem->deleted = true;
     }
     return 0;// number of return values
@@ -225,9 +265,107 @@ static const struct luaL_Reg meta_source [] = {
     {NULL, NULL}
 };
 
+/******************** for stream metatable ********************/
+static RDAudioStream *checkStream(lua_State *L, const char *funcName)
+{
+    RDAudioStreamItem *streamItem = (RDAudioStreamItem *)luaL_checkudata(L, 1, RD_AUDIO_STREAM);
+    if (!streamItem->stream) {
+        cocos2d::log("Rapid2D_CAudioStream.%s() fail for deleted!", funcName);
+    }
+    return streamItem->stream;
+}
+
+static int lStreamGC(lua_State *L)
+{
+    RDAudioStreamItem *streamItem = (RDAudioStreamItem *)luaL_checkudata(L, 1, RD_AUDIO_STREAM);
+    if (streamItem->stream) {
+        RDAudio::getInstance()->deleteStream(streamItem->stream);
+        streamItem->stream = NULL;
+    }
+    return 0;// number of return values
+}
+
+static int lStreamPlay(lua_State *L)
+{
+    RDAudioStream *stream = checkStream(L, "play");
+    if (stream) {
+        stream->play(lua_toboolean(L, 2) != 0);
+    }
+    return 0;
+}
+
+static int lStreamPause(lua_State *L)
+{
+    RDAudioStream *stream = checkStream(L, "pause");
+    if (stream) {
+        stream->pause();
+    }
+    return 0;
+}
+
+static int lStreamResume(lua_State *L)
+{
+    RDAudioStream *stream = checkStream(L, "resume");
+    if (stream) {
+        stream->resume();
+    }
+    return 0;
+}
+
+static int lStreamStop(lua_State *L)
+{
+    RDAudioStream *stream = checkStream(L, "stop");
+    if (stream) {
+        stream->stop();
+    }
+    return 0;
+}
+
+static int lStreamSetVolume(lua_State *L)
+{
+    RDAudioStream *stream = checkStream(L, "setVolume");
+    if (!stream) {
+        return 0;
+    }
+    
+    lua_Number volume = lua_tonumber(L, 2);
+    if (volume < 0.0f) {
+        volume = 0.0f;
+    }
+    if (volume > 1.0f) {
+        volume = 1.0f;
+    }
+    stream->setVolume((float)volume);
+    return 0;
+}
+
+static int lStreamGetStat(lua_State *L)
+{
+    RDAudioStream *stream = checkStream(L, "getStat");
+    if (!stream) {
+        return 0;
+    }
+    lua_pushinteger(L, stream->getState());
+    return 1;
+}
+
+static const struct luaL_Reg meta_stream [] = {
+    {"__gc", lStreamGC},
+    {"play", lStreamPlay},
+    {"pause", lStreamPause},
+    {"resume", lStreamResume},
+    {"stop", lStreamStop},
+    {"setVolume", lStreamSetVolume},
+    {"getStat", lStreamGetStat},
+    {NULL, NULL}
+};
+
 static const struct luaL_Reg audio_funcs [] = {
     {"newBuffer", lnewBuffer},
     {"newSource", lnewSource},
+    {"newStream", lnewStream},
+    {"setCacheSize", lsetCacheSize},
+    {"getCacheSize", lgetCacheSize},
     {NULL, NULL}
 };
 
@@ -255,6 +393,14 @@ TOLUA_API int register_audio_module(lua_State* L)
         luaL_setfuncs(L, meta_source, 0);
         lua_pop(L, 1);  /* pop new metatable */
         
+        luaL_newmetatable(L, RD_AUDIO_STREAM);
+        /* metatable.__index = metatable */
+        lua_pushvalue(L, -1);  /* duplicates the metatable */
+        lua_setfield(L, -2, "__index");
+        /* add method to metatable */
+        luaL_setfuncs(L, meta_stream, 0);
+        lua_pop(L, 1);  /* pop new metatable */
+        
         // binding userdata to new metatable
         luaL_register(L,"Rapid2D_CAudio", audio_funcs);
         lua_pop(L, 1);  /* pop Rapid2D_CAudio */
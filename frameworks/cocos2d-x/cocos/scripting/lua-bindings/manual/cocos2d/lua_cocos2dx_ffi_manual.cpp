@@ -0,0 +1,193 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+#include "scripting/lua-bindings/manual/cocos2d/lua_cocos2dx_ffi_manual.hpp"
+#include "2d/CCNode.h"
+#include "2d/CCSprite.h"
+#include "2d/CCLabel.h"
+#include "2d/CCAction.h"
+
+USING_NS_CC;
+
+/*
+ * The entries of the table, (return type, name, parameters) in C.
+ * They must not release objects or dispatch events: the Lua/C API can't be used while the FFI
+ * calls a C function, and releasing an object bound to Lua or running a Lua listener would use it.
+ */
+#define CC_FFI_API_ENTRIES(X) \
+    X(void, Node_setPosition, (void* node, float x, float y)) \
+    X(void, Node_setPositionX, (void* node, float x)) \
+    X(void, Node_setPositionY, (void* node, float y)) \
+    X(float, Node_getPositionX, (void* node)) \
+    X(float, Node_getPositionY, (void* node)) \
+    X(void, Node_setRotation, (void* node, float rotation)) \
+    X(float, Node_getRotation, (void* node)) \
+    X(void, Node_setRotationSkewX, (void* node, float rotationX)) \
+    X(float, Node_getRotationSkewX, (void* node)) \
+    X(void, Node_setRotationSkewY, (void* node, float rotationY)) \
+    X(float, Node_getRotationSkewY, (void* node)) \
+    X(void, Node_setScale, (void* node, float scale)) \
+    X(void, Node_setScaleXY, (void* node, float scaleX, float scaleY)) \
+    X(float, Node_getScale, (void* node)) \
+    X(void, Node_setScaleX, (void* node, float scaleX)) \
+    X(float, Node_getScaleX, (void* node)) \
+    X(void, Node_setScaleY, (void* node, float scaleY)) \
+    X(float, Node_getScaleY, (void* node)) \
+    X(void, Node_setSkewX, (void* node, float skewX)) \
+    X(float, Node_getSkewX, (void* node)) \
+    X(void, Node_setSkewY, (void* node, float skewY)) \
+    X(float, Node_getSkewY, (void* node)) \
+    X(void, Node_setAnchorPoint, (void* node, float x, float y)) \
+    X(void, Node_setContentSize, (void* node, float width, float height)) \
+    X(void, Node_setVisible, (void* node, bool visible)) \
+    X(bool, Node_isVisible, (void* node)) \
+    X(void, Node_setOpacity, (void* node, int opacity)) \
+    X(int, Node_getOpacity, (void* node)) \
+    X(int, Node_getDisplayedOpacity, (void* node)) \
+    X(void, Node_setColor, (void* node, int r, int g, int b)) \
+    X(void, Node_setCascadeOpacityEnabled, (void* node, bool enabled)) \
+    X(void, Node_setCascadeColorEnabled, (void* node, bool enabled)) \
+    X(void, Node_setLocalZOrder, (void* node, int localZOrder)) \
+    X(int, Node_getLocalZOrder, (void* node)) \
+    X(void, Node_setGlobalZOrder, (void* node, float globalZOrder)) \
+    X(float, Node_getGlobalZOrder, (void* node)) \
+    X(void, Node_setTag, (void* node, int tag)) \
+    X(int, Node_getTag, (void* node)) \
+    X(int, Node_getChildrenCount, (void* node)) \
+    X(int, Node_getNumberOfRunningActions, (void* node)) \
+    X(bool, Node_isRunning, (void* node)) \
+    X(void, Node_pause, (void* node)) \
+    X(void, Node_resume, (void* node)) \
+    X(void, Sprite_setFlippedX, (void* sprite, bool flippedX)) \
+    X(bool, Sprite_isFlippedX, (void* sprite)) \
+    X(void, Sprite_setFlippedY, (void* sprite, bool flippedY)) \
+    X(bool, Sprite_isFlippedY, (void* sprite)) \
+    X(void, Label_setTextColor, (void* label, int r, int g, int b, int a)) \
+    X(int, Label_getStringLength, (void* label)) \
+    X(void, Action_setTag, (void* action, int tag)) \
+    X(int, Action_getTag, (void* action)) \
+    X(bool, Action_isDone, (void* action))
+
+extern "C" {
+
+#define CC_FFI_API_FIELD(ret, name, params) ret (*name) params;
+struct cc_ffi_api
+{
+    CC_FFI_API_ENTRIES(CC_FFI_API_FIELD)
+};
+#undef CC_FFI_API_FIELD
+
+}
+
+namespace
+{
+    inline Node* node(void* p) { return static_cast<Node*>(p); }
+    inline Sprite* sprite(void* p) { return static_cast<Sprite*>(p); }
+    inline Label* label(void* p) { return static_cast<Label*>(p); }
+    inline Action* action(void* p) { return static_cast<Action*>(p); }
+
+    void Node_setPosition(void* p, float x, float y) { node(p)->setPosition(x, y); }
+    void Node_setPositionX(void* p, float x) { node(p)->setPositionX(x); }
+    void Node_setPositionY(void* p, float y) { node(p)->setPositionY(y); }
+    float Node_getPositionX(void* p) { return node(p)->getPositionX(); }
+    float Node_getPositionY(void* p) { return node(p)->getPositionY(); }
+    void Node_setRotation(void* p, float rotation) { node(p)->setRotation(rotation); }
+    float Node_getRotation(void* p) { return node(p)->getRotation(); }
+    void Node_setRotationSkewX(void* p, float rotationX) { node(p)->setRotationSkewX(rotationX); }
+    float Node_getRotationSkewX(void* p) { return node(p)->getRotationSkewX(); }
+    void Node_setRotationSkewY(void* p, float rotationY) { node(p)->setRotationSkewY(rotationY); }
+    float Node_getRotationSkewY(void* p) { return node(p)->getRotationSkewY(); }
+    void Node_setScale(void* p, float scale) { node(p)->setScale(scale); }
+    void Node_setScaleXY(void* p, float scaleX, float scaleY) { node(p)->setScale(scaleX, scaleY); }
+    float Node_getScale(void* p) { return node(p)->getScale(); }
+    void Node_setScaleX(void* p, float scaleX) { node(p)->setScaleX(scaleX); }
+    float Node_getScaleX(void* p) { return node(p)->getScaleX(); }
+    void Node_setScaleY(void* p, float scaleY) { node(p)->setScaleY(scaleY); }
+    float Node_getScaleY(void* p) { return node(p)->getScaleY(); }
+    void Node_setSkewX(void* p, float skewX) { node(p)->setSkewX(skewX); }
+    float Node_getSkewX(void* p) { return node(p)->getSkewX(); }
+    void Node_setSkewY(void* p, float skewY) { node(p)->setSkewY(skewY); }
+    float Node_getSkewY(void* p) { return node(p)->getSkewY(); }
+    void Node_setAnchorPoint(void* p, float x, float y) { node(p)->setAnchorPoint(Vec2(x, y)); }
+    void Node_setContentSize(void* p, float width, float height) { node(p)->setContentSize(Size(width, height)); }
+    void Node_setVisible(void* p, bool visible) { node(p)->setVisible(visible); }
+    bool Node_isVisible(void* p) { return node(p)->isVisible(); }
+    void Node_setOpacity(void* p, int opacity) { node(p)->setOpacity((uint8_t)opacity); }
+    int Node_getOpacity(void* p) { return node(p)->getOpacity(); }
+    int Node_getDisplayedOpacity(void* p) { return node(p)->getDisplayedOpacity(); }
+    void Node_setColor(void* p, int r, int g, int b) { node(p)->setColor(Color3B((uint8_t)r, (uint8_t)g, (uint8_t)b)); }
+    void Node_setCascadeOpacityEnabled(void* p, bool enabled) { node(p)->setCascadeOpacityEnabled(enabled); }
+    void Node_setCascadeColorEnabled(void* p, bool enabled) { node(p)->setCascadeColorEnabled(enabled); }
+    void Node_setLocalZOrder(void* p, int localZOrder) { node(p)->setLocalZOrder(localZOrder); }
+    int Node_getLocalZOrder(void* p) { return node(p)->getLocalZOrder(); }
+    void Node_setGlobalZOrder(void* p, float globalZOrder) { node(p)->setGlobalZOrder(globalZOrder); }
+    float Node_getGlobalZOrder(void* p) { return node(p)->getGlobalZOrder(); }
+    void Node_setTag(void* p, int tag) { node(p)->setTag(tag); }
+    int Node_getTag(void* p) { return node(p)->getTag(); }
+    int Node_getChildrenCount(void* p) { return (int)node(p)->getChildrenCount(); }
+    int Node_getNumberOfRunningActions(void* p) { return (int)node(p)->getNumberOfRunningActions(); }
+    bool Node_isRunning(void* p) { return node(p)->isRunning(); }
+    void Node_pause(void* p) { node(p)->pause(); }
+    void Node_resume(void* p) { node(p)->resume(); }
+    void Sprite_setFlippedX(void* p, bool flippedX) { sprite(p)->setFlippedX(flippedX); }
+    bool Sprite_isFlippedX(void* p) { return sprite(p)->isFlippedX(); }
+    void Sprite_setFlippedY(void* p, bool flippedY) { sprite(p)->setFlippedY(flippedY); }
+    bool Sprite_isFlippedY(void* p) { return sprite(p)->isFlippedY(); }
+    void Label_setTextColor(void* p, int r, int g, int b, int a) { label(p)->setTextColor(Color4B((uint8_t)r, (uint8_t)g, (uint8_t)b, (uint8_t)a)); }
+    int Label_getStringLength(void* p) { return label(p)->getStringLength(); }
+    void Action_setTag(void* p, int tag) { action(p)->setTag(tag); }
+    int Action_getTag(void* p) { return action(p)->getTag(); }
+    bool Action_isDone(void* p) { return action(p)->isDone(); }
+
+#define CC_FFI_API_FUNCTION(ret, name, params) name,
+    const cc_ffi_api s_api = {
+        CC_FFI_API_ENTRIES(CC_FFI_API_FUNCTION)
+    };
+#undef CC_FFI_API_FUNCTION
+
+    // the declaration of the fields of cc_ffi_api for ffi.cdef
+#define CC_FFI_API_DECLARATION(ret, name, params) #ret " (*" #name ")" #params ";\n"
+    const char* s_apiDeclaration = CC_FFI_API_ENTRIES(CC_FFI_API_DECLARATION);
+#undef CC_FFI_API_DECLARATION
+}
+
+static int tolua_cocos2d_getFFIApi(lua_State* tolua_S)
+{
+    lua_pushlightuserdata(tolua_S, (void*)&s_api);
+    lua_pushstring(tolua_S, s_apiDeclaration);
+    return 2;
+}
+
+int register_all_cocos2dx_ffi_manual(lua_State* tolua_S)
+{
+    if (nullptr == tolua_S)
+        return 0;
+
+    tolua_open(tolua_S);
+    tolua_module(tolua_S, "cc", 0);
+    tolua_beginmodule(tolua_S, "cc");
+        tolua_function(tolua_S, "getFFIApi", tolua_cocos2d_getFFIApi);
+    tolua_endmodule(tolua_S);
+
+    return 0;
+}
@@ -4790,15 +4790,22 @@ static int lua_cocos2dx_TextureCache_addImageAsync(lua_State* tolua_S)
 #endif
     argc = lua_gettop(tolua_S) - 1;
 
-    if (2 == argc)
+    if (2 == argc || 3 == argc)
     {
 #if COCOS2D_DEBUG >= 1
         if (!tolua_isstring(tolua_S, 2, 0, &tolua_err)  ||
-            !toluafix_isfunction(tolua_S,3,"LUA_FUNCTION",0,&tolua_err))
+            !toluafix_isfunction(tolua_S,3,"LUA_FUNCTION",0,&tolua_err) ||
+            !tolua_isnumber(tolua_S, 4, 1, &tolua_err))
         {
             goto tolua_lerror;
         }
 #endif
+        const int priorityValue = (int)tolua_tonumber(tolua_S, 4, 0);
+        if (priorityValue != (int)TextureCache::AsyncPriority::HIGH && priorityValue != (int)TextureCache::AsyncPriority::LOW)
+        {
+            return luaL_error(tolua_S, "%s invalid priority: %d, was expecting cc.TEXTURE_ASYNC_PRIORITY.HIGH or LOW\n", "cc.TextureCache:addImageAsync", priorityValue);
+        }
+        auto priority = static_cast<TextureCache::AsyncPriority>(priorityValue);
         const char* configFilePath = tolua_tostring(tolua_S, 2, "");
         LUA_FUNCTION handler = (  toluafix_ref_function(tolua_S, 3, 0));
 
@@ -4809,7 +4816,7 @@ static int lua_cocos2dx_TextureCache_addImageAsync(lua_State* tolua_S)
             toluafix_pushusertype_ccobject(tolua_S, ID, luaID, (void*)tex, "cc.Texture2D");
             LuaEngine::getInstance()->getLuaStack()->executeFunctionByHandler(handler,1);
             LuaEngine::getInstance()->removeScriptHandler(handler);
-        });
+        }, configFilePath, priority);
 
         return 0;
     }
@@ -4823,6 +4830,275 @@ tolua_lerror:
     return 0;
 }
 
+static int lua_cocos2dx_TextureCache_setAsyncLoadingThreadCount(lua_State* tolua_S)
+{
+    if (nullptr == tolua_S)
+        return 0 ;
+
+    int argc = 0;
+    TextureCache* self = nullptr;
+
+#if COCOS2D_DEBUG >= 1
+    tolua_Error tolua_err;
+    if (!tolua_isusertype(tolua_S,1,"cc.TextureCache",0,&tolua_err)) goto tolua_lerror;
+#endif
+
+    self = static_cast<TextureCache*>(tolua_tousertype(tolua_S,1,0));
+
+#if COCOS2D_DEBUG >= 1
+    if (nullptr == self) {
+        tolua_error(tolua_S,"invalid 'self' in function 'lua_cocos2dx_TextureCache_setAsyncLoadingThreadCount'\n", NULL);
+        return 0;
+    }
+#endif
+    argc = lua_gettop(tolua_S) - 1;
+
+    if (1 == argc)
+    {
+#if COCOS2D_DEBUG >= 1
+        if (!tolua_isnumber(tolua_S, 2, 0, &tolua_err))
+        {
+            goto tolua_lerror;
+        }
+#endif
+        self->setAsyncLoadingThreadCount((unsigned int)tolua_tonumber(tolua_S, 2, 0));
+        return 0;
+    }
+
+    luaL_error(tolua_S, "%s function of TextureCache has wrong number of arguments: %d, was expecting %d\n", "cc.TextureCache:setAsyncLoadingThreadCount", argc, 1);
+
+#if COCOS2D_DEBUG >= 1
+tolua_lerror:
+    tolua_error(tolua_S,"#ferror in function 'lua_cocos2dx_TextureCache_setAsyncLoadingThreadCount'.",&tolua_err);
+#endif
+    return 0;
+}
+
+static int lua_cocos2dx_TextureCache_getAsyncLoadingThreadCount(lua_State* tolua_S)
+{
+    if (nullptr == tolua_S)
+        return 0 ;
+
+    TextureCache* self = nullptr;
+
+#if COCOS2D_DEBUG >= 1
+    tolua_Error tolua_err;
+    if (!tolua_isusertype(tolua_S,1,"cc.TextureCache",0,&tolua_err)) goto tolua_lerror;
+#endif
+
+    self = static_cast<TextureCache*>(tolua_tousertype(tolua_S,1,0));
+
+#if COCOS2D_DEBUG >= 1
+    if (nullptr == self) {
+        tolua_error(tolua_S,"invalid 'self' in function 'lua_cocos2dx_TextureCache_getAsyncLoadingThreadCount'\n", NULL);
+        return 0;
+    }
+#endif
+    tolua_pushnumber(tolua_S, (lua_Number)self->getAsyncLoadingThreadCount());
+    return 1;
+
+#if COCOS2D_DEBUG >= 1
+tolua_lerror:
+    tolua_error(tolua_S,"#ferror in function 'lua_cocos2dx_TextureCache_getAsyncLoadingThreadCount'.",&tolua_err);
+    return 0;
+#endif
+}
+
+static int lua_cocos2dx_TextureCache_setAsyncUploadBudget(lua_State* tolua_S)
+{
+    if (nullptr == tolua_S)
+        return 0 ;
+
+    int argc = 0;
+    TextureCache* self = nullptr;
+
+#if COCOS2D_DEBUG >= 1
+    tolua_Error tolua_err;
+    if (!tolua_isusertype(tolua_S,1,"cc.TextureCache",0,&tolua_err)) goto tolua_lerror;
+#endif
+
+    self = static_cast<TextureCache*>(tolua_tousertype(tolua_S,1,0));
+
+#if COCOS2D_DEBUG >= 1
+    if (nullptr == self) {
+        tolua_error(tolua_S,"invalid 'self' in function 'lua_cocos2dx_TextureCache_setAsyncUploadBudget'\n", NULL);
+        return 0;
+    }
+#endif
+    argc = lua_gettop(tolua_S) - 1;
+
+    if (1 == argc || 2 == argc)
+    {
+#if COCOS2D_DEBUG >= 1
+        if (!tolua_isnumber(tolua_S, 2, 0, &tolua_err) ||
+            !tolua_isnumber(tolua_S, 3, 1, &tolua_err))
+        {
+            goto tolua_lerror;
+        }
+#endif
+        self->setAsyncUploadBudget((unsigned int)tolua_tonumber(tolua_S, 2, 0), (float)tolua_tonumber(tolua_S, 3, 0));
+        return 0;
+    }
+
+    luaL_error(tolua_S, "%s function of TextureCache has wrong number of arguments: %d, was expecting %d\n", "cc.TextureCache:setAsyncUploadBudget", argc, 1);
+
+#if COCOS2D_DEBUG >= 1
+tolua_lerror:
+    tolua_error(tolua_S,"#ferror in function 'lua_cocos2dx_TextureCache_setAsyncUploadBudget'.",&tolua_err);
+#endif
+    return 0;
+}
+
+static int lua_cocos2dx_TextureCache_getAsyncUploadBudget(lua_State* tolua_S)
+{
+    if (nullptr == tolua_S)
+        return 0 ;
+
+    TextureCache* self = nullptr;
+
+#if COCOS2D_DEBUG >= 1
+    tolua_Error tolua_err;
+    if (!tolua_isusertype(tolua_S,1,"cc.TextureCache",0,&tolua_err)) goto tolua_lerror;
+#endif
+
+    self = static_cast<TextureCache*>(tolua_tousertype(tolua_S,1,0));
+
+#if COCOS2D_DEBUG >= 1
+    if (nullptr == self) {
+        tolua_error(tolua_S,"invalid 'self' in function 'lua_cocos2dx_TextureCache_getAsyncUploadBudget'\n", NULL);
+        return 0;
+    }
+#endif
+    // bytes, milliseconds
+    tolua_pushnumber(tolua_S, (lua_Number)self->getAsyncUploadBytesPerFrame());
+    tolua_pushnumber(tolua_S, (lua_Number)self->getAsyncUploadMillisecondsPerFrame());
+    return 2;
+
+#if COCOS2D_DEBUG >= 1
+tolua_lerror:
+    tolua_error(tolua_S,"#ferror in function 'lua_cocos2dx_TextureCache_getAsyncUploadBudget'.",&tolua_err);
+    return 0;
+#endif
+}
+
+static int lua_cocos2dx_TextureCache_setTextureMemoryBudget(lua_State* tolua_S)
+{
+    if (nullptr == tolua_S)
+        return 0 ;
+
+    int argc = 0;
+    TextureCache* self = nullptr;
+
+#if COCOS2D_DEBUG >= 1
+    tolua_Error tolua_err;
+    if (!tolua_isusertype(tolua_S,1,"cc.TextureCache",0,&tolua_err)) goto tolua_lerror;
+#endif
+
+    self = static_cast<TextureCache*>(tolua_tousertype(tolua_S,1,0));
+
+#if COCOS2D_DEBUG >= 1
+    if (nullptr == self) {
+        tolua_error(tolua_S,"invalid 'self' in function 'lua_cocos2dx_TextureCache_setTextureMemoryBudget'\n", NULL);
+        return 0;
+    }
+#endif
+    argc = lua_gettop(tolua_S) - 1;
+
+    if (1 == argc)
+    {
+#if COCOS2D_DEBUG >= 1
+        if (!tolua_isnumber(tolua_S, 2, 0, &tolua_err))
+        {
+            goto tolua_lerror;
+        }
+#endif
+        self->setTextureMemoryBudget((size_t)tolua_tonumber(tolua_S, 2, 0));
+        return 0;
+    }
+
+    luaL_error(tolua_S, "%s function of TextureCache has wrong number of arguments: %d, was expecting %d\n", "cc.TextureCache:setTextureMemoryBudget", argc, 1);
+
+#if COCOS2D_DEBUG >= 1
+tolua_lerror:
+    tolua_error(tolua_S,"#ferror in function 'lua_cocos2dx_TextureCache_setTextureMemoryBudget'.",&tolua_err);
+#endif
+    return 0;
+}
+
+static int lua_cocos2dx_TextureCache_getTextureMemoryBudget(lua_State* tolua_S)
+{
+    if (nullptr == tolua_S)
+        return 0 ;
+
+    TextureCache* self = nullptr;
+
+#if COCOS2D_DEBUG >= 1
+    tolua_Error tolua_err;
+    if (!tolua_isusertype(tolua_S,1,"cc.TextureCache",0,&tolua_err)) goto tolua_lerror;
+#endif
+
+    self = static_cast<TextureCache*>(tolua_tousertype(tolua_S,1,0));
+
+#if COCOS2D_DEBUG >= 1
+    if (nullptr == self) {
+        tolua_error(tolua_S,"invalid 'self' in function 'lua_cocos2dx_TextureCache_getTextureMemoryBudget'\n", NULL);
+        return 0;
+    }
+#endif
+    tolua_pushnumber(tolua_S, (lua_Number)self->getTextureMemoryBudget());
+    return 1;
+
+#if COCOS2D_DEBUG >= 1
+tolua_lerror:
+    tolua_error(tolua_S,"#ferror in function 'lua_cocos2dx_TextureCache_getTextureMemoryBudget'.",&tolua_err);
+    return 0;
+#endif
+}
+
+static int lua_cocos2dx_TextureCache_getResidentTextureBytes(lua_State* tolua_S)
+{
+    if (nullptr == tolua_S)
+        return 0 ;
+
+    TextureCache* self = nullptr;
+
+#if COCOS2D_DEBUG >= 1
+    tolua_Error tolua_err;
+    if (!tolua_isusertype(tolua_S,1,"cc.TextureCache",0,&tolua_err)) goto tolua_lerror;
+#endif
+
+    self = static_cast<TextureCache*>(tolua_tousertype(tolua_S,1,0));
+
+#if COCOS2D_DEBUG >= 1
+    if (nullptr == self) {
+        tolua_error(tolua_S,"invalid 'self' in function 'lua_cocos2dx_TextureCache_getResidentTextureBytes'\n", NULL);
+        return 0;
+    }
+#endif
+    {
+        // total bytes, bytes by pixel format keyed by the values of cc.backendPixelFormat
+        auto bytesByFormat = self->getResidentTextureBytesByPixelFormat();
+        size_t totalBytes = 0;
+        lua_newtable(tolua_S);
+        for (auto& format : bytesByFormat)
+        {
+            lua_pushnumber(tolua_S, (lua_Number)static_cast<int>(format.first));
+            lua_pushnumber(tolua_S, (lua_Number)format.second);
+            lua_rawset(tolua_S, -3);
+            totalBytes += format.second;
+        }
+        tolua_pushnumber(tolua_S, (lua_Number)totalBytes);
+        lua_insert(tolua_S, -2);
+    }
+    return 2;
+
+#if COCOS2D_DEBUG >= 1
+tolua_lerror:
+    tolua_error(tolua_S,"#ferror in function 'lua_cocos2dx_TextureCache_getResidentTextureBytes'.",&tolua_err);
+    return 0;
+#endif
+}
+
 static void extendTextureCache(lua_State* tolua_S)
 {
     lua_pushstring(tolua_S, "cc.TextureCache");
@@ -4830,6 +5106,13 @@ static void extendTextureCache(lua_State* tolua_S)
     if (lua_istable(tolua_S,-1))
     {
         tolua_function(tolua_S, "addImageAsync", lua_cocos2dx_TextureCache_addImageAsync);
+        tolua_function(tolua_S, "setAsyncLoadingThreadCount", lua_cocos2dx_TextureCache_setAsyncLoadingThreadCount);
+        tolua_function(tolua_S, "getAsyncLoadingThreadCount", lua_cocos2dx_TextureCache_getAsyncLoadingThreadCount);
+        tolua_function(tolua_S, "setAsyncUploadBudget", lua_cocos2dx_TextureCache_setAsyncUploadBudget);
+        tolua_function(tolua_S, "getAsyncUploadBudget", lua_cocos2dx_TextureCache_getAsyncUploadBudget);
+        tolua_function(tolua_S, "setTextureMemoryBudget", lua_cocos2dx_TextureCache_setTextureMemoryBudget);
+        tolua_function(tolua_S, "getTextureMemoryBudget", lua_cocos2dx_TextureCache_getTextureMemoryBudget);
+        tolua_function(tolua_S, "getResidentTextureBytes", lua_cocos2dx_TextureCache_getResidentTextureBytes);
     }
     lua_pop(tolua_S, 1);
 }
@@ -5694,6 +5977,93 @@ static int tolua_cocos2d_utils_findChild(lua_State* tolua_S)
 #endif
 }
 
+// cc.fillValue(out, func, ...) calls func(...) and fills the table out with the value it returns,
+// e.g. cc.fillValue(size, node.getContentSize, node) doesn't allocate a table.
+// func must be a C function of the bindings, a Lua function returns a new table as usual.
+static int tolua_cocos2d_fillValue(lua_State* tolua_S)
+{
+#if COCOS2D_DEBUG >= 1
+    tolua_Error tolua_err;
+    if (!tolua_istable(tolua_S, 1, 0, &tolua_err) ||
+        !toluafix_isfunction(tolua_S, 2, "LUA_FUNCTION", 0, &tolua_err)
+        )
+        goto tolua_lerror;
+    else
+#endif
+    {
+        int argc = lua_gettop(tolua_S) - 2;
+        lua_pushvalue(tolua_S, 2);                      /* L: out func ... func */
+        for (int i = 3; i <= argc + 2; ++i)
+            lua_pushvalue(tolua_S, i);                  /* L: out func ... func ... */
+
+        // only the value returned by a binding fills out
+        luaval_set_out_table(tolua_S, 1, -(argc + 1), argc);
+        int error = lua_pcall(tolua_S, argc, 1, 0);
+        // func may not have returned a value type
+        luaval_clear_out_table(tolua_S);
+        if (error)
+            return lua_error(tolua_S);
+        return 1;
+    }
+#if COCOS2D_DEBUG >= 1
+tolua_lerror:
+    tolua_error(tolua_S, "#ferror in function 'tolua_cocos2d_fillValue'.", &tolua_err);
+    return 0;
+#endif
+}
+
+// cc.setLuaGCParams(budget, pause, stepmul) sets the microseconds the collector may run in the idle time of
+// each frame, and optionally the pause and step multiplier of the collector, see LuaEngine::setGCBudget.
+static int tolua_cocos2d_setLuaGCParams(lua_State* tolua_S)
+{
+#if COCOS2D_DEBUG >= 1
+    tolua_Error tolua_err;
+    if (!tolua_isnumber(tolua_S, 1, 0, &tolua_err) ||
+        !tolua_isnumber(tolua_S, 2, 1, &tolua_err) ||
+        !tolua_isnumber(tolua_S, 3, 1, &tolua_err)
+        )
+        goto tolua_lerror;
+    else
+#endif
+    {
+        auto engine = LuaEngine::getInstance();
+        engine->setGCBudget((int)tolua_tonumber(tolua_S, 1, 0));
+        if (!lua_isnoneornil(tolua_S, 2))
+            engine->setGCPause((int)tolua_tonumber(tolua_S, 2, 0));
+        if (!lua_isnoneornil(tolua_S, 3))
+            engine->setGCStepMul((int)tolua_tonumber(tolua_S, 3, 0));
+        return 0;
+    }
+#if COCOS2D_DEBUG >= 1
+tolua_lerror:
+    tolua_error(tolua_S, "#ferror in function 'tolua_cocos2d_setLuaGCParams'.", &tolua_err);
+    return 0;
+#endif
+}
+
+// cc.getLuaGCStats() returns {time, maxTime, steps, cycles, count} of the collection in the idle time of the frames.
+static int tolua_cocos2d_getLuaGCStats(lua_State* tolua_S)
+{
+    const auto& stats = LuaEngine::getInstance()->getGCStats();
+    lua_createtable(tolua_S, 0, 5);
+    lua_pushstring(tolua_S, "time");
+    lua_pushinteger(tolua_S, stats.frameTime);
+    lua_rawset(tolua_S, -3);
+    lua_pushstring(tolua_S, "maxTime");
+    lua_pushinteger(tolua_S, stats.maxFrameTime);
+    lua_rawset(tolua_S, -3);
+    lua_pushstring(tolua_S, "steps");
+    lua_pushinteger(tolua_S, stats.frameSteps);
+    lua_rawset(tolua_S, -3);
+    lua_pushstring(tolua_S, "cycles");
+    lua_pushinteger(tolua_S, stats.cycles);
+    lua_rawset(tolua_S, -3);
+    lua_pushstring(tolua_S, "count");
+    lua_pushinteger(tolua_S, stats.count);
+    lua_rawset(tolua_S, -3);
+    return 1;
+}
+
 int register_all_cocos2dx_module_manual(lua_State* tolua_S)
 {
     if (nullptr == tolua_S)
@@ -5702,6 +6072,9 @@ int register_all_cocos2dx_module_manual(lua_State* tolua_S)
     tolua_open(tolua_S);
     tolua_module(tolua_S, "cc", 0);
     tolua_beginmodule(tolua_S, "cc");
+        tolua_function(tolua_S, "fillValue", tolua_cocos2d_fillValue);
+        tolua_function(tolua_S, "setLuaGCParams", tolua_cocos2d_setLuaGCParams);
+        tolua_function(tolua_S, "getLuaGCStats", tolua_cocos2d_getLuaGCStats);
         tolua_module(tolua_S, "utils", 0);
         tolua_beginmodule(tolua_S,"utils");
             tolua_function(tolua_S, "captureScreen", tolua_cocos2d_utils_captureScreen);
@@ -32,19 +32,36 @@ using namespace cocos2d;
 
 static int s_function_ref_id = 0;
 
-TOLUA_API void toluafix_open(lua_State* L)
+// The mapping tables are also kept in the registry by integer reference: lua_rawgeti doesn't hash
+// and intern the name of the table as the lookup by string does.
+static int s_refid_ptr_mapping = LUA_NOREF;
+static int s_refid_type_mapping = LUA_NOREF;
+static int s_refid_userdata_mapping = LUA_NOREF;
+static int s_refid_function_mapping = LUA_NOREF;
+static int s_value_root = LUA_NOREF;
+
+static int toluafix_new_mapping(lua_State* L, const char* name)
 {
-    lua_pushstring(L, TOLUA_REFID_PTR_MAPPING);
-    lua_newtable(L);
-    lua_rawset(L, LUA_REGISTRYINDEX);
-
-    lua_pushstring(L, TOLUA_REFID_TYPE_MAPPING);
-    lua_newtable(L);
-    lua_rawset(L, LUA_REGISTRYINDEX);
+    lua_pushstring(L, name);                                    /* stack: name */
+    lua_newtable(L);                                            /* stack: name mapping */
+    lua_pushvalue(L, -1);                                       /* stack: name mapping mapping */
+    int ref = luaL_ref(L, LUA_REGISTRYINDEX);                   /* stack: name mapping */
+    lua_rawset(L, LUA_REGISTRYINDEX);                           /* stack: - */
+    return ref;
+}
 
-    lua_pushstring(L, TOLUA_REFID_FUNCTION_MAPPING);
-    lua_newtable(L);
-    lua_rawset(L, LUA_REGISTRYINDEX);
+TOLUA_API void toluafix_open(lua_State* L)
+{
+    s_refid_ptr_mapping = toluafix_new_mapping(L, TOLUA_REFID_PTR_MAPPING);
+    s_refid_type_mapping = toluafix_new_mapping(L, TOLUA_REFID_TYPE_MAPPING);
+    s_refid_userdata_mapping = toluafix_new_mapping(L, TOLUA_REFID_USERDATA_MAPPING);
+    s_refid_function_mapping = toluafix_new_mapping(L, TOLUA_REFID_FUNCTION_MAPPING);
+
+    // tolua_open creates tolua_value_root, it does nothing when called again by the bindings
+    tolua_open(L);
+    lua_pushstring(L, TOLUA_VALUE_ROOT);
+    lua_rawget(L, LUA_REGISTRYINDEX);                           /* stack: root */
+    s_value_root = luaL_ref(L, LUA_REGISTRYINDEX);              /* stack: - */
 }
 
 TOLUA_API int toluafix_pushusertype_ccobject(lua_State* L,
@@ -60,31 +77,62 @@ TOLUA_API int toluafix_pushusertype_ccobject(lua_State* L,
     }
     
     Ref* vPtr = static_cast<Ref*>(ptr);
+
+    if (*p_refid != 0)
+    {
+        // pushed before with its dynamic type, the userdata is in the root until the object is removed
+        lua_rawgeti(L, LUA_REGISTRYINDEX, s_refid_userdata_mapping); /* stack: refid_ud */
+        lua_rawgeti(L, -1, *p_refid);                               /* stack: refid_ud ud */
+        lua_remove(L, -2);                                          /* stack: ud */
+        if (!lua_isnil(L, -1))
+        {
+            return 0;
+        }
+        lua_pop(L, 1);                                              /* stack: - */
+    }
+
     const char* vType = getLuaTypeName(vPtr, type);
 
     if (*p_refid == 0)
     {
         *p_refid = refid;
 
-        lua_pushstring(L, TOLUA_REFID_PTR_MAPPING);
-        lua_rawget(L, LUA_REGISTRYINDEX);                           /* stack: refid_ptr */
-        lua_pushinteger(L, refid);                                  /* stack: refid_ptr refid */
-        lua_pushlightuserdata(L, vPtr);                              /* stack: refid_ptr refid ptr */
-
-        lua_rawset(L, -3);                  /* refid_ptr[refid] = ptr, stack: refid_ptr */
+        lua_rawgeti(L, LUA_REGISTRYINDEX, s_refid_ptr_mapping);     /* stack: refid_ptr */
+        lua_pushlightuserdata(L, vPtr);                              /* stack: refid_ptr ptr */
+        lua_rawseti(L, -2, refid);          /* refid_ptr[refid] = ptr, stack: refid_ptr */
         lua_pop(L, 1);                                              /* stack: - */
 
-        lua_pushstring(L, TOLUA_REFID_TYPE_MAPPING);
-        lua_rawget(L, LUA_REGISTRYINDEX);                           /* stack: refid_type */
-        lua_pushinteger(L, refid);                                  /* stack: refid_type refid */
-        lua_pushstring(L, vType);                                    /* stack: refid_type refid type */
-        lua_rawset(L, -3);                /* refid_type[refid] = type, stack: refid_type */
+        lua_rawgeti(L, LUA_REGISTRYINDEX, s_refid_type_mapping);    /* stack: refid_type */
+        lua_pushstring(L, vType);                                    /* stack: refid_type type */
+        lua_rawseti(L, -2, refid);        /* refid_type[refid] = type, stack: refid_type */
         lua_pop(L, 1);                                              /* stack: - */
 
         //printf("[LUA] push CCObject OK - refid: %d, ptr: %x, type: %s\n", *p_refid, (int)ptr, type);
     }
 
-    tolua_pushusertype_and_addtoroot(L, vPtr, vType);
+    int top = lua_gettop(L);
+    tolua_pushusertype(L, vPtr, vType);                             /* stack: ud */
+    // nothing is pushed if the type has no metatable
+    if (lua_gettop(L) == top)
+    {
+        return 0;
+    }
+
+    lua_rawgeti(L, LUA_REGISTRYINDEX, s_value_root);                /* stack: ud root */
+    lua_pushlightuserdata(L, vPtr);                                  /* stack: ud root ptr */
+    lua_pushvalue(L, -3);                                           /* stack: ud root ptr ud */
+    lua_rawset(L, -3);                           /* root[ptr] = ud, stack: ud root */
+    lua_pop(L, 1);                                                  /* stack: ud */
+
+    // getLuaTypeName returns the type given when the dynamic type isn't bound, a later push
+    // may give a more specialized type, so only the userdata of a dynamic type is reused
+    if (vType != type)
+    {
+        lua_rawgeti(L, LUA_REGISTRYINDEX, s_refid_userdata_mapping); /* stack: ud refid_ud */
+        lua_pushvalue(L, -2);                                       /* stack: ud refid_ud ud */
+        lua_rawseti(L, -2, *p_refid);       /* refid_ud[refid] = ud, stack: ud refid_ud */
+        lua_pop(L, 1);                                              /* stack: ud */
+    }
     
     return 0;
 }
@@ -97,10 +145,8 @@ TOLUA_API int toluafix_remove_ccobject_by_refid(lua_State* L, int refid)
     if (refid == 0) return -1;
 
     // get ptr from tolua_refid_ptr_mapping
-    lua_pushstring(L, TOLUA_REFID_PTR_MAPPING);
-    lua_rawget(L, LUA_REGISTRYINDEX);                               /* stack: refid_ptr */
-    lua_pushinteger(L, refid);                                      /* stack: refid_ptr refid */
-    lua_rawget(L, -2);                                              /* stack: refid_ptr ptr */
+    lua_rawgeti(L, LUA_REGISTRYINDEX, s_refid_ptr_mapping);         /* stack: refid_ptr */
+    lua_rawgeti(L, -1, refid);                                      /* stack: refid_ptr ptr */
     ptr = lua_touserdata(L, -1);
     lua_pop(L, 1);                                                  /* stack: refid_ptr */
     if (ptr == NULL)
@@ -112,17 +158,19 @@ TOLUA_API int toluafix_remove_ccobject_by_refid(lua_State* L, int refid)
     }
 
     // remove ptr from tolua_refid_ptr_mapping
-    lua_pushinteger(L, refid);                                      /* stack: refid_ptr refid */
-    lua_pushnil(L);                                                 /* stack: refid_ptr refid nil */
-    lua_rawset(L, -3);                     /* delete refid_ptr[refid], stack: refid_ptr */
+    lua_pushnil(L);                                                 /* stack: refid_ptr nil */
+    lua_rawseti(L, -2, refid);             /* delete refid_ptr[refid], stack: refid_ptr */
     lua_pop(L, 1);                                                  /* stack: - */
 
+    // remove the userdata from toluafix_refid_userdata_mapping
+    lua_rawgeti(L, LUA_REGISTRYINDEX, s_refid_userdata_mapping);    /* stack: refid_ud */
+    lua_pushnil(L);                                                 /* stack: refid_ud nil */
+    lua_rawseti(L, -2, refid);              /* delete refid_ud[refid], stack: refid_ud */
+    lua_pop(L, 1);                                                  /* stack: - */
 
     // get type from tolua_refid_type_mapping
-    lua_pushstring(L, TOLUA_REFID_TYPE_MAPPING);
-    lua_rawget(L, LUA_REGISTRYINDEX);                               /* stack: refid_type */
-    lua_pushinteger(L, refid);                                      /* stack: refid_type refid */
-    lua_rawget(L, -2);                                              /* stack: refid_type type */
+    lua_rawgeti(L, LUA_REGISTRYINDEX, s_refid_type_mapping);        /* stack: refid_type */
+    lua_rawgeti(L, -1, refid);                                      /* stack: refid_type type */
     if (lua_isnil(L, -1))
     {
         lua_pop(L, 2);
@@ -134,9 +182,8 @@ TOLUA_API int toluafix_remove_ccobject_by_refid(lua_State* L, int refid)
     lua_pop(L, 1);                                                  /* stack: refid_type */
 
     // remove type from tolua_refid_type_mapping
-    lua_pushinteger(L, refid);                                      /* stack: refid_type refid */
-    lua_pushnil(L);                                                 /* stack: refid_type refid nil */
-    lua_rawset(L, -3);                    /* delete refid_type[refid], stack: refid_type */
+    lua_pushnil(L);                                                 /* stack: refid_type nil */
+    lua_rawseti(L, -2, refid);            /* delete refid_type[refid], stack: refid_type */
     lua_pop(L, 1);                                                  /* stack: - */
 
     // get ubox
@@ -153,7 +200,11 @@ TOLUA_API int toluafix_remove_ccobject_by_refid(lua_State* L, int refid)
     
     
     // cleanup root
-    tolua_remove_value_from_root(L, ptr);
+    lua_rawgeti(L, LUA_REGISTRYINDEX, s_value_root);                /* stack: mt ubox root */
+    lua_pushlightuserdata(L, ptr);                                  /* stack: mt ubox root ptr */
+    lua_pushnil(L);                                                 /* stack: mt ubox root ptr nil */
+    lua_rawset(L, -3);                             /* root[ptr] = nil, stack: mt ubox root */
+    lua_pop(L, 1);                                                  /* stack: mt ubox */
 
     lua_pushlightuserdata(L, ptr);                                  /* stack: mt ubox ptr */
     lua_rawget(L,-2);                                               /* stack: mt ubox ud */
@@ -197,12 +248,10 @@ TOLUA_API int toluafix_ref_function(lua_State* L, int lo, int def)
 
     s_function_ref_id++;
 
-    lua_pushstring(L, TOLUA_REFID_FUNCTION_MAPPING);
-    lua_rawget(L, LUA_REGISTRYINDEX);                           /* stack: fun ... refid_fun */
-    lua_pushinteger(L, s_function_ref_id);                      /* stack: fun ... refid_fun refid */
-    lua_pushvalue(L, lo);                                       /* stack: fun ... refid_fun refid fun */
+    lua_rawgeti(L, LUA_REGISTRYINDEX, s_refid_function_mapping); /* stack: fun ... refid_fun */
+    lua_pushvalue(L, lo);                                       /* stack: fun ... refid_fun fun */
 
-    lua_rawset(L, -3);                  /* refid_fun[refid] = fun, stack: fun ... refid_ptr */
+    lua_rawseti(L, -2, s_function_ref_id); /* refid_fun[refid] = fun, stack: fun ... refid_ptr */
     lua_pop(L, 1);                                              /* stack: fun ... */
 
     return s_function_ref_id;
@@ -213,20 +262,16 @@ TOLUA_API int toluafix_ref_function(lua_State* L, int lo, int def)
 
 TOLUA_API void toluafix_get_function_by_refid(lua_State* L, int refid)
 {
-    lua_pushstring(L, TOLUA_REFID_FUNCTION_MAPPING);
-    lua_rawget(L, LUA_REGISTRYINDEX);                           /* stack: ... refid_fun */
-    lua_pushinteger(L, refid);                                  /* stack: ... refid_fun refid */
-    lua_rawget(L, -2);                                          /* stack: ... refid_fun fun */
+    lua_rawgeti(L, LUA_REGISTRYINDEX, s_refid_function_mapping); /* stack: ... refid_fun */
+    lua_rawgeti(L, -1, refid);                                  /* stack: ... refid_fun fun */
     lua_remove(L, -2);                                          /* stack: ... fun */
 }
 
 TOLUA_API void toluafix_remove_function_by_refid(lua_State* L, int refid)
 {
-    lua_pushstring(L, TOLUA_REFID_FUNCTION_MAPPING);
-    lua_rawget(L, LUA_REGISTRYINDEX);                           /* stack: ... refid_fun */
-    lua_pushinteger(L, refid);                                  /* stack: ... refid_fun refid */
-    lua_pushnil(L);                                             /* stack: ... refid_fun refid nil */
-    lua_rawset(L, -3);                  /* refid_fun[refid] = fun, stack: ... refid_ptr */
+    lua_rawgeti(L, LUA_REGISTRYINDEX, s_refid_function_mapping); /* stack: ... refid_fun */
+    lua_pushnil(L);                                             /* stack: ... refid_fun nil */
+    lua_rawseti(L, -2, refid);          /* refid_fun[refid] = fun, stack: ... refid_ptr */
     lua_pop(L, 1);                                              /* stack: ... */
 
     // luaL_unref(L, LUA_REGISTRYINDEX, refid);
@@ -30,6 +30,7 @@
     
 #define TOLUA_REFID_PTR_MAPPING "toluafix_refid_ptr_mapping"
 #define TOLUA_REFID_TYPE_MAPPING "toluafix_refid_type_mapping"
+#define TOLUA_REFID_USERDATA_MAPPING "toluafix_refid_userdata_mapping"
 #define TOLUA_REFID_FUNCTION_MAPPING "toluafix_refid_function_mapping"
 
 /**
@@ -45,6 +46,7 @@ TOLUA_API void toluafix_open(lua_State* L);
  * If the userdata correspondings to the ptr don't exist, it would call lua_newuserdata to new a userdata.
  * If the userdata correspondings to the ptr exist,it would update the metatable information of the super.
  * In addition, this function would update some table in the Lua registry,such as toluafix_refid_ptr_mapping, toluafix_refid_type_mapping,tolua_value_root,and so on.
+ * Once the object has been pushed with its dynamic type, the userdata is kept in toluafix_refid_userdata_mapping and later pushes return it directly.
  * Meanwhile, Add a reference about the userdata corresponding to the ptr in the tolua_ubox table.
  * The ptr should be point to a Ref object.
  * 
@@ -65,7 +67,7 @@ TOLUA_API int toluafix_pushusertype_ccobject(lua_State* L,
 
 /**
  * Find the value of Ref object pointer in the Lua registry by the refid.
- * Then, remove the corresponding reference in some table in the Lua registry by refid, such as toluafix_refid_type_mapping, toluafix_refid_ptr_mapping,tolua_value_root,and so on.
+ * Then, remove the corresponding reference in some table in the Lua registry by refid, such as toluafix_refid_type_mapping, toluafix_refid_ptr_mapping, toluafix_refid_userdata_mapping,tolua_value_root,and so on.
  * Set the value of userdata nullptr and remove the reference of userdata in the tolua_ubox table.
  * This function is called in the destructor of the Ref automatically.
  *
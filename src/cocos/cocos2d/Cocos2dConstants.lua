@@ -43,6 +43,11 @@ cc.MATRIX_STACK_TYPE =
     PROJECTION = 1,
     TEXTURE = 2,
 }
+cc.TEXTURE_ASYNC_PRIORITY =
+{
+    HIGH = 0,
+    LOW = 1,
+}
 -- particle
 cc.PARTICLE_DURATION_INFINITY   = -1
 cc.PARTICLE_START_SIZE_EQUAL_TO_END_SIZE    = -1
@@ -7,6 +7,12 @@ DEBUG_FPS = true
 -- dump memory info every 10 seconds
 DEBUG_MEM = false
 
+-- call the hot methods of cc.Node through the LuaJIT FFI
+CONFIG_FFI_FASTCALL = true
+
+-- microseconds the Lua GC may run in the idle time of each frame, 0 to disable
+CONFIG_GC_BUDGET = 1000
+
 -- design resolution
 CONFIG_SCREEN_WIDTH  = 640
 CONFIG_SCREEN_HEIGHT = 960
@@ -438,3 +438,128 @@ function Node:removeAllNodeEventListeners()
     self:removeNodeEventListener(c.KEYPAD_EVENT)
     self:removeNodeEventListener(c.ACCELEROMETER_EVENT)
 end
+
+--[[
+  Call the hot methods of cc.Node, cc.Sprite, cc.Label and cc.Action through the LuaJIT FFI,
+  so that the per frame loops calling them can be compiled.
+  Set CONFIG_FFI_FASTCALL to false in config.lua to keep the tolua bindings.
+]]--
+local function enableFFIFastCall()
+    local ok, ffi = pcall(require, "ffi")
+    if not ok or not c.getFFIApi then return end
+
+    local apiPointer, apiDeclaration = c.getFFIApi()
+    if not pcall(ffi.typeof, "cc_ffi_api") then
+        ffi.cdef("typedef struct cc_ffi_api {\n" .. apiDeclaration .. "} cc_ffi_api;")
+    end
+    local api = ffi.cast("const cc_ffi_api*", apiPointer)
+    local userdataType = ffi.typeof("void**")
+
+    -- the object in the tolua userdata, nil once it is released
+    local function cobj(obj, name)
+        local p = ffi.cast(userdataType, obj)[0]
+        if p == nil then
+            error("invalid 'self' in function '" .. name .. "'", 3)
+        end
+        return p
+    end
+
+    local function bindSetter(class, method, entry)
+        local f = api[entry]
+        class[method] = function(self, value)
+            f(cobj(self, method), value)
+        end
+    end
+
+    local function bindGetter(class, method, entry)
+        local f = api[entry]
+        class[method] = function(self)
+            return f(cobj(self, method))
+        end
+    end
+
+    local function bindBoolSetter(class, method, entry)
+        local f = api[entry]
+        class[method] = function(self, value)
+            f(cobj(self, method), value and true or false)
+        end
+    end
+
+    -------------- cc.Node --------------
+    local setPosition = api.Node_setPosition
+    function Node:setPosition(x, y)
+        if y == nil then x, y = x.x, x.y end
+        setPosition(cobj(self, "setPosition"), x, y)
+    end
+
+    local getPositionX, getPositionY = api.Node_getPositionX, api.Node_getPositionY
+    function Node:getPosition()
+        local p = cobj(self, "getPosition")
+        return getPositionX(p), getPositionY(p)
+    end
+
+    local setScale, setScaleXY = api.Node_setScale, api.Node_setScaleXY
+    function Node:setScale(scaleX, scaleY)
+        if scaleY == nil then
+            setScale(cobj(self, "setScale"), scaleX)
+        else
+            setScaleXY(cobj(self, "setScale"), scaleX, scaleY)
+        end
+    end
+
+    local setAnchorPoint = api.Node_setAnchorPoint
+    function Node:setAnchorPoint(x, y)
+        if y == nil then x, y = x.x, x.y end
+        setAnchorPoint(cobj(self, "setAnchorPoint"), x, y)
+    end
+
+    local setContentSize = api.Node_setContentSize
+    function Node:setContentSize(width, height)
+        if height == nil then width, height = width.width, width.height end
+        setContentSize(cobj(self, "setContentSize"), width, height)
+    end
+
+    local setColor = api.Node_setColor
+    function Node:setColor(color)
+        setColor(cobj(self, "setColor"), color.r, color.g, color.b)
+    end
+
+    for _, name in ipairs({"PositionX", "PositionY", "Rotation", "RotationSkewX", "RotationSkewY",
+        "ScaleX", "ScaleY", "SkewX", "SkewY", "Opacity", "LocalZOrder", "GlobalZOrder", "Tag"}) do
+        bindSetter(Node, "set" .. name, "Node_set" .. name)
+        bindGetter(Node, "get" .. name, "Node_get" .. name)
+    end
+    bindGetter(Node, "getScale", "Node_getScale")
+    bindGetter(Node, "getDisplayedOpacity", "Node_getDisplayedOpacity")
+    bindGetter(Node, "getChildrenCount", "Node_getChildrenCount")
+    bindGetter(Node, "getNumberOfRunningActions", "Node_getNumberOfRunningActions")
+    bindGetter(Node, "isRunning", "Node_isRunning")
+    bindGetter(Node, "isVisible", "Node_isVisible")
+    bindGetter(Node, "pause", "Node_pause")
+    bindGetter(Node, "resume", "Node_resume")
+    bindBoolSetter(Node, "setVisible", "Node_setVisible")
+    bindBoolSetter(Node, "setCascadeOpacityEnabled", "Node_setCascadeOpacityEnabled")
+    bindBoolSetter(Node, "setCascadeColorEnabled", "Node_setCascadeColorEnabled")
+
+    -------------- cc.Sprite --------------
+    bindBoolSetter(c.Sprite, "setFlippedX", "Sprite_setFlippedX")
+    bindBoolSetter(c.Sprite, "setFlippedY", "Sprite_setFlippedY")
+    bindGetter(c.Sprite, "isFlippedX", "Sprite_isFlippedX")
+    bindGetter(c.Sprite, "isFlippedY", "Sprite_isFlippedY")
+
+    -------------- cc.Label --------------
+    local setTextColor = api.Label_setTextColor
+    function c.Label:setTextColor(color)
+        setTextColor(cobj(self, "setTextColor"), color.r, color.g, color.b, color.a or 255)
+    end
+    bindGetter(c.Label, "getStringLength", "Label_getStringLength")
+
+    -------------- cc.Action --------------
+    bindSetter(c.Action, "setTag", "Action_setTag")
+    bindGetter(c.Action, "getTag", "Action_getTag")
+    bindGetter(c.Action, "isDone", "Action_isDone")
+end
+
+if jit and CONFIG_FFI_FASTCALL ~= false then
+    enableFFIFastCall()
+end
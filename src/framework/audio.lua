@@ -29,6 +29,8 @@ if not (audio._sources[1]) then
 	end
 	audio.unloadFile = function(path) end
 	audio.unloadAllFile = function() end
+	audio.setCacheSize = function(bytes) end
+	audio.getCacheSize = function() return 0, 0 end
 	audio.playBGMSync = function(path, isLoop) end
 	audio.playBGM = function(path, isLoop) end
 	audio.stopBGM = function() end
@@ -44,6 +46,9 @@ if not (audio._sources[1]) then
 end
 
 audio._BGMVolume = 1.0
+-- BGM which is not preloaded is streamed
+audio._BGMStream = nil
+audio._BGMStreamPath = nil
 audio._effectVolume = 1.0
 
 local scheduler = require("framework.scheduler")
@@ -87,6 +92,7 @@ function audio.loadFile(path, callback)
 	end
 end
 
+-- the decoded file stays in the buffer cache, loading it again is fast until the cache is full
 function audio.unloadFile(path)
 	local buffer = audio._buffers[path]
 	if buffer then
@@ -102,6 +108,16 @@ function audio.unloadAllFile()
 	audio._buffers = {}
 end
 
+-- bytes of decoded sound kept once unloaded, the least recently used files are freed first
+function audio.setCacheSize(bytes)
+	Rapid2D_CAudio.setCacheSize(bytes)
+end
+
+-- return cache size, bytes of all the loaded and cached files
+function audio.getCacheSize()
+	return Rapid2D_CAudio.getCacheSize()
+end
+
 --[[
 function for CSource
 	play2d(buffer, isLoop)
@@ -112,25 +128,57 @@ function for CSource
     getStat()
 ]]--
 
+--[[
+function for CStream, decode and play a file a part at a time
+	play(isLoop)
+    pause()
+    resume()
+    stop()
+	setVolume(vol)
+    getStat()
+]]--
+
 --------------- BGM 2D API -------------------
--- no need preload file
-function audio.playBGMSync(path, isLoop)
-	audio.loadFile(path, function(pn, isSuccess)
-		if isSuccess then
-			audio.playBGM(pn, isLoop)
+local function stopBGMStream()
+	if audio._BGMStream then
+		audio._BGMStream:stop()
+	end
+end
+
+local function playBGMStream(path, isLoop)
+	if audio._BGMStreamPath ~= path then
+		if audio._BGMStream then
+			audio._BGMStream:__gc() -- free OpenAL resource and decoder
 		end
-	end)
+		audio._BGMStream = Rapid2D_CAudio.newStream(path)
+		audio._BGMStreamPath = audio._BGMStream and path or nil
+	end
+	if not audio._BGMStream then
+		print(path .. " can not be streamed!!")
+		return
+	end
+
+	audio._BGMStream:setVolume(audio._BGMVolume)
+	audio._BGMStream:play(isLoop)
 end
 
--- need preload file
+-- no need preload file, the file is streamed
+function audio.playBGMSync(path, isLoop)
+	isLoop = isLoop ~= false and true or false
+	audio._sources[1]:stop()
+	playBGMStream(path, isLoop)
+end
+
+-- plays the preloaded file, streams the file which is not loaded
 function audio.playBGM(path, isLoop)
 	local buffer = audio._buffers[path]
 	if not buffer then
-		print(path .. " have not loaded!!")
+		audio.playBGMSync(path, isLoop)
 		return
 	end
 
 	isLoop = isLoop ~= false and true or false
+	stopBGMStream()
 	audio._sources[1]:stop()
 	audio._sources[1]:play2d(buffer, isLoop)
 	audio._sources[1]:setVolume(audio._BGMVolume)
@@ -138,6 +186,7 @@ end
 
 function audio.stopBGM()
 	audio._sources[1]:stop()
+	stopBGMStream()
 end
 
 function audio.setBGMVolume(vol)
@@ -148,6 +197,9 @@ function audio.setBGMVolume(vol)
 		vol = 0.0
 	end
 	audio._sources[1]:setVolume(vol)
+	if audio._BGMStream then
+		audio._BGMStream:setVolume(vol)
+	end
 	audio._BGMVolume = vol
 end
 
@@ -209,18 +261,25 @@ function audio.stopAll()
 	for i = 1, #audio._sources do
 		audio._sources[i]:stop()
 	end
+	stopBGMStream()
 end
 
 function audio.pauseAll()
 	for i = 1, #audio._sources do
 		audio._sources[i]:pause()
 	end
+	if audio._BGMStream then
+		audio._BGMStream:pause()
+	end
 end
 
 function audio.resumeAll()
 	for i = 1, #audio._sources do
 		audio._sources[i]:resume()
 	end
+	if audio._BGMStream then
+		audio._BGMStream:resume()
+	end
 end
 
 return audio
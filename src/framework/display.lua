@@ -987,9 +987,10 @@ end
   @function addImageAsync
   @param string imagePath
   @param function callback
+  @param integer priority, cc.TEXTURE_ASYNC_PRIORITY.LOW to prefetch the image, HIGH by default
 ]]--
-function display.addImageAsync(imagePath, callback)
-    sharedTextureCache:addImageAsync(imagePath, callback)
+function display.addImageAsync(imagePath, callback, priority)
+    sharedTextureCache:addImageAsync(imagePath, callback, priority or cc.TEXTURE_ASYNC_PRIORITY.HIGH)
 end
 
 --[[
@@ -46,10 +46,19 @@ else
     sharedDirector:setDisplayStats(false)
 end
 
+if cc.setLuaGCParams and CONFIG_GC_BUDGET then
+    cc.setLuaGCParams(CONFIG_GC_BUDGET, CONFIG_GC_PAUSE, CONFIG_GC_STEPMUL)
+end
+
 if DEBUG_MEM then
     local sharedTextureCache = cc.Director:getInstance():getTextureCache()
     local function showMemoryUsage()
         printInfo(string.format("LUA VM MEMORY USED: %0.2f KB", collectgarbage("count")))
+        if cc.getLuaGCStats then
+            local stats = cc.getLuaGCStats()
+            printInfo(string.format("LUA GC IN IDLE TIME: %d us in last frame, %d us max, %d cycles",
+                stats.time, stats.maxTime, stats.cycles))
+        end
         printInfo(sharedTextureCache:getCachedTextureInfo())
         printInfo("---------------------------------------------------")
     end